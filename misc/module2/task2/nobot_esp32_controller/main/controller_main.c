@@ -5,8 +5,8 @@
  * 2022 the nobot space,
  */
 #include <inttypes.h>
+#include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
 #include <string.h>
 
 #include "driver/adc.h"
@@ -23,12 +23,23 @@
 #include "sdkconfig.h"
 
 #include "controller_buttons.h"
+#include "esp_timer.h"
+#include "joystick_cal.h"
+#include "report_scheduler.h"
+#include "trace.h"
+#include "util.h"
 #include "wifi_connect.h"
 #include "wifi_ws_client.h"
+#include "wire.h"
 
 #define NOBOT_CONTROLLER_TAG "nobot controller"
 
-#define JOYSTICK_DEADZONE 0.05
+// how much the joystick needs to change by to be reported, in hundredths (see util.h)
+#define JOYSTICK_DEADZONE 5
+// readings averaged into every joystick sample, to keep ADC noise out of the calibration
+#define JOYSTICK_OVERSAMPLE 8
+// set on the controller task at every report tick
+#define REPORT_TICK_NOTIFY_BIT (1UL << 0)
 
 /* ----------------------------- JOYSTICK INPUT ----------------------------- */
 
@@ -47,73 +58,100 @@
  * 2. Some of the ADC2 pins are used as strapping pins (GPIO 0, 2, 15) thus
  *      cannot be used freely.
  *
+ * The channels are set up for 12-bit readings once, in read_controller_task.
+ *
  * @param channel The input ADC channel.
- * @return uint8_t - The analog input (0-255) to the channel.
+ * @return uint16_t - The analog input (0-4095) to the channel.
  */
-static uint8_t readJoystickChannel(adc1_channel_t channel) {
-  adc1_config_width(ADC_WIDTH_BIT_10);                  // Range 0-1023
-  adc1_config_channel_atten(channel, ADC_ATTEN_DB_11);  // ADC_ATTEN_DB_11 = 0-3,6V
-  return (uint8_t)(adc1_get_raw(channel) >> 2);         // Read analog and shift to 0-255
+static uint16_t readJoystickChannel(adc1_channel_t channel) {
+  uint32_t sum = 0;
+  for (int i = 0; i < JOYSTICK_OVERSAMPLE; i++) sum += adc1_get_raw(channel);
+  return (sum + JOYSTICK_OVERSAMPLE / 2) / JOYSTICK_OVERSAMPLE;
 }
 
 /* -------------------------- MAIN CONTROLLER LOOP -------------------------- */
 
 /**
- * @brief Polls for button and joystick input events.
+ * @brief Samples button and joystick input at the report rate.
  *
- * Uses tiny checksums to detect state changes, only emitting packets when said
- * state change is detected.
+ * Wakes on every report scheduler tick, takes the newest button state the
+ * scanner posted, and samples the joystick. Uses tiny checksums to detect
+ * state changes, only emitting packets when said state change is detected
+ * (or as a keepalive when none has been sent in a while).
  *
  * @param pvParameter A placeholder for provided variables (unused).
  */
 static void read_controller_task(void *pvParameter) {
-  // INPUT: joystick
-  double js_x, js_y;                    // joystick x and y
-  double last_js_x = 0, last_js_y = 0;  // previous joystick x and y
+  // INPUT: joystick, in ten-thousandths (see joystick_cal_apply)
+  int32_t js_x, js_y;                    // joystick x and y
+  int32_t last_js_x = 0, last_js_y = 0;  // previous joystick x and y
+
+  // set up the axes once, and calibrate them while the stick is at rest
+  static joystick_cal_t cal_x, cal_y;  // too big for this task's stack
+  adc1_config_width(ADC_WIDTH_BIT_12);                        // Range 0-4095
+  adc1_config_channel_atten(ADC1_CHANNEL_4, ADC_ATTEN_DB_11);  // ADC_ATTEN_DB_11 = 0-3,6V
+  adc1_config_channel_atten(ADC1_CHANNEL_5, ADC_ATTEN_DB_11);
+  joystick_cal_init(&cal_x, "x");
+  joystick_cal_init(&cal_y, "y");
 
   // INPUT: buttons
   uint16_t buttons = 0;       // button inputs
   uint16_t last_buttons = 0;  // previous button inputs
+  // the websocket connection the last report went out on
+  uint32_t reported_connection = 0;
 
-  // begin & listen to the button event queue
+  // the button state, posted by the scanner as it changes
   controller_buttons_event_t ev;
-  QueueHandle_t controller_buttons_events = controller_buttons_init();
+  mailbox_t *controller_buttons_state = controller_buttons_init();
+
+  // sample and report at a fixed rate, instead of whenever the button queue times out
+  report_scheduler_config_t report_config = REPORT_SCHEDULER_CONFIG_DEFAULT();
+  report_scheduler_t *reports = report_scheduler_start(&report_config, REPORT_TICK_NOTIFY_BIT);
+  if (reports == NULL) {
+    ESP_LOGE(NOBOT_CONTROLLER_TAG, "failed to start the report scheduler");
+    vTaskDelete(NULL);
+  }
   while (true) {
-    // if there's a button event available, save it into buttons
-    ESP_LOGD(NOBOT_CONTROLLER_TAG, "wait for button events");
-    if (xQueueReceive(controller_buttons_events, &ev, 50 / portTICK_PERIOD_MS)) {
-      ESP_LOGI(NOBOT_CONTROLLER_TAG, "joystick_buttons_events %d", ev.state);
-      buttons = ev.state;
-    }
+    xTaskNotifyWait(0, REPORT_TICK_NOTIFY_BIT, NULL, portMAX_DELAY);
+    // take the newest button state, if it changed since the last tick
+    if (mailbox_read(controller_buttons_state, &ev)) buttons = ev.state;
 
     // read in joystick axis input from the ESP32 ADC channels 4 and 5.
     // note that the joystick we use has 5V analog output, but our ADC only handles
-    // up to 3.5V input, mapped from 0-255. so the resting position on each axis
-    // of 2.5V actually maps to (2.5/3.5)*255 = 182. Therefore, higher X and Y
-    // values actually just get cut off at 255––there are 180 states dedicated to
-    // lower-voltage positions, and only 75 dedicated to higher, with voltages
-    // higher than 3.5V simply capping the ADC at 255. There's no real way around
-    // this with our hardware, so we kind of have to make do.
-    double steps = 0xFF;
-    js_x = (3.5 / 2.5) * ((readJoystickChannel(ADC1_CHANNEL_4) / steps) - (2.5 / 3.5));
-    js_y = (3.5 / 2.5) * ((readJoystickChannel(ADC1_CHANNEL_5) / steps) - (2.5 / 3.5));
-
-    ESP_LOGD(NOBOT_CONTROLLER_TAG, "last_js_x %0.2f last_js_y %0.2f", last_js_x, last_js_y);
-
-    // transmit input if something has changed, based on checksum
-    if (fabs(js_x - last_js_x) > JOYSTICK_DEADZONE || fabs(js_y - last_js_y) > JOYSTICK_DEADZONE || last_buttons != buttons) {
-      // ESP_LOGI(NOBOT_CONTROLLER_TAG, "send buttons %d JS X=%0.2f Y=%0.2f", buttons, js_x, js_y);
-      char message[128];
-      sprintf(message, "{\"type\":\"controller_state\",\"data\":{\"buttons\":%d,\"js_x\":%0.2f,\"js_y\":%0.2f}}", buttons, js_x, js_y);
-      websocket_client_send(message, strlen(message));
-
-      // update the previous axes only when we send a packet
+    // up to 3.5V input. so the resting position on each axis of 2.5V sits well
+    // above the middle of the ADC's range, and higher X and Y values just get cut
+    // off at the top. rather than hard-code that, the calibration measures where
+    // this stick rests and how far it reaches each way, and scales each half of
+    // the travel to a full -1.00..1.00 on its own.
+    uint16_t raw_x = readJoystickChannel(ADC1_CHANNEL_4);
+    uint16_t raw_y = readJoystickChannel(ADC1_CHANNEL_5);
+    int64_t now_us = esp_timer_get_time();
+    joystick_cal_track(&cal_x, raw_x, now_us);
+    joystick_cal_track(&cal_y, raw_y, now_us);
+    js_x = joystick_cal_apply(&cal_x, raw_x);
+    js_y = joystick_cal_apply(&cal_y, raw_y);
+
+    ESP_LOGD(NOBOT_CONTROLLER_TAG, "last_js_x " CENTI_FMT " last_js_y " CENTI_FMT,
+             CENTI_ARGS(axis_to_centi(last_js_x)), CENTI_ARGS(axis_to_centi(last_js_y)));
+
+    // transmit input if something has changed, based on checksum. after a
+    // reconnect, transmit it anyway, as the server may have lost what we sent
+    // before; the sender puts the handshake ahead of it
+    uint32_t connection = websocket_client_connection();
+    bool changed = abs(js_x - last_js_x) > JOYSTICK_DEADZONE * 100 || abs(js_y - last_js_y) > JOYSTICK_DEADZONE * 100 || last_buttons != buttons;
+    if (report_scheduler_tick(reports, changed || connection != reported_connection)) {
+      wire_state_t state = {.buttons = buttons, .js_x = axis_to_centi(js_x), .js_y = axis_to_centi(js_y)};
+      // ESP_LOGI(NOBOT_CONTROLLER_TAG, "send buttons %d JS X=" CENTI_FMT " Y=" CENTI_FMT, buttons, CENTI_ARGS(state.js_x), CENTI_ARGS(state.js_y));
+      char message[WIRE_STATE_JSON_MAX_SIZE];
+      websocket_client_send_state(message, WIRE_ENCODE_STATE_JSON(message, &state));
+      TRACE(TRACE_JOYSTICK, state.js_x, state.js_y, 0);
+
+      // update the previous values only when we send a packet
       last_js_x = js_x;
       last_js_y = js_y;
+      last_buttons = buttons;
+      reported_connection = connection;
     }
-
-    // use previous values to detect state changes, triggering packets
-    last_buttons = buttons;
   }
 }
 
@@ -134,6 +172,9 @@ static esp_err_t read_controller_init(void) {
 void app_main() {
   esp_err_t ret;
 
+  // 0. start tracing first, so everything after can be traced
+  trace_init();
+
   // 1. initialize non-volatile storage. if we're out of memory or there's a new
   // version, attempt to erase the current NVS and re-initialize it.
   ret = nvs_flash_init();
@@ -9,6 +9,7 @@
 #define __CONTROLLER_BUTTONS_H__
 
 #include <stdlib.h>
+#include "mailbox.h"
 
 /* -------------------------------------------------------------------------- */
 /*                                    PINS                                    */
@@ -19,26 +20,20 @@
 // the switch is on pin 14––we can treat it as a button
 #define BUTTON_2_PIN 14
 
-struct QueueDefinition;
-typedef struct QueueDefinition* QueueHandle_t;
-
 /* -------------------------------------------------------------------------- */
 /*                                  TEMPLATES                                 */
 /* -------------------------------------------------------------------------- */
 
-// the event handler for the controller buttons
-QueueHandle_t controller_buttons_init(void);
+// the state mailbox for the controller buttons
+mailbox_t *controller_buttons_init(void);
 
 /* -------------------------------------------------------------------------- */
 /*                                    TYPES                                   */
 /* -------------------------------------------------------------------------- */
 
-typedef struct {
-  uint8_t pin;
-} button_t;
-
 typedef struct {
   uint16_t state;
+  int64_t time_us;  // when the button change behind this state was sampled
 } controller_buttons_event_t;
 
 #endif /* __CONTROLLER_BUTTONS_H__ */
\ No newline at end of file
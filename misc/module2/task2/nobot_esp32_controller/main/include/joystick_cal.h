@@ -0,0 +1,102 @@
+/*
+ * joystick_cal.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __JOYSTICK_CAL_H__
+#define __JOYSTICK_CAL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   CONFIG                                   */
+/* -------------------------------------------------------------------------- */
+
+// how long the sticks are assumed to be at rest after boot, while their
+// centres are measured
+#ifndef CONFIG_JOYSTICK_CAL_CENTRE_MS
+#define CONFIG_JOYSTICK_CAL_CENTRE_MS (200)
+#endif
+
+// a boot-time centre further than this from the stored one means the stick
+// was being held, so the stored centre is kept instead
+#ifndef CONFIG_JOYSTICK_CAL_CENTRE_TOLERANCE_MV
+#define CONFIG_JOYSTICK_CAL_CENTRE_TOLERANCE_MV (150)
+#endif
+
+// travel either side of centre assumed for a stick that has never been swept
+#ifndef CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV
+#define CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV (1000)
+#endif
+
+// how long a widened range has to stay put before it is written to NVS
+#ifndef CONFIG_JOYSTICK_CAL_SAVE_DELAY_MS
+#define CONFIG_JOYSTICK_CAL_SAVE_DELAY_MS (2000)
+#endif
+
+// the reference voltage to assume on chips without one burned into eFuse
+#ifndef CONFIG_JOYSTICK_CAL_DEFAULT_VREF_MV
+#define CONFIG_JOYSTICK_CAL_DEFAULT_VREF_MV (1100)
+#endif
+
+// the LUT has a node every 16 counts of the 12-bit reading, plus one for the top
+#define JOYSTICK_CAL_LUT_SHIFT (4)
+#define JOYSTICK_CAL_LUT_SIZE ((4096 >> JOYSTICK_CAL_LUT_SHIFT) + 1)
+
+// full deflection, in the ten-thousandths joystick_cal_apply returns
+#define JOYSTICK_CAL_FULL_SCALE (10000)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+// what gets stored in NVS, per axis
+typedef struct {
+  uint16_t min_mv;
+  uint16_t centre_mv;
+  uint16_t max_mv;
+} joystick_cal_range_t;
+
+typedef struct {
+  const char *key;                        // NVS key the range is stored under
+  joystick_cal_range_t range;
+  bool stored;                            // whether range came out of NVS
+  uint16_t lo_raw, hi_raw;                // readings outside these widen the range
+  int16_t lut[JOYSTICK_CAL_LUT_SIZE];     // position at every LUT node, in ten-thousandths
+  int64_t centre_until_us;                // end of the boot-time centre capture, 0 once done
+  uint32_t centre_sum, centre_readings;   // the capture so far, in mV
+  int64_t save_at_us;                     // when to write a widened range, 0 = nothing to write
+} joystick_cal_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// loads an axis' stored range (NVS must be initialized) and starts measuring its centre
+esp_err_t joystick_cal_init(joystick_cal_t *cal, const char *key);
+// feeds a reading to the centre capture and range sweep, and saves the range once it settles
+void joystick_cal_track(joystick_cal_t *cal, uint16_t raw, int64_t time_us);
+
+/**
+ * @brief Maps a 12-bit reading onto the stick's calibrated travel.
+ *
+ * Interpolates between the two LUT nodes either side of the reading, so the
+ * hot path is two loads, a multiply and a shift.
+ *
+ * @param cal The axis calibration.
+ * @param raw The 12-bit reading.
+ * @return int32_t - The stick position, -10000..10000 ten-thousandths.
+ */
+static inline int32_t joystick_cal_apply(const joystick_cal_t *cal, uint16_t raw) {
+  uint32_t node = raw >> JOYSTICK_CAL_LUT_SHIFT;
+  int32_t frac = raw & ((1 << JOYSTICK_CAL_LUT_SHIFT) - 1);
+  int32_t lo = cal->lut[node], hi = cal->lut[node + 1];
+  return lo + (hi - lo) * frac / (1 << JOYSTICK_CAL_LUT_SHIFT);
+}
+
+#endif /* __JOYSTICK_CAL_H__ */
@@ -0,0 +1,45 @@
+/*
+ * mailbox.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __MAILBOX_H__
+#define __MAILBOX_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+// a single-slot holder for the latest value of some piece of state. the
+// producer overwrites it, the consumer only ever reads the newest value.
+typedef struct mailbox mailbox_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// creates a mailbox holding values of `size` bytes. every post sets
+// `notify_bits` on the task that consumes the mailbox.
+mailbox_t *mailbox_create(size_t size, uint32_t notify_bits);
+// overwrites the value in the mailbox, never blocks
+void mailbox_post(mailbox_t *mailbox, const void *value);
+// copies out the newest value if there is one the caller has not seen yet.
+// returns how many posts were made since the last read (0 = nothing new)
+uint32_t mailbox_read(mailbox_t *mailbox, void *value);
+// like mailbox_read, but waits up to `ticks_to_wait` for a post first
+uint32_t mailbox_wait(mailbox_t *mailbox, void *value, TickType_t ticks_to_wait);
+// makes `task` the consumer woken by posts. the first wait does this itself
+void mailbox_set_consumer(mailbox_t *mailbox, TaskHandle_t task);
+// waits up to `ticks_to_wait` for a post to any of the calling task's mailboxes
+// whose notify bits are in `notify_bits`. returns the bits that were set (0 = timeout)
+uint32_t mailbox_wait_any(uint32_t notify_bits, TickType_t ticks_to_wait);
+
+#endif /* __MAILBOX_H__ */
@@ -0,0 +1,77 @@
+/*
+ * report_scheduler.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __REPORT_SCHEDULER_H__
+#define __REPORT_SCHEDULER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   CONFIG                                   */
+/* -------------------------------------------------------------------------- */
+
+// how often the controller state is looked at, and at most sent. paced by
+// esp_timer, so it does not depend on CONFIG_FREERTOS_HZ.
+#ifndef CONFIG_REPORT_RATE_HZ
+#define CONFIG_REPORT_RATE_HZ (250)
+#endif
+
+// the longest the controller goes without sending, even if nothing changed.
+// 0 turns keepalives off.
+#ifndef CONFIG_REPORT_KEEPALIVE_MS
+#define CONFIG_REPORT_KEEPALIVE_MS (1000)
+#endif
+
+// the fastest rate a scheduler will run at
+#define REPORT_SCHEDULER_MAX_RATE_HZ (1000)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+// paces reports off a periodic esp_timer, see report_scheduler_start
+typedef struct report_scheduler report_scheduler_t;
+
+typedef struct {
+  uint32_t rate_hz;       // ticks per second, 1..REPORT_SCHEDULER_MAX_RATE_HZ
+  uint32_t keepalive_ms;  // longest gap between two reports, 0 = off
+} report_scheduler_config_t;
+
+#define REPORT_SCHEDULER_CONFIG_DEFAULT() {         \
+    .rate_hz = CONFIG_REPORT_RATE_HZ,               \
+    .keepalive_ms = CONFIG_REPORT_KEEPALIVE_MS,     \
+}
+
+typedef struct {
+  uint32_t ticks;           // ticks handled
+  uint32_t missed;          // ticks that went by while the consumer was busy
+  uint32_t reports;         // reports sent because something changed
+  uint32_t keepalives;      // reports sent only because none had gone out for keepalive_ms
+  uint32_t tick_rate_hz;    // measured ticks handled per second since start
+  uint32_t report_rate_hz;  // measured reports (of either kind) per second since start
+  uint32_t period_us;       // tick period the timer was asked for
+  uint32_t jitter_mean_us;  // how late ticks were handled, on average
+  uint32_t jitter_max_us;   // the latest any tick was handled
+} report_scheduler_stats_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// starts ticking, setting `notify_bits` on the calling task at every tick.
+// returns NULL on failure.
+report_scheduler_t *report_scheduler_start(const report_scheduler_config_t *config, uint32_t notify_bits);
+// call once per tick: whether to send a report, given whether the state changed since the last one
+bool report_scheduler_tick(report_scheduler_t *scheduler, bool changed);
+// copies out the scheduler's rate and timing statistics
+void report_scheduler_get_stats(report_scheduler_t *scheduler, report_scheduler_stats_t *stats);
+
+#endif /* __REPORT_SCHEDULER_H__ */
@@ -16,4 +16,12 @@
 #define CONFIG_ESP_MAXIMUM_RETRY 5
 #define CONFIG_WEBSOCKET_URI "ws://75c9-128-36-7-251.ngrok.io"
 
+// controller state reports, see report_scheduler.h
+#define CONFIG_REPORT_RATE_HZ 125
+#define CONFIG_REPORT_KEEPALIVE_MS 1000
+
+// binary event tracing, see trace.h
+#define CONFIG_TRACE_ENABLE 1
+#define CONFIG_TRACE_RING_EVENTS 512
+
 #endif /* __SDK_CONFIG_H__ */
\ No newline at end of file
@@ -0,0 +1,32 @@
+/*
+ * trace_events.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __TRACE_EVENTS_H__
+#define __TRACE_EVENTS_H__
+
+// every event the firmware can trace, as X(id, format). the id's position
+// in this list is what goes on the wire, so new events only ever go at the
+// end. the format is how the host decoder prints the event's four 32-bit
+// arguments, printf-style; unused arguments are recorded as 0.
+//
+// plain preprocessor only, as the host decoder includes it too. kept the same
+// as the ccamnote controller's, so the one decoder reads both.
+#define TRACE_EVENTS(X)                                                        \
+  X(TRACE_BUTTON_DOWN, "button %u down")                                       \
+  X(TRACE_BUTTON_UP, "button %u up")                                           \
+  X(TRACE_BUTTONS_STATE, "buttons 0x%x")                                       \
+  X(TRACE_JOYSTICK, "joystick x %d y %d (hundredths), pressed %u")             \
+  X(TRACE_TOUCHPAD, "touchpad %u")                                             \
+  X(TRACE_REPORT, "report in wire format %u, buttons 0x%x, flags 0x%x, "       \
+                  "%u us input to wire")                                       \
+  X(TRACE_WS_SEND, "ws sent opcode %u, %u bytes in %u us, result %d")          \
+  X(TRACE_WS_NOT_CONNECTED, "ws not connected, dropped opcode %u, %u bytes")   \
+  X(TRACE_WS_OUTBOX_FULL, "ws outbox full, dropped %u bytes")                  \
+  X(TRACE_WS_CONNECTED, "ws connected, connection #%u")                        \
+  X(TRACE_WS_DISCONNECTED, "ws disconnected, outage #%u")                      \
+  X(TRACE_WS_RECONNECT, "ws reconnecting in %u ms, attempt #%u")
+
+#endif /* __TRACE_EVENTS_H__ */
@@ -0,0 +1,28 @@
+/*
+ * util.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __UTIL_H__
+#define __UTIL_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// joystick values are kept in fixed point, counting hundredths: 100 = 1.00.
+// the ESP32 FPU has no double precision, so this keeps soft-float off the
+// sampling path entirely.
+
+// rounds a joystick_cal_apply position, in ten-thousandths, to the nearest
+// hundredth. halves round away from zero.
+static inline int32_t axis_to_centi(int32_t axis) {
+  return axis >= 0 ? (axis + 50) / 100 : -((-axis + 50) / 100);
+}
+
+// prints a value in hundredths the way "%.2f" would print it as a float:
+//   printf("x: " CENTI_FMT, CENTI_ARGS(x));
+#define CENTI_FMT "%s%d.%02d"
+#define CENTI_ARGS(v) ((v) < 0 ? "-" : ""), abs(v) / 100, abs(v) % 100
+
+#endif /* __UTIL_H__ */
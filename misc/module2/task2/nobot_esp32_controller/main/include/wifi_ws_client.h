@@ -8,6 +8,8 @@
 #ifndef __WIFI_WS_CLIENT_H__
 #define __WIFI_WS_CLIENT_H__
 
+#include <stdint.h>
+
 #include "esp_event.h"
 
 #include "sdkconfig.h"
@@ -15,8 +17,54 @@
 // set this to point to the websocket URI you will be sending controller inputs to.
 #define WEBSOCKET_URI CONFIG_WEBSOCKET_URI
 
+// how many ordered messages can wait for the sender before new ones are dropped
+#ifndef CONFIG_WEBSOCKET_OUTBOX_DEPTH
+#define CONFIG_WEBSOCKET_OUTBOX_DEPTH (8)
+#endif
+
+// how long the sender lets one message wait on a stalled connection before giving up on it
+#ifndef CONFIG_WEBSOCKET_SEND_TIMEOUT_MS
+#define CONFIG_WEBSOCKET_SEND_TIMEOUT_MS (1000)
+#endif
+
+// the first and the longest wait before trying to reconnect. every failed
+// attempt doubles it, and the actual wait is jittered within its upper half
+#ifndef CONFIG_WEBSOCKET_RECONNECT_MIN_MS
+#define CONFIG_WEBSOCKET_RECONNECT_MIN_MS (500)
+#endif
+#ifndef CONFIG_WEBSOCKET_RECONNECT_MAX_MS
+#define CONFIG_WEBSOCKET_RECONNECT_MAX_MS (30 * 1000)
+#endif
+
+// the longest message the sender takes
+#define WEBSOCKET_MESSAGE_MAX_SIZE (128)
+// send times are counted under 256 us, 512 us, ... 16 ms, and over
+#define WEBSOCKET_SEND_HISTOGRAM_BUCKETS (8)
+
+typedef struct {
+  uint32_t sent;       // messages that went out
+  uint32_t failed;     // messages the client gave up on, after an error or CONFIG_WEBSOCKET_SEND_TIMEOUT_MS
+  uint32_t coalesced;  // states replaced by a newer one before they went out
+  uint32_t dropped;    // ordered messages that found the outbox full, and messages with no connection to go on
+  uint32_t depth;      // ordered messages waiting right now
+  uint32_t depth_max;  // the most ordered messages ever waiting at once
+  uint32_t send_us[WEBSOCKET_SEND_HISTOGRAM_BUCKETS];  // how long sends took, see WEBSOCKET_SEND_HISTOGRAM_BUCKETS
+  uint32_t outages;           // connections lost
+  uint32_t attempts;          // reconnection attempts
+  uint32_t backoff_ms;        // the backoff the next failed attempt waits out, 0 while connected
+  uint32_t reconnect_ms;      // how long the last outage lasted, until connected again
+  uint32_t reconnect_max_ms;  // how long the longest outage lasted
+} websocket_client_stats_t;
+
 void websocket_client_start(void);
+// queues a text message behind the ones before it. never blocks
 void websocket_client_send(const char *data, int len);
+// hands the sender the newest controller state, replacing one not sent yet. never blocks
+void websocket_client_send_state(const char *data, int len);
+// counts the connections made so far, so a change means the server needs the full state again
+uint32_t websocket_client_connection(void);
+// copies out the sender's queue depth, drop and send time statistics, and the outage counters
+void websocket_client_get_stats(websocket_client_stats_t *stats);
 void websocket_client_stop(void);
 
 #endif /* __WIFI_WS_CLIENT_H__  */
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*
+ * wire.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __WIRE_H__
+#define __WIRE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   FORMAT                                   */
+/* -------------------------------------------------------------------------- */
+
+// the controller_state message the nobot server reads. its longest possible
+// form, and so the buffer a state always fits in (NUL included):
+#define WIRE_STATE_JSON_MAX_SIZE \
+  (sizeof("{\"type\":\"controller_state\",\"data\":{\"buttons\":65535,\"js_x\":-327.68,\"js_y\":-327.68}}"))
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint16_t buttons;
+  int16_t js_x;  // hundredths
+  int16_t js_y;  // hundredths
+} wire_state_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// encodes a controller_state message into `buf`, NUL-terminated, returning its
+// length without the NUL (0 if `len` is under WIRE_STATE_JSON_MAX_SIZE)
+size_t wire_encode_state_json(char *buf, size_t len, const wire_state_t *state);
+
+// wire_encode_state_json into a char array, failing the build if the array
+// could ever be too small
+#define WIRE_ENCODE_STATE_JSON(array, state) ({                                            \
+  _Static_assert(sizeof(array) >= WIRE_STATE_JSON_MAX_SIZE, "too small for a JSON state"); \
+  wire_encode_state_json((array), sizeof(array), (state));                                 \
+})
+
+#endif /* __WIRE_H__ */
@@ -0,0 +1,239 @@
+/*
+ * joystick_cal.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_adc_cal.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "joystick_cal.h"
+
+// our tag for ESP Info logging
+static const char *TAG = "Joystick Cal";
+
+// the NVS namespace every axis' range is stored under
+#define JOYSTICK_CAL_NAMESPACE "joystick_cal"
+// the least travel either side of centre a range can have, so the LUT never divides by ~0
+#define JOYSTICK_CAL_MIN_SPAN_MV (50)
+
+// ADC1 at 11 dB and 12 bits, characterized once for every axis
+static esp_adc_cal_characteristics_t adc_chars;
+static bool characterized = false;
+
+/* ------------------------------- CONVERSIONS ------------------------------ */
+
+/**
+ * @brief Converts a 12-bit reading to millivolts, corrected with the eFuse Vref.
+ *
+ * @param raw The 12-bit reading.
+ * @return uint16_t - The voltage at the pin, in millivolts.
+ */
+static inline uint16_t to_mv(uint16_t raw) {
+  return (uint16_t)esp_adc_cal_raw_to_voltage(raw, &adc_chars);
+}
+
+/**
+ * @brief Finds the edge of the readings a range covers.
+ *
+ * to_mv only ever rises with the reading, so this is a binary search.
+ *
+ * @param mv The voltage to look for.
+ * @param above Whether to find the first reading at or above mv, instead of the last at or below it.
+ * @return uint16_t - The reading.
+ */
+static uint16_t raw_at(uint16_t mv, bool above) {
+  int32_t lo = 0, hi = 4095;
+  while (lo < hi) {
+    if (above) {
+      int32_t mid = (lo + hi) / 2;
+      if (to_mv(mid) >= mv) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    } else {
+      int32_t mid = (lo + hi + 1) / 2;
+      if (to_mv(mid) <= mv) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+  }
+  return lo;
+}
+
+/**
+ * @brief Rebuilds an axis' LUT, and the readings that would widen it, from its range.
+ *
+ * Runs once per range change, never per sample. Every node is converted to
+ * millivolts through the ADC characterization, then scaled against whichever
+ * side of centre it falls on, so each half of the travel gets the full
+ * -10000..10000 no matter how off-centre the stick rests.
+ *
+ * @param cal The axis calibration.
+ */
+static void build_lut(joystick_cal_t *cal) {
+  joystick_cal_range_t *r = &cal->range;
+  int32_t below = r->centre_mv - r->min_mv, above = r->max_mv - r->centre_mv;
+  if (below < JOYSTICK_CAL_MIN_SPAN_MV) below = JOYSTICK_CAL_MIN_SPAN_MV;
+  if (above < JOYSTICK_CAL_MIN_SPAN_MV) above = JOYSTICK_CAL_MIN_SPAN_MV;
+  for (uint32_t node = 0; node < JOYSTICK_CAL_LUT_SIZE; node++) {
+    uint32_t raw = node << JOYSTICK_CAL_LUT_SHIFT;
+    int32_t offset = (int32_t)to_mv(raw > 4095 ? 4095 : raw) - r->centre_mv;
+    int32_t pos = offset * JOYSTICK_CAL_FULL_SCALE / (offset < 0 ? below : above);
+    if (pos < -JOYSTICK_CAL_FULL_SCALE) pos = -JOYSTICK_CAL_FULL_SCALE;
+    if (pos > JOYSTICK_CAL_FULL_SCALE) pos = JOYSTICK_CAL_FULL_SCALE;
+    cal->lut[node] = pos;
+  }
+  cal->lo_raw = raw_at(r->min_mv, true);
+  cal->hi_raw = raw_at(r->max_mv, false);
+}
+
+/* ------------------------------- PERSISTENCE ------------------------------ */
+
+/**
+ * @brief Reads an axis' range out of NVS.
+ *
+ * @param cal The axis calibration.
+ * @return bool - Whether a usable range was stored.
+ */
+static bool load_range(joystick_cal_t *cal) {
+  nvs_handle_t handle;
+  if (nvs_open(JOYSTICK_CAL_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) return false;
+  joystick_cal_range_t range;
+  size_t length = sizeof(range);
+  esp_err_t err = nvs_get_blob(handle, cal->key, &range, &length);
+  nvs_close(handle);
+  if (err != ESP_OK || length != sizeof(range)) return false;
+  if (range.min_mv >= range.centre_mv || range.centre_mv >= range.max_mv) return false;
+  cal->range = range;
+  return true;
+}
+
+/**
+ * @brief Writes an axis' range to NVS.
+ *
+ * @param cal The axis calibration.
+ * @return esp_err_t - ESP_OK once the range is committed.
+ */
+static esp_err_t save_range(joystick_cal_t *cal) {
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(JOYSTICK_CAL_NAMESPACE, NVS_READWRITE, &handle);
+  if (err != ESP_OK) return err;
+  if ((err = nvs_set_blob(handle, cal->key, &cal->range, sizeof(cal->range))) == ESP_OK) {
+    err = nvs_commit(handle);
+  }
+  nvs_close(handle);
+  return err;
+}
+
+/* ---------------------------- CENTRE AND SWEEP ---------------------------- */
+
+/**
+ * @brief Settles an axis' centre once the boot-time capture is over.
+ *
+ * @param cal The axis calibration.
+ */
+static void finish_centre(joystick_cal_t *cal) {
+  cal->centre_until_us = 0;
+  if (cal->centre_readings == 0) return;
+  uint16_t centre = (cal->centre_sum + cal->centre_readings / 2) / cal->centre_readings;
+  joystick_cal_range_t *r = &cal->range;
+
+  if (cal->stored) {
+    // a stick held at boot would drag the centre off, keep the stored one
+    if (abs((int32_t)centre - r->centre_mv) > CONFIG_JOYSTICK_CAL_CENTRE_TOLERANCE_MV ||
+        centre <= r->min_mv || centre >= r->max_mv) {
+      ESP_LOGW(TAG, "[%s] centre at %u mV, stored %u mV, keeping stored", cal->key, centre, r->centre_mv);
+      return;
+    }
+    r->centre_mv = centre;
+  } else {
+    // never swept: assume a default travel, and let the sweep widen it
+    uint16_t top = to_mv(4095);
+    r->centre_mv = centre;
+    r->min_mv = centre > CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV ? centre - CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV : 0;
+    r->max_mv = centre + CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV < top ? centre + CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV : top;
+  }
+  build_lut(cal);
+  ESP_LOGI(TAG, "[%s] %u / %u / %u mV", cal->key, r->min_mv, r->centre_mv, r->max_mv);
+}
+
+/* ---------------------------- PUBLIC INTERFACE ---------------------------- */
+
+/**
+ * @brief Sets up an axis' calibration.
+ *
+ * Characterizes ADC1 with the reference voltage burned into eFuse the first
+ * time it is called, loads the axis' stored range from NVS, and starts the
+ * boot-time centre capture. Until that capture ends, the axis reads as
+ * centred (or through its stored range, if it has one).
+ *
+ * @param cal The axis calibration to set up.
+ * @param key The NVS key to store the axis' range under.
+ * @return esp_err_t - ESP_OK, or ESP_ERR_INVALID_ARG for a missing key.
+ */
+esp_err_t joystick_cal_init(joystick_cal_t *cal, const char *key) {
+  if (key == NULL) return ESP_ERR_INVALID_ARG;
+  if (!characterized) {
+    esp_adc_cal_value_t source = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                                          CONFIG_JOYSTICK_CAL_DEFAULT_VREF_MV, &adc_chars);
+    ESP_LOGI(TAG, "ADC characterized from %s", source == ESP_ADC_CAL_VAL_EFUSE_VREF ? "eFuse Vref" :
+                                               source == ESP_ADC_CAL_VAL_EFUSE_TP ? "eFuse two point" : "default Vref");
+    characterized = true;
+  }
+
+  memset(cal, 0, sizeof(*cal));
+  cal->key = key;
+  cal->stored = load_range(cal);
+  if (cal->stored) build_lut(cal);
+  cal->centre_until_us = esp_timer_get_time() + CONFIG_JOYSTICK_CAL_CENTRE_MS * 1000;
+  return ESP_OK;
+}
+
+/**
+ * @brief Feeds a reading to an axis' calibration.
+ *
+ * During the boot-time capture, readings are averaged into the centre.
+ * After it, any reading past the ends of the range widens it, and a widened
+ * range is written to NVS once the stick has stayed inside it for
+ * CONFIG_JOYSTICK_CAL_SAVE_DELAY_MS. Readings inside the range cost two
+ * compares.
+ *
+ * @param cal The axis calibration.
+ * @param raw The 12-bit reading, filtered if possible so noise does not widen the range.
+ * @param time_us When the reading was sampled.
+ */
+void joystick_cal_track(joystick_cal_t *cal, uint16_t raw, int64_t time_us) {
+  if (cal->centre_until_us) {
+    cal->centre_sum += to_mv(raw);
+    cal->centre_readings++;
+    if (time_us >= cal->centre_until_us) finish_centre(cal);
+    return;
+  }
+
+  joystick_cal_range_t *r = &cal->range;
+  if (raw < cal->lo_raw || raw > cal->hi_raw) {
+    uint16_t mv = to_mv(raw);
+    if (mv < r->min_mv) r->min_mv = mv;
+    if (mv > r->max_mv) r->max_mv = mv;
+    build_lut(cal);
+    cal->save_at_us = time_us + CONFIG_JOYSTICK_CAL_SAVE_DELAY_MS * 1000;
+  } else if (cal->save_at_us && time_us >= cal->save_at_us) {
+    cal->save_at_us = 0;
+    esp_err_t err = save_range(cal);
+    if (err == ESP_OK) {
+      cal->stored = true;
+      ESP_LOGI(TAG, "[%s] saved %u / %u / %u mV", cal->key, r->min_mv, r->centre_mv, r->max_mv);
+    } else {
+      ESP_LOGE(TAG, "[%s] failed to save range: %s", cal->key, esp_err_to_name(err));
+    }
+  }
+}
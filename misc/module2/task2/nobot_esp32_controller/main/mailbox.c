@@ -0,0 +1,128 @@
+/*
+ * mailbox.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mailbox.h"
+
+struct mailbox {
+  portMUX_TYPE lock;               // guards seq and value, held for a copy only
+  uint32_t seq;                    // number of posts so far
+  uint32_t read_seq;               // seq at the consumer's last read
+  uint32_t notify_bits;            // set on the consumer on every post
+  TaskHandle_t volatile consumer;  // task woken by posts, NULL until known
+  size_t size;
+  uint8_t value[];
+};
+
+/**
+ * @brief Creates a mailbox for values of a fixed size.
+ *
+ * @param size The size of the values passed through the mailbox, in bytes.
+ * @param notify_bits The task notification bits a post sets on the consumer.
+ * @return mailbox_t* - The mailbox, or NULL if out of memory.
+ */
+mailbox_t *mailbox_create(size_t size, uint32_t notify_bits) {
+  mailbox_t *mailbox = calloc(1, sizeof(mailbox_t) + size);
+  if (mailbox == NULL) return NULL;
+  portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+  mailbox->lock = unlocked;
+  mailbox->notify_bits = notify_bits;
+  mailbox->size = size;
+  return mailbox;
+}
+
+/**
+ * @brief Replaces the value in the mailbox and wakes its consumer.
+ *
+ * Whatever the consumer has not read yet is simply overwritten, so the
+ * producer never waits and the consumer never works through stale backlog.
+ *
+ * @param mailbox The mailbox to post to.
+ * @param value The new value, `size` bytes long.
+ */
+void mailbox_post(mailbox_t *mailbox, const void *value) {
+  portENTER_CRITICAL(&mailbox->lock);
+  memcpy(mailbox->value, value, mailbox->size);
+  mailbox->seq++;
+  portEXIT_CRITICAL(&mailbox->lock);
+  TaskHandle_t consumer = mailbox->consumer;
+  if (consumer) xTaskNotify(consumer, mailbox->notify_bits, eSetBits);
+}
+
+/**
+ * @brief Takes the newest value out of the mailbox, if it changed.
+ *
+ * @param mailbox The mailbox to read.
+ * @param value Where to copy the value. Left untouched when nothing is new.
+ * @return uint32_t - The number of posts since the last read, 0 if none.
+ */
+uint32_t mailbox_read(mailbox_t *mailbox, void *value) {
+  portENTER_CRITICAL(&mailbox->lock);
+  uint32_t posts = mailbox->seq - mailbox->read_seq;
+  if (posts) {
+    memcpy(value, mailbox->value, mailbox->size);
+    mailbox->read_seq = mailbox->seq;
+  }
+  portEXIT_CRITICAL(&mailbox->lock);
+  return posts;
+}
+
+/**
+ * @brief Waits for the mailbox to change, then takes the newest value.
+ *
+ * @param mailbox The mailbox to read.
+ * @param value Where to copy the value. Left untouched when nothing is new.
+ * @param ticks_to_wait How long to wait for a post.
+ * @return uint32_t - The number of posts since the last read, 0 on timeout.
+ */
+uint32_t mailbox_wait(mailbox_t *mailbox, void *value, TickType_t ticks_to_wait) {
+  if (mailbox->consumer == NULL) mailbox_set_consumer(mailbox, xTaskGetCurrentTaskHandle());
+  TickType_t start = xTaskGetTickCount();
+  uint32_t posts;
+  while ((posts = mailbox_read(mailbox, value)) == 0) {
+    TickType_t waited = xTaskGetTickCount() - start;
+    if (ticks_to_wait != portMAX_DELAY && waited >= ticks_to_wait) break;
+    xTaskNotifyWait(0, mailbox->notify_bits, NULL,
+                    ticks_to_wait == portMAX_DELAY ? portMAX_DELAY : ticks_to_wait - waited);
+  }
+  return posts;
+}
+
+/**
+ * @brief Sets the task that posts to the mailbox wake up.
+ *
+ * Only needed when the consumer waits on more than one source at once;
+ * mailbox_wait registers its caller on first use.
+ *
+ * @param mailbox The mailbox.
+ * @param task The consuming task.
+ */
+void mailbox_set_consumer(mailbox_t *mailbox, TaskHandle_t task) {
+  mailbox->consumer = task;
+}
+
+/**
+ * @brief Waits for a post to any one of several mailboxes.
+ *
+ * Lets one task sleep on all of its inputs at once: each mailbox gets its own
+ * notify bits and the calling task as consumer, and whichever is posted to
+ * first wakes it. Nothing is read here; follow up with mailbox_read on each
+ * mailbox, which also picks up posts made before the consumer was set. A wake
+ * can be spurious when a post was already read before the wait began.
+ *
+ * @param notify_bits The notify bits of the mailboxes to wait on.
+ * @param ticks_to_wait How long to wait for a post.
+ * @return uint32_t - Which of notify_bits were set, 0 on timeout.
+ */
+uint32_t mailbox_wait_any(uint32_t notify_bits, TickType_t ticks_to_wait) {
+  uint32_t bits = 0;
+  xTaskNotifyWait(0, notify_bits, &bits, ticks_to_wait);
+  return bits & notify_bits;
+}
@@ -0,0 +1,272 @@
+/*
+ * trace.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_freertos_hooks.h"
+#include "esp_ipc.h"
+#include "esp_timer.h"
+
+#include "trace.h"
+
+#if CONFIG_TRACE_ENABLE
+#define RING_EVENTS CONFIG_TRACE_RING_EVENTS
+#else
+// nothing is ever recorded, so dumps only need a slot to find empty
+#define RING_EVENTS (1)
+#endif
+
+_Static_assert((RING_EVENTS & (RING_EVENTS - 1)) == 0, "the trace ring size has to be a power of two");
+_Static_assert(portNUM_PROCESSORS <= TRACE_DUMP_CORES, "a dump has an anchor for every core");
+
+#if CONFIG_PM_ENABLE
+#warning "trace cycle counts assume a fixed CPU clock, which power management does not keep"
+#endif
+
+// what a slot's sequence number reads while its event is being written
+#define SEQ_BUSY (UINT32_MAX)
+// the id a dump gives events overwritten while it was being taken
+#define ID_LOST (UINT16_MAX)
+// events a dump hands its writer at once
+#define DUMP_BATCH (16)
+// bytes of a dump trace_dump_serial prints per line
+#define SERIAL_LINE_BYTES (32)
+
+/* --------------------------------- CLOCK -------------------------------- */
+
+// a core's cycle counter wraps every 2^32 cycles (26.8 s at 160 MHz), more
+// often than events may come. so each core counts its wraps, looking at the
+// counter at every event and at every FreeRTOS tick in between, which is
+// far more often than it can wrap twice.
+typedef struct {
+  uint32_t last;  // the counter when last looked at
+  uint8_t wraps;
+} epoch_t;
+
+static epoch_t epochs[portNUM_PROCESSORS];
+
+/**
+ * @brief Reads the calling core's cycle counter, and how often it wrapped.
+ *
+ * Only ever called on the core whose epoch it updates, with interrupts
+ * masked, so the epoch needs no lock.
+ *
+ * @param wraps Set to the wraps so far, low 8 bits.
+ * @return uint32_t - The cycle counter.
+ */
+static inline IRAM_ATTR uint32_t read_cycles(uint8_t *wraps) {
+  UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+  epoch_t *epoch = &epochs[xPortGetCoreID()];
+  uint32_t cycles = esp_cpu_get_ccount();
+  if (cycles < epoch->last) epoch->wraps++;
+  epoch->last = cycles;
+  *wraps = epoch->wraps;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+  return cycles;
+}
+
+/**
+ * @brief Looks at the cycle counter every tick, to catch it wrapping.
+ */
+static void IRAM_ATTR tick_hook(void) {
+  uint8_t wraps;
+  read_cycles(&wraps);
+}
+
+/**
+ * @brief Starts counting the cycle counters' wraps on every core.
+ *
+ * Events recorded before this still work, as long as they come often
+ * enough to see every wrap themselves.
+ */
+void trace_init(void) {
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    esp_register_freertos_tick_hook_for_cpu(tick_hook, core);
+  }
+}
+
+/* ---------------------------------- RING ---------------------------------- */
+
+// the newest RING_EVENTS events, and the sequence number the next one gets.
+// the sequence number picks the slot, so writers on both cores only ever
+// contend on `head`
+static trace_record_t ring[RING_EVENTS];
+static uint32_t head = 0;
+
+/**
+ * @brief Records an event into the ring, overwriting the oldest.
+ *
+ * Claims a slot with one atomic add and fills it in; the slot's sequence
+ * number is written last, so a dump taken meanwhile can tell the event is
+ * not whole yet. Stamped with the core's cycle counter, which costs a
+ * register read where esp_timer_get_time would cost a microsecond. Lives in
+ * IRAM, so it is safe in interrupts and while the flash cache is off.
+ *
+ * @param id The event, see TRACE_EVENTS.
+ * @param a Its first argument.
+ * @param b Its second argument.
+ * @param c Its third argument.
+ * @param d Its fourth argument.
+ */
+void IRAM_ATTR trace_record(uint16_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+  uint32_t seq = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+  trace_record_t *record = &ring[seq & (RING_EVENTS - 1)];
+  __atomic_store_n(&record->seq, SEQ_BUSY, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  record->cycles = read_cycles(&record->epoch);
+  record->id = id;
+  record->core = xPortGetCoreID();
+  record->args[0] = a;
+  record->args[1] = b;
+  record->args[2] = c;
+  record->args[3] = d;
+  __atomic_store_n(&record->seq, seq, __ATOMIC_RELEASE);
+}
+
+/* ---------------------------------- DUMPS --------------------------------- */
+
+// one core's cycle count and esp_timer time, taken together
+typedef struct {
+  uint64_t cycles;
+  int64_t time_us;
+} anchor_t;
+
+/**
+ * @brief Reads the calling core's cycle count against esp_timer.
+ *
+ * The cores' cycle counters are not in step, so each gets its own anchor
+ * for the decoder to put its events on esp_timer's clock.
+ *
+ * @param arg The anchor to fill in.
+ */
+static void take_anchor(void *arg) {
+  anchor_t *anchor = arg;
+  uint8_t wraps;
+  anchor->time_us = esp_timer_get_time();
+  anchor->cycles = read_cycles(&wraps);
+  anchor->cycles |= (uint64_t)wraps << 32;
+}
+
+/**
+ * @brief Writes a value little-endian.
+ *
+ * @param buf Where to write it.
+ * @param value The value.
+ * @param size How many bytes of it.
+ */
+static void put_le(uint8_t *buf, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; i++) buf[i] = value >> (8 * i);
+}
+
+/**
+ * @brief Copies an event out of the ring, unless it changed meanwhile.
+ *
+ * @param seq The event's sequence number.
+ * @param out Where to copy it. Marked ID_LOST if it was overwritten, or is
+ * still being written.
+ */
+static void copy_record(uint32_t seq, trace_record_t *out) {
+  const trace_record_t *record = &ring[seq & (RING_EVENTS - 1)];
+  uint32_t before = __atomic_load_n(&record->seq, __ATOMIC_ACQUIRE);
+  memcpy(out, record, sizeof(trace_record_t));
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  uint32_t after = __atomic_load_n(&record->seq, __ATOMIC_RELAXED);
+  if (before != seq || after != seq) {
+    memset(out, 0, sizeof(trace_record_t));
+    out->seq = seq;
+    out->id = ID_LOST;
+  }
+}
+
+/**
+ * @brief Streams the ring out, oldest event first.
+ *
+ * Recording carries on while the dump is taken. The dump covers the events
+ * recorded up to when it started; any of those overwritten before they
+ * could be copied go out marked lost, rather than torn. The header carries
+ * what the decoder needs to put cycle counts on esp_timer's clock, see
+ * trace.h for the layout.
+ *
+ * @param write Takes every chunk of the dump in turn.
+ * @param arg Passed on to write.
+ * @return uint32_t - How many events the dump held.
+ */
+uint32_t trace_dump(trace_writer_t write, void *arg) {
+  anchor_t anchors[TRACE_DUMP_CORES] = {0};
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    esp_ipc_call_blocking(core, take_anchor, &anchors[core]);
+  }
+  uint32_t end = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+  uint32_t count = end < RING_EVENTS ? end : RING_EVENTS;
+
+  uint8_t header[TRACE_DUMP_HEADER_SIZE] = {0};
+  put_le(header + 0, TRACE_DUMP_MAGIC, 4);
+  put_le(header + 4, TRACE_DUMP_VERSION, 2);
+  put_le(header + 6, TRACE_EVENT_SIZE, 2);
+  put_le(header + 8, CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * 1000000, 4);
+  put_le(header + 12, end, 4);
+  put_le(header + 16, count, 4);
+  put_le(header + 20, portNUM_PROCESSORS, 4);
+  for (int core = 0; core < TRACE_DUMP_CORES; core++) {
+    put_le(header + 24 + 8 * core, anchors[core].cycles, 8);
+    put_le(header + 40 + 8 * core, anchors[core].time_us, 8);
+  }
+  if (!write(header, sizeof(header), arg)) return 0;
+
+  // the records are already laid out little-endian, as the ESP32 is
+  trace_record_t batch[DUMP_BATCH];
+  for (uint32_t seq = end - count; seq != end;) {
+    size_t n = 0;
+    while (n < DUMP_BATCH && seq != end) copy_record(seq++, &batch[n++]);
+    if (!write(batch, n * sizeof(trace_record_t), arg)) break;
+  }
+  return count;
+}
+
+/**
+ * @brief Prints a chunk of a dump on the console, in hex.
+ *
+ * @param data The chunk.
+ * @param len Its length.
+ * @param arg Placeholder for the writer argument (unused)
+ * @return bool - Always true.
+ */
+static bool print_hex(const void *data, size_t len, void *arg) {
+  static const char digits[] = "0123456789abcdef";
+  const uint8_t *bytes = data;
+  char line[sizeof("TRACE ") + 2 * SERIAL_LINE_BYTES];
+  while (len) {
+    size_t n = len < SERIAL_LINE_BYTES ? len : SERIAL_LINE_BYTES;
+    char *p = line + sizeof("TRACE ") - 1;
+    memcpy(line, "TRACE ", sizeof("TRACE ") - 1);
+    for (size_t i = 0; i < n; i++) {
+      *p++ = digits[bytes[i] >> 4];
+      *p++ = digits[bytes[i] & 0xf];
+    }
+    *p = '\0';
+    puts(line);
+    bytes += n;
+    len -= n;
+  }
+  return true;
+}
+
+/**
+ * @brief Prints a dump on the console, for trace_decode.
+ *
+ * Plain "TRACE <hex>" lines between "TRACE BEGIN" and "TRACE END", so the
+ * decoder can pick the dump out of a monitor capture with the logs around
+ * it. Also handy from a debugger: `call trace_dump_serial()`.
+ */
+void trace_dump_serial(void) {
+  puts("TRACE BEGIN");
+  uint32_t count = trace_dump(print_hex, NULL);
+  printf("TRACE END %u events\n", count);
+}
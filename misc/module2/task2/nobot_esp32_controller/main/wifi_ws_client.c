@@ -11,37 +11,306 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_wifi.h"
 #include "esp_websocket_client.h"
 #include "esp_event.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 
+#include "mailbox.h"
+#include "trace.h"
 #include "wifi_ws_client.h"
+#include "wire.h"
 
 #define NO_DATA_TIMEOUT_SEC 300
 
 /** \brief Tag for ESP logging */
 static const char *TAG = "nobot websocket client";
 
-/* ----------------------------- SHUTDOWN TIMER ----------------------------- */
+esp_websocket_client_handle_t client;
 
-static TimerHandle_t shutdown_signal_timer;
-static SemaphoreHandle_t shutdown_sema;
+/* ------------------------------ SENDER TASK ------------------------------ */
 
-esp_websocket_client_handle_t client;
+// set on the sender when a state or an ordered message is waiting
+#define STATE_NOTIFY_BIT (1UL << 0)
+#define ORDERED_NOTIFY_BIT (1UL << 1)
+#define TRACE_NOTIFY_BIT (1UL << 2)
+// sends between two statistics lines in the debug log
+#define STATS_LOG_SENDS (1024)
+
+_Static_assert(WEBSOCKET_MESSAGE_MAX_SIZE >= WIRE_STATE_JSON_MAX_SIZE, "a state has to fit in a message");
+
+// a message waiting for the sender
+typedef struct {
+  uint16_t len;
+  char data[WEBSOCKET_MESSAGE_MAX_SIZE];
+} outbound_t;
+
+// the sender, the newest controller state for it, and the ordered messages
+// waiting for it, oldest first
+static TaskHandle_t sender;
+static mailbox_t *state_slot;
+static QueueHandle_t ordered;
+// sender statistics, written by the sender and by whoever queues messages
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static websocket_client_stats_t stats;
+
+/**
+ * @brief Finds the histogram bucket for a send time.
+ *
+ * @param us How long the send took.
+ * @return uint32_t - The bucket, see WEBSOCKET_SEND_HISTOGRAM_BUCKETS.
+ */
+static inline uint32_t send_time_bucket(uint32_t us) {
+  uint32_t bucket = 0;
+  for (us >>= 8; us && bucket < WEBSOCKET_SEND_HISTOGRAM_BUCKETS - 1; us >>= 1) bucket++;
+  return bucket;
+}
+
+/**
+ * @brief Puts one message on the wire, and counts how it went.
+ *
+ * @param message The message.
+ */
+static void send_now(const outbound_t *message) {
+  if (!esp_websocket_client_is_connected(client)) {
+    TRACE(TRACE_WS_NOT_CONNECTED, 1, message->len);
+    portENTER_CRITICAL(&stats_lock);
+    stats.dropped++;
+    portEXIT_CRITICAL(&stats_lock);
+    return;
+  }
+  TickType_t timeout = CONFIG_WEBSOCKET_SEND_TIMEOUT_MS / portTICK_PERIOD_MS;
+  int64_t start_us = esp_timer_get_time();
+  int sent = esp_websocket_client_send_text(client, message->data, message->len, timeout);
+  uint32_t took_us = esp_timer_get_time() - start_us;
+  TRACE(TRACE_WS_SEND, 1, message->len, took_us, sent);
+
+  portENTER_CRITICAL(&stats_lock);
+  if (sent < 0) {
+    stats.failed++;
+  } else {
+    stats.sent++;
+  }
+  stats.send_us[send_time_bucket(took_us)]++;
+  bool log = (stats.sent + stats.failed) % STATS_LOG_SENDS == 0;
+  portEXIT_CRITICAL(&stats_lock);
+  if (sent < 0) ESP_LOGW(TAG, "Failed to send %d byte message after %u us", message->len, took_us);
+  if (log) {
+    websocket_client_stats_t now;
+    websocket_client_get_stats(&now);
+    ESP_LOGD(TAG, "%u sent, %u failed, %u coalesced, %u dropped, depth %u (max %u), "
+                  "send us <256:%u <512:%u <1k:%u <2k:%u <4k:%u <8k:%u <16k:%u more:%u",
+             now.sent, now.failed, now.coalesced, now.dropped, now.depth, now.depth_max,
+             now.send_us[0], now.send_us[1], now.send_us[2], now.send_us[3],
+             now.send_us[4], now.send_us[5], now.send_us[6], now.send_us[7]);
+  }
+}
+
+/**
+ * @brief Picks up the server asking for a trace dump.
+ *
+ * {"type":"trace"} has the dump printed on the console, as this controller
+ * only speaks text frames.
+ *
+ * @param text The text frame received.
+ * @param len Its length.
+ */
+static void request_trace(const char *text, int len) {
+  char msg[48];
+  if (len <= 0 || (size_t)len >= sizeof(msg)) return;
+  memcpy(msg, text, len);
+  msg[len] = '\0';
+  if (strstr(msg, "\"type\":\"trace\"") == NULL) return;
+  xTaskNotify(sender, TRACE_NOTIFY_BIT, eSetBits);
+}
+
+/**
+ * @brief Sends whatever the other tasks hand over.
+ *
+ * The only task that ever waits on the network, so a stalled connection
+ * holds up this task and nothing else. Ordered messages go out first and in
+ * the order they were queued; after them, only the newest controller state
+ * goes out, whichever states it replaced while a send was stuck. A trace
+ * dump, asked for by the server, is printed after everything else.
+ *
+ * @param pvParameter Placeholder values to pass into the task function (unused)
+ */
+static void websocket_sender_task(void *pvParameter) {
+  static outbound_t message;
+  uint32_t bits = 0;
+  while (true) {
+    while (xQueueReceive(ordered, &message, 0)) send_now(&message);
+    uint32_t posts = mailbox_read(state_slot, &message);
+    if (posts) {
+      portENTER_CRITICAL(&stats_lock);
+      stats.coalesced += posts - 1;
+      portEXIT_CRITICAL(&stats_lock);
+      send_now(&message);
+    }
+    if (bits & TRACE_NOTIFY_BIT) trace_dump_serial();
+    bits = mailbox_wait_any(STATE_NOTIFY_BIT | ORDERED_NOTIFY_BIT | TRACE_NOTIFY_BIT, portMAX_DELAY);
+  }
+}
+
+/**
+ * @brief Queues a message behind the ones before it, never waiting.
+ *
+ * @param data The message.
+ * @param len Its length.
+ */
+static void queue_ordered(const char *data, int len) {
+  outbound_t message;
+  bool queued = false;
+  if (len >= 0 && len <= WEBSOCKET_MESSAGE_MAX_SIZE) {
+    message.len = len;
+    memcpy(message.data, data, len);
+    queued = xQueueSend(ordered, &message, 0) == pdTRUE;
+  }
+
+  uint32_t depth = uxQueueMessagesWaiting(ordered);
+  portENTER_CRITICAL(&stats_lock);
+  if (!queued) stats.dropped++;
+  if (depth > stats.depth_max) stats.depth_max = depth;
+  portEXIT_CRITICAL(&stats_lock);
+  if (queued) {
+    xTaskNotify(sender, ORDERED_NOTIFY_BIT, eSetBits);
+  } else if (len > WEBSOCKET_MESSAGE_MAX_SIZE) {
+    ESP_LOGW(TAG, "Dropped %d byte message - too long.", len);
+  } else {
+    TRACE(TRACE_WS_OUTBOX_FULL, len);
+  }
+}
+
+/* --------------------------- CONNECTION MANAGER --------------------------- */
+
+// set on the manager by the websocket events, and by the no-data timer
+#define CONNECTED_NOTIFY_BIT (1UL << 0)
+#define DISCONNECTED_NOTIFY_BIT (1UL << 1)
+#define NO_DATA_NOTIFY_BIT (1UL << 2)
+
+// the manager, and the timer that has it reconnect a connection gone quiet
+static TaskHandle_t manager;
+static TimerHandle_t no_data_timer;
+// connections made so far, see websocket_client_connection
+static volatile uint32_t connection = 0;
+// when the connection was lost, 0 while it is up
+static int64_t down_since_us = 0;
 
 /**
- * @brief Handler called after 10 seconds of no data
+ * @brief Has the manager reconnect after NO_DATA_TIMEOUT_SEC without data.
  *
- * Closes the websocket connection after no data has been received for 10 seconds.
- * This may need to be changed––though I'm not sure about HTTP standards on the topic.
+ * The server pongs our pings, so a connection this quiet is dead even if
+ * the socket has not noticed yet.
  *
  * @param xTimer
  */
-static void shutdown_signaler(TimerHandle_t xTimer) {
-  ESP_LOGI(TAG, "No data received for %d seconds, signaling shutdown", NO_DATA_TIMEOUT_SEC);
-  xSemaphoreGive(shutdown_sema);
+static void no_data_signaler(TimerHandle_t xTimer) {
+  ESP_LOGI(TAG, "No data received for %d seconds, reconnecting", NO_DATA_TIMEOUT_SEC);
+  xTaskNotify(manager, NO_DATA_NOTIFY_BIT, eSetBits);
+}
+
+/**
+ * @brief Picks a delay somewhere in the upper half of the backoff.
+ *
+ * The jitter keeps controllers that lost the server together from all
+ * coming back at the same moment.
+ *
+ * @param backoff_ms The current backoff.
+ * @return uint32_t - The delay, between backoff_ms / 2 and backoff_ms.
+ */
+static inline uint32_t jittered(uint32_t backoff_ms) {
+  return backoff_ms / 2 + esp_random() % (backoff_ms / 2 + 1);
+}
+
+/**
+ * @brief Counts the start of an outage, if one is not already going.
+ */
+static void note_down(void) {
+  portENTER_CRITICAL(&stats_lock);
+  if (down_since_us == 0) {
+    down_since_us = esp_timer_get_time();
+    stats.outages++;
+  }
+  portEXIT_CRITICAL(&stats_lock);
+}
+
+/**
+ * @brief Keeps the websocket connected.
+ *
+ * The client's own reconnect is off, as it only retries at a fixed interval.
+ * Instead, whenever the connection drops (or a connection attempt fails),
+ * this waits out a jittered backoff that doubles with every failed attempt,
+ * from CONFIG_WEBSOCKET_RECONNECT_MIN_MS up to CONFIG_WEBSOCKET_RECONNECT_MAX_MS,
+ * and starts the client again. A successful connection resets the backoff;
+ * the handshake and state resync then happen on the new connection itself.
+ *
+ * @param pvParameter Placeholder values to pass into the task function (unused)
+ */
+static void websocket_manager_task(void *pvParameter) {
+  uint32_t backoff_ms = CONFIG_WEBSOCKET_RECONNECT_MIN_MS;
+  while (true) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, CONNECTED_NOTIFY_BIT | DISCONNECTED_NOTIFY_BIT | NO_DATA_NOTIFY_BIT, &bits, portMAX_DELAY);
+    if (bits & NO_DATA_NOTIFY_BIT) {
+      // stopping does not raise a disconnect event, so count the outage here
+      esp_websocket_client_stop(client);
+      note_down();
+    } else if (bits & CONNECTED_NOTIFY_BIT && esp_websocket_client_is_connected(client)) {
+      backoff_ms = CONFIG_WEBSOCKET_RECONNECT_MIN_MS;
+      continue;
+    } else if (!(bits & DISCONNECTED_NOTIFY_BIT)) {
+      continue;
+    }
+
+    // back off, then try again. stopping first waits for the client's task
+    // to wind down after the failed connection
+    uint32_t delay_ms = jittered(backoff_ms);
+    TRACE(TRACE_WS_RECONNECT, delay_ms, stats.attempts + 1);
+    vTaskDelay(delay_ms / portTICK_PERIOD_MS);
+    backoff_ms = backoff_ms * 2 < CONFIG_WEBSOCKET_RECONNECT_MAX_MS ? backoff_ms * 2 : CONFIG_WEBSOCKET_RECONNECT_MAX_MS;
+    portENTER_CRITICAL(&stats_lock);
+    stats.attempts++;
+    stats.backoff_ms = backoff_ms;
+    portEXIT_CRITICAL(&stats_lock);
+    esp_websocket_client_stop(client);
+    esp_err_t err = esp_websocket_client_start(client);
+    if (err != ESP_OK) {
+      // try again after the next backoff, as if the attempt had failed to connect
+      ESP_LOGW(TAG, "Failed to restart the client: %s", esp_err_to_name(err));
+      xTaskNotify(manager, DISCONNECTED_NOTIFY_BIT, eSetBits);
+    }
+  }
+}
+
+/**
+ * @brief Counts a connection coming up, and how long it was down before.
+ */
+static void note_connected(void) {
+  int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&stats_lock);
+  if (down_since_us) {
+    stats.reconnect_ms = (now_us - down_since_us) / 1000;
+    if (stats.reconnect_ms > stats.reconnect_max_ms) stats.reconnect_max_ms = stats.reconnect_ms;
+    down_since_us = 0;
+  }
+  stats.backoff_ms = 0;
+  portEXIT_CRITICAL(&stats_lock);
+  connection++;
+  TRACE(TRACE_WS_CONNECTED, connection);
+  xTimerReset(no_data_timer, portMAX_DELAY);
+  xTaskNotify(manager, CONNECTED_NOTIFY_BIT, eSetBits);
+}
+
+/**
+ * @brief Counts a connection going down, or an attempt failing to come up.
+ */
+static void note_disconnected(void) {
+  note_down();
+  TRACE(TRACE_WS_DISCONNECTED, stats.outages);
+  xTaskNotify(manager, DISCONNECTED_NOTIFY_BIT, eSetBits);
 }
 
 /* ---------------------------- WEBSOCKET EVENTS ---------------------------- */
@@ -49,8 +318,8 @@ static void shutdown_signaler(TimerHandle_t xTimer) {
 /**
  * @brief Handles any event coming from the websocket.
  *
- * All events are simply logged, except for data events in which the data is
- * logged and the shutdown timer is reset to keep the websocket connection open.
+ * All events are logged. Connection changes go to the connection manager,
+ * and data events reset the no-data timer to keep the connection open.
  *
  * @param handler_args
  * @param base
@@ -62,13 +331,18 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base, i
   switch (event_id) {
     case WEBSOCKET_EVENT_CONNECTED:
       ESP_LOGI(TAG, "WEBSOCKET_EVENT_CONNECTED");
-      // send a client_type message to initialize connection
+      // send a client_type message to initialize connection. it goes through
+      // the outbox like everything else, so it is the first thing the sender
+      // puts on the new connection
       char init_msg[64] = "{\"type\": \"client_type\", \"data\": \"controller\"}";
       ESP_LOGI(TAG, "Sending %s", init_msg);
-      esp_websocket_client_send_text(client, init_msg, strlen(init_msg), portMAX_DELAY);
+      websocket_client_send(init_msg, strlen(init_msg));
+      // the controller task sees the new connection, and sends its full state
+      note_connected();
       break;
     case WEBSOCKET_EVENT_DISCONNECTED:
       ESP_LOGI(TAG, "WEBSOCKET_EVENT_DISCONNECTED");
+      note_disconnected();
       break;
     case WEBSOCKET_EVENT_DATA:
       ESP_LOGI(TAG, "WEBSOCKET_EVENT_DATA");
@@ -77,8 +351,12 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base, i
         ESP_LOGI(TAG, "Received opcode=%d", data->op_code);
         ESP_LOGI(TAG, "Received=%.*s", data->data_len, (char *)data->data_ptr);
         ESP_LOGW(TAG, "Total payload length=%d, data-len=%d, current payload offset=%d\r\n", data->payload_len, data->data_len, data->payload_offset);
+        // opcode 1 is a text frame, which is where trace requests come in
+        if (data->op_code == 1 && data->payload_offset == 0 && data->data_len == data->payload_len) {
+          request_trace((const char *)data->data_ptr, data->data_len);
+        }
       }
-      xTimerReset(shutdown_signal_timer, portMAX_DELAY);
+      xTimerReset(no_data_timer, portMAX_DELAY);
       break;
     case WEBSOCKET_EVENT_ERROR:
       ESP_LOGI(TAG, "WEBSOCKET_EVENT_ERROR");
@@ -90,41 +368,105 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base, i
  * @brief Begins the websocket connection.
  */
 void websocket_client_start(void) {
-  // init the websocket connection config
+  // init the websocket connection config. the connection manager does the
+  // reconnecting, with backoff
   esp_websocket_client_config_t websocket_cfg = {
-      .uri = WEBSOCKET_URI};
+      .uri = WEBSOCKET_URI,
+      .disable_auto_reconnect = true};
+
+  // create the no-data signal, called after no data for NO_DATA_TIMEOUT_SEC seconds
+  no_data_timer = xTimerCreate("Websocket no-data timer", NO_DATA_TIMEOUT_SEC * 1000 / portTICK_PERIOD_MS, pdFALSE, NULL, no_data_signaler);
 
-  // create the shutdown signal, called after no data for NO_DATA_TIMEOUT_SEC seconds
-  shutdown_signal_timer = xTimerCreate("Websocket shutdown timer", NO_DATA_TIMEOUT_SEC * 1000 / portTICK_PERIOD_MS, pdFALSE, NULL, shutdown_signaler);
-  shutdown_sema = xSemaphoreCreateBinary();
+  // create the sender, before anything can be handed to it
+  ordered = xQueueCreate(CONFIG_WEBSOCKET_OUTBOX_DEPTH, sizeof(outbound_t));
+  state_slot = mailbox_create(sizeof(outbound_t), STATE_NOTIFY_BIT);
+  if (ordered == NULL || state_slot == NULL ||
+      xTaskCreate(websocket_sender_task, "websocket_sender_task", 4096, NULL, 3, &sender) != pdPASS) {
+    ESP_LOGE(TAG, "failed to start the websocket sender");
+    return;
+  }
+  mailbox_set_consumer(state_slot, sender);
+  // and the manager, before any connection event can come in
+  if (xTaskCreate(websocket_manager_task, "websocket_manager_task", 3072, NULL, 2, &manager) != pdPASS) {
+    ESP_LOGE(TAG, "failed to start the websocket connection manager");
+    return;
+  }
 
   // begin the connection, with the above event handler for all events
   ESP_LOGI(TAG, "Connecting to %s...", websocket_cfg.uri);
   client = esp_websocket_client_init(&websocket_cfg);
   esp_websocket_register_events(client, WEBSOCKET_EVENT_ANY, websocket_event_handler, (void *)client);
   esp_websocket_client_start(client);
-  xTimerStart(shutdown_signal_timer, portMAX_DELAY);
+  xTimerStart(no_data_timer, portMAX_DELAY);
 }
 
 /**
- * @brief Sends a message through the websocket. Should already be JSON-encoded
+ * @brief Queues a message for the websocket. Should already be JSON-encoded
+ *
+ * For messages whose order matters, like command acks: they go out one by
+ * one, in the order they were queued, ahead of any controller state. Never
+ * waits on the network; when the outbox is full the message is dropped.
+ *
+ * @param data The message.
+ * @param len Its length, at most WEBSOCKET_MESSAGE_MAX_SIZE.
  */
 void websocket_client_send(const char *data, int len) {
-  // send the message
-  if (esp_websocket_client_is_connected(client)) {
-    ESP_LOGI(TAG, "Sending %s", data);
-    esp_websocket_client_send_text(client, data, len, portMAX_DELAY);
-  } else {
-    ESP_LOGW(TAG, "Failed to send message '%s' - websocket is not connected.", data);
+  queue_ordered(data, len);
+}
+
+/**
+ * @brief Hands the newest controller state to the websocket sender.
+ *
+ * Latest wins: a state the sender has not got to yet is replaced, as only
+ * the newest one matters. Never waits on the network.
+ *
+ * @param data The state, JSON-encoded.
+ * @param len Its length, at most WEBSOCKET_MESSAGE_MAX_SIZE.
+ */
+void websocket_client_send_state(const char *data, int len) {
+  if (len < 0 || len > WEBSOCKET_MESSAGE_MAX_SIZE) {
+    ESP_LOGW(TAG, "Dropped %d byte state - too long.", len);
+    return;
   }
+  outbound_t message = {.len = len};
+  memcpy(message.data, data, len);
+  mailbox_post(state_slot, &message);
+}
+
+/**
+ * @brief Counts the connections made so far.
+ *
+ * Goes up every time the websocket (re)connects. A task holding state the
+ * server should have compares it against the last value it saw, and sends
+ * its full state when it changes, so the server never keeps acting on what
+ * it heard before the outage.
+ *
+ * @return uint32_t - The number of connections, 0 before the first one.
+ */
+uint32_t websocket_client_connection(void) {
+  return connection;
+}
+
+/**
+ * @brief Copies out the sender's and connection manager's statistics.
+ *
+ * @param out Where to copy the statistics.
+ */
+void websocket_client_get_stats(websocket_client_stats_t *out) {
+  portENTER_CRITICAL(&stats_lock);
+  *out = stats;
+  portEXIT_CRITICAL(&stats_lock);
+  out->depth = ordered ? uxQueueMessagesWaiting(ordered) : 0;
 }
 
 /**
- * @brief Ends the websocket connection.
+ * @brief Ends the websocket connection, for good.
  */
 void websocket_client_stop(void) {
-  // shut down the websocket
-  xSemaphoreTake(shutdown_sema, portMAX_DELAY);
+  // shut down the websocket, and the tasks that use it
+  xTimerStop(no_data_timer, portMAX_DELAY);
+  vTaskDelete(manager);
+  vTaskDelete(sender);
   esp_websocket_client_stop(client);
   ESP_LOGI(TAG, "websocket stopped");
   esp_websocket_client_destroy(client);
@@ -0,0 +1,77 @@
+/*
+ * wire.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <string.h>
+
+#include "wire.h"
+
+// copies a string literal in, without its NUL
+#define PRINT_LITERAL(p, literal) (memcpy((p), (literal), sizeof(literal) - 1), (p) + sizeof(literal) - 1)
+
+/**
+ * @brief Writes an unsigned integer in decimal.
+ *
+ * Digits come out of the bottom first, so they go into a scratch buffer and
+ * are copied over in the right order.
+ *
+ * @param p Where to write it.
+ * @param value The value.
+ * @return char* - Just past the last digit.
+ */
+static char *print_u32(char *p, uint32_t value) {
+  char digits[10];
+  int n = 0;
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (n) *p++ = digits[--n];
+  return p;
+}
+
+/**
+ * @brief Writes a value in hundredths the way "%.2f" would print it as a float.
+ *
+ * @param p Where to write it.
+ * @param centi The value, in hundredths.
+ * @return char* - Just past the last digit.
+ */
+static char *print_centi(char *p, int16_t centi) {
+  uint32_t magnitude = centi < 0 ? -(int32_t)centi : centi;
+  if (centi < 0) *p++ = '-';
+  p = print_u32(p, magnitude / 100);
+  *p++ = '.';
+  *p++ = '0' + magnitude / 10 % 10;
+  *p++ = '0' + magnitude % 10;
+  return p;
+}
+
+/**
+ * @brief Encodes a controller state as a controller_state message.
+ *
+ * Integer formatting only, straight into the caller's buffer: no newlib
+ * printf machinery, no floats and nothing allocated. The buffer is checked
+ * against the longest possible message once up front, rather than per field;
+ * use WIRE_ENCODE_STATE_JSON to have that checked at compile time instead.
+ *
+ * @param buf Where to write the message.
+ * @param len How much room there is in buf.
+ * @param state The state to encode.
+ * @return size_t - The length of the message without its NUL, or 0 if buf is too small.
+ */
+size_t wire_encode_state_json(char *buf, size_t len, const wire_state_t *state) {
+  if (len < WIRE_STATE_JSON_MAX_SIZE) return 0;
+  char *p = buf;
+  p = PRINT_LITERAL(p, "{\"type\":\"controller_state\",\"data\":{\"buttons\":");
+  p = print_u32(p, state->buttons);
+  p = PRINT_LITERAL(p, ",\"js_x\":");
+  p = print_centi(p, state->js_x);
+  p = PRINT_LITERAL(p, ",\"js_y\":");
+  p = print_centi(p, state->js_y);
+  p = PRINT_LITERAL(p, "}}");
+  *p = '\0';
+  return p - buf;
+}
@@ -0,0 +1,8 @@
+#ifndef __HOST_ESP_WIFI_H__
+#define __HOST_ESP_WIFI_H__
+
+#include "esp_err.h"
+
+typedef enum { WIFI_AUTH_OPEN, WIFI_AUTH_WPA2_PSK } wifi_auth_mode_t;
+
+#endif /* __HOST_ESP_WIFI_H__ */
@@ -0,0 +1,566 @@
+/*
+ * host.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "esp_adc_cal.h"
+#include "esp_err.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_websocket_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "nvs.h"
+
+#include "host.h"
+
+int64_t host_now_us = 0;
+uint32_t host_notified = 0;
+uint32_t host_nvs_commits = 0;
+bool host_nvs_fail = false;
+
+const char *esp_err_to_name(esp_err_t err) {
+  return err == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+/* ---------------------------------- TIMERS -------------------------------- */
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void *arg;
+  bool active;
+  int64_t deadline_us;
+  uint64_t period_us;  // 0 for a timer that fires once
+  struct esp_timer *next;
+};
+
+static struct esp_timer *timers = NULL;
+
+int64_t esp_timer_get_time(void) {
+  return host_now_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+  struct esp_timer *timer = calloc(1, sizeof(struct esp_timer));
+  if (timer == NULL) return ESP_ERR_NO_MEM;
+  timer->callback = args->callback;
+  timer->arg = args->arg;
+  timer->next = timers;
+  timers = timer;
+  *out = timer;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  if (timer->active) return ESP_ERR_INVALID_STATE;
+  timer->active = true;
+  timer->deadline_us = host_now_us + timeout_us;
+  timer->period_us = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+  if (timer->active) return ESP_ERR_INVALID_STATE;
+  timer->active = true;
+  timer->deadline_us = host_now_us + period_us;
+  timer->period_us = period_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer->active) return ESP_ERR_INVALID_STATE;
+  timer->active = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  for (struct esp_timer **t = &timers; *t; t = &(*t)->next) {
+    if (*t == timer) {
+      *t = timer->next;
+      free(timer);
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_INVALID_ARG;
+}
+
+int64_t host_next_timer_us(void) {
+  int64_t next_us = INT64_MAX;
+  for (struct esp_timer *t = timers; t; t = t->next) {
+    if (t->active && t->deadline_us < next_us) next_us = t->deadline_us;
+  }
+  return next_us;
+}
+
+void host_advance(int64_t until_us) {
+  while (true) {
+    struct esp_timer *due = NULL;
+    for (struct esp_timer *t = timers; t; t = t->next) {
+      if (t->active && t->deadline_us <= until_us && (due == NULL || t->deadline_us < due->deadline_us)) due = t;
+    }
+    if (due == NULL) break;
+    host_now_us = due->deadline_us;
+    due->deadline_us += due->period_us;
+    due->active = due->period_us != 0;
+    due->callback(due->arg);
+  }
+  host_now_us = until_us;
+}
+
+/* ---------------------------------- TASKS --------------------------------- */
+
+// far more than any task gets on the controller, as host code is bigger
+#define TASK_STACK_SIZE (256 * 1024)
+
+struct host_task {
+  TaskFunction_t code;
+  void *arg;
+  UBaseType_t priority;
+  ucontext_t context;
+  void *stack;
+  bool started;
+  bool deleted;
+  bool waiting;      // for a notification, as well as for wake_us
+  int64_t wake_us;   // when its wait or delay ends, INT64_MAX for never
+  uint32_t notified;
+  bool pending;      // notified since its last wait
+  struct host_task *next;
+};
+
+// the test's own task, which keeps its bits in host_notified, and the rest
+static struct host_task test_task = {.wake_us = INT64_MAX};
+static struct host_task *tasks = NULL;
+static struct host_task *current = &test_task;
+// where a task that blocks goes back to
+static ucontext_t scheduler;
+
+static int64_t ticks_us(TickType_t ticks) {
+  return (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+static uint32_t *bits_of(struct host_task *task) {
+  return task == &test_task ? &host_notified : &task->notified;
+}
+
+/**
+ * @brief Switches from the running task back to the test, until `wake_us`
+ * or, when `waiting`, until the task is notified.
+ */
+static void block(int64_t wake_us, bool waiting) {
+  if (current == &test_task) {
+    fprintf(stderr, "host: the test's own task cannot block\n");
+    abort();
+  }
+  current->wake_us = wake_us;
+  current->waiting = waiting;
+  swapcontext(&current->context, &scheduler);
+}
+
+static bool ready(const struct host_task *task) {
+  if (task->deleted) return false;
+  return !task->started || (task->waiting && task->pending) || task->wake_us <= host_now_us;
+}
+
+// a task that returns is gone, as if it had deleted itself
+static void trampoline(void) {
+  current->code(current->arg);
+  current->deleted = true;
+}
+
+void host_run_tasks(void) {
+  while (true) {
+    struct host_task *next = NULL;
+    for (struct host_task *t = tasks; t; t = t->next) {
+      if (ready(t) && (next == NULL || t->priority > next->priority)) next = t;
+    }
+    if (next == NULL) return;
+    next->wake_us = INT64_MAX;
+    next->waiting = false;
+    if (!next->started) {
+      getcontext(&next->context);
+      next->stack = malloc(TASK_STACK_SIZE);
+      next->context.uc_stack.ss_sp = next->stack;
+      next->context.uc_stack.ss_size = TASK_STACK_SIZE;
+      next->context.uc_link = &scheduler;
+      makecontext(&next->context, trampoline, 0);
+      next->started = true;
+    }
+    current = next;
+    swapcontext(&scheduler, &next->context);
+    current = &test_task;
+  }
+}
+
+void host_run_until(int64_t until_us) {
+  host_run_tasks();
+  while (true) {
+    int64_t next_us = host_next_timer_us();
+    for (struct host_task *t = tasks; t; t = t->next) {
+      if (!t->deleted && t->wake_us < next_us) next_us = t->wake_us;
+    }
+    if (next_us > until_us) break;
+    host_advance(next_us);
+    host_run_tasks();
+  }
+  host_advance(until_us);
+  host_run_tasks();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *out) {
+  struct host_task *task = calloc(1, sizeof(struct host_task));
+  if (task == NULL) return pdFALSE;
+  task->code = code;
+  task->arg = arg;
+  task->priority = priority;
+  task->wake_us = INT64_MAX;
+  struct host_task **last = &tasks;
+  while (*last) last = &(*last)->next;
+  *last = task;
+  if (out) *out = task;
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task == NULL) task = current;
+  task->deleted = true;
+  if (task == current && task != &test_task) swapcontext(&task->context, &scheduler);
+}
+
+void vTaskDelay(TickType_t ticks) {
+  block(host_now_us + ticks_us(ticks), false);
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return host_now_us / ticks_us(1);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return current;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+  uint32_t *bits = bits_of(task);
+  if (action == eSetBits) *bits |= value;
+  if (action == eIncrement) (*bits)++;
+  if (action == eSetValueWithOverwrite) *bits = value;
+  task->pending = true;
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t ticks) {
+  struct host_task *task = current;
+  uint32_t *bits = bits_of(task);
+  if (!task->pending) {
+    *bits &= ~clear_on_entry;
+    if (ticks) block(ticks == portMAX_DELAY ? INT64_MAX : host_now_us + ticks_us(ticks), true);
+  }
+  if (value) *value = *bits;
+  if (!task->pending) return pdFALSE;
+  *bits &= ~clear_on_exit;
+  task->pending = false;
+  return pdTRUE;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  return 0;
+}
+
+/* --------------------------------- QUEUES --------------------------------- */
+
+struct host_queue {
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t head;
+  UBaseType_t count;
+  uint8_t items[];
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  struct host_queue *queue = calloc(1, sizeof(struct host_queue) + length * item_size);
+  if (queue == NULL) return NULL;
+  queue->length = length;
+  queue->item_size = item_size;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+  if (queue->count == queue->length) return pdFALSE;
+  UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+  queue->count++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+  if (queue->count == 0) return pdFALSE;
+  memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return queue->count;
+}
+
+/* ------------------------------ FREERTOS TIMERS ---------------------------- */
+
+// on top of the esp_timers above
+struct host_timer {
+  esp_timer_handle_t timer;
+  TimerCallbackFunction_t callback;
+  int64_t period_us;
+  bool auto_reload;
+};
+
+static void fire(void *arg) {
+  struct host_timer *timer = arg;
+  timer->callback(timer);
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                           TimerCallbackFunction_t callback) {
+  struct host_timer *timer = calloc(1, sizeof(struct host_timer));
+  if (timer == NULL) return NULL;
+  esp_timer_create_args_t args = {.callback = fire, .arg = timer, .name = name};
+  if (esp_timer_create(&args, &timer->timer) != ESP_OK) {
+    free(timer);
+    return NULL;
+  }
+  timer->callback = callback;
+  timer->period_us = ticks_us(period);
+  timer->auto_reload = auto_reload;
+  return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks) {
+  esp_timer_stop(timer->timer);
+  if (timer->auto_reload) return esp_timer_start_periodic(timer->timer, timer->period_us) == ESP_OK;
+  return esp_timer_start_once(timer->timer, timer->period_us) == ESP_OK;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks) {
+  return xTimerStart(timer, ticks);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks) {
+  esp_timer_stop(timer->timer);
+  return pdPASS;
+}
+
+/* --------------------------------- RANDOM --------------------------------- */
+
+static uint32_t random_state = 1;
+
+void host_seed(uint32_t seed) {
+  random_state = seed ? seed : 1;
+}
+
+uint32_t esp_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+/* ------------------------------------ ADC ---------------------------------- */
+
+// an 11 dB curve: flat at the bottom, roughly linear, and bending over at the top
+static const uint16_t curve[][2] = {
+    {0, 75}, {500, 480}, {2000, 1700}, {3000, 2500}, {3600, 2950}, {4095, 3150},
+};
+
+uint32_t host_mv(uint32_t raw) {
+  if (raw > 4095) raw = 4095;
+  size_t i = 1;
+  while (curve[i][0] < raw) i++;
+  uint32_t x0 = curve[i - 1][0], x1 = curve[i][0], y0 = curve[i - 1][1], y1 = curve[i][1];
+  return y0 + ((y1 - y0) * (raw - x0) + (x1 - x0) / 2) / (x1 - x0);
+}
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten, adc_bits_width_t width,
+                                             uint32_t default_vref, esp_adc_cal_characteristics_t *chars) {
+  chars->vref = default_vref;
+  return ESP_ADC_CAL_VAL_EFUSE_VREF;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t *chars) {
+  return host_mv(raw);
+}
+
+/* ------------------------------------ NVS ---------------------------------- */
+
+#define BLOBS (8)
+
+static struct {
+  char key[16];
+  uint8_t value[32];
+  size_t length;
+} blobs[BLOBS];
+
+static int find(const char *key) {
+  for (int i = 0; i < BLOBS; i++) {
+    if (blobs[i].length && strcmp(blobs[i].key, key) == 0) return i;
+  }
+  return -1;
+}
+
+bool host_nvs_get(const char *key, void *out, size_t length) {
+  int i = find(key);
+  if (i < 0 || blobs[i].length != length) return false;
+  memcpy(out, blobs[i].value, length);
+  return true;
+}
+
+void host_nvs_erase(void) {
+  memset(blobs, 0, sizeof(blobs));
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out) {
+  *out = 1;
+  return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *length) {
+  int i = find(key);
+  if (i < 0) return ESP_ERR_NOT_FOUND;
+  if (out != NULL) memcpy(out, blobs[i].value, blobs[i].length < *length ? blobs[i].length : *length);
+  *length = blobs[i].length;
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+  if (host_nvs_fail) return ESP_FAIL;
+  if (length == 0 || length > sizeof(blobs[0].value) || strlen(key) >= sizeof(blobs[0].key)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int i = find(key);
+  for (int j = 0; i < 0 && j < BLOBS; j++) {
+    if (blobs[j].length == 0) i = j;
+  }
+  if (i < 0) return ESP_ERR_NO_MEM;
+  strcpy(blobs[i].key, key);
+  memcpy(blobs[i].value, value, length);
+  blobs[i].length = length;
+  return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+  host_nvs_commits++;
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {}
+
+/* -------------------------------- WEBSOCKET -------------------------------- */
+
+struct host_websocket {
+  esp_event_handler_t handler;
+  void *arg;
+};
+
+static struct host_websocket websocket;
+
+bool host_ws_connected = false;
+int64_t host_ws_send_us = 0;
+bool host_ws_fail = false;
+uint32_t host_ws_starts = 0;
+uint32_t host_ws_stops = 0;
+int64_t host_ws_started_us = 0;
+host_frame_t host_ws_sent[HOST_WS_FRAMES];
+uint32_t host_ws_sent_count = 0;
+
+static void raise_event(int32_t id, esp_websocket_event_data_t *data) {
+  if (websocket.handler) websocket.handler(websocket.arg, "WEBSOCKET_EVENTS", id, data);
+}
+
+void host_ws_connect(void) {
+  host_ws_connected = true;
+  raise_event(WEBSOCKET_EVENT_CONNECTED, &(esp_websocket_event_data_t){0});
+}
+
+void host_ws_drop(void) {
+  host_ws_connected = false;
+  raise_event(WEBSOCKET_EVENT_DISCONNECTED, &(esp_websocket_event_data_t){0});
+}
+
+void host_ws_receive(const char *text) {
+  int len = strlen(text);
+  esp_websocket_event_data_t data = {
+      .data_ptr = text, .data_len = len, .op_code = 1, .payload_len = len, .payload_offset = 0};
+  raise_event(WEBSOCKET_EVENT_DATA, &data);
+}
+
+esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_client_config_t *config) {
+  memset(&websocket, 0, sizeof(websocket));
+  return &websocket;
+}
+
+esp_err_t esp_websocket_register_events(esp_websocket_client_handle_t client, esp_websocket_event_id_t event,
+                                        esp_event_handler_t handler, void *arg) {
+  client->handler = handler;
+  client->arg = arg;
+  return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_start(esp_websocket_client_handle_t client) {
+  host_ws_starts++;
+  host_ws_started_us = host_now_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_stop(esp_websocket_client_handle_t client) {
+  host_ws_stops++;
+  host_ws_connected = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_destroy(esp_websocket_client_handle_t client) {
+  client->handler = NULL;
+  return ESP_OK;
+}
+
+bool esp_websocket_client_is_connected(esp_websocket_client_handle_t client) {
+  return host_ws_connected;
+}
+
+/**
+ * @brief Holds the sending task for as long as a send takes, then keeps the
+ * frame if it went out.
+ */
+static int send_frame(uint8_t op_code, const char *data, int len, TickType_t timeout) {
+  int64_t limit_us = timeout == portMAX_DELAY ? INT64_MAX : ticks_us(timeout);
+  bool timed_out = host_ws_send_us > limit_us;
+  if (current == &test_task) {
+    host_advance(host_now_us + (timed_out ? limit_us : host_ws_send_us));
+  } else {
+    block(host_now_us + (timed_out ? limit_us : host_ws_send_us), false);
+  }
+  if (host_ws_fail || timed_out || !host_ws_connected) return -1;
+  if (host_ws_sent_count < HOST_WS_FRAMES) {
+    host_frame_t *frame = &host_ws_sent[host_ws_sent_count];
+    frame->op_code = op_code;
+    frame->len = len;
+    frame->at_us = host_now_us;
+    memcpy(frame->data, data, len < HOST_WS_FRAME_SIZE ? len : HOST_WS_FRAME_SIZE);
+  }
+  host_ws_sent_count++;
+  return len;
+}
+
+int esp_websocket_client_send_text(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout) {
+  return send_frame(0x1, data, len, timeout);
+}
+
+int esp_websocket_client_send_bin(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout) {
+  return send_frame(0x2, data, len, timeout);
+}
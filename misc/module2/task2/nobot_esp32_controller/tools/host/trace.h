@@ -0,0 +1,16 @@
+#ifndef __HOST_TRACE_H__
+#define __HOST_TRACE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACE(...) ((void)0)
+
+typedef bool (*trace_writer_t)(const void *data, size_t len, void *arg);
+
+// left to the test that needs them
+uint32_t trace_dump(trace_writer_t write, void *arg);
+void trace_dump_serial(void);
+
+#endif /* __HOST_TRACE_H__ */
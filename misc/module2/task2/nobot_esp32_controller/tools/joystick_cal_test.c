@@ -0,0 +1,247 @@
+/*
+ * joystick_cal_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Runs joystick_cal.c against a simulated ADC curve and NVS, and checks the
+ * LUT, the range sweep, and the boot-time centre capture.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o joystick_cal_test joystick_cal_test.c host/host.c
+ *   ./joystick_cal_test
+ *
+ * - LUT: every reading comes out within 0.1% of its exact position on the
+ *   curve (0.5% in the one LUT step where the range clamps), the ends are
+ *   full deflection, and nothing runs backwards. 4095 is 15/16 of the way
+ *   to the top node, so it comes out a hair short of full, at 0.9997.
+ * - Sweep: a reading past the range widens it at once, but it only reaches
+ *   NVS once the stick has stayed inside it for the save delay, and a later
+ *   widening pushes that back.
+ * - Centre: a centre near the stored one is taken, one held off at boot is
+ *   thrown away for the stored one, and so is a malformed stored range.
+ */
+
+#include <stdio.h>
+
+#include "host.h"
+#include "../main/joystick_cal.c"
+
+// a reading every 8 ms, at controller_main.c's 125 Hz report tick
+#define FRAME_US (8000)
+// where the stick rests
+#define REST (1900)
+// how far off an interpolated reading may come out, in ten-thousandths. in
+// the one LUT step where a range clamps at full deflection the LUT cuts the
+// corner, and may be further off
+#define LUT_TOLERANCE (10)
+#define LUT_CORNER_TOLERANCE (50)
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                   \
+  do {                                     \
+    checks++;                              \
+    if (!(cond) && failures++ < 10) {      \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                 \
+      printf("\n");                        \
+    }                                      \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                   HELPERS                                  */
+/* -------------------------------------------------------------------------- */
+
+// feeds the same reading for a while, a frame at a time
+static void hold(joystick_cal_t *cal, uint16_t raw, int64_t for_us) {
+  for (int64_t until_us = host_now_us + for_us; host_now_us < until_us; host_now_us += FRAME_US) {
+    joystick_cal_track(cal, raw, host_now_us);
+  }
+}
+
+// moves the stick from one reading to another, a frame at every step and one at the end
+static void sweep(joystick_cal_t *cal, int from, int to, int step) {
+  for (int raw = from; step > 0 ? raw < to : raw > to; raw += step) {
+    joystick_cal_track(cal, raw, host_now_us);
+    host_now_us += FRAME_US;
+  }
+  joystick_cal_track(cal, to, host_now_us);
+  host_now_us += FRAME_US;
+}
+
+// boots an axis, at rest on a reading through the centre capture
+static void boot(joystick_cal_t *cal, uint16_t rest) {
+  joystick_cal_init(cal, "x");
+  hold(cal, rest, CONFIG_JOYSTICK_CAL_CENTRE_MS * 1000 + FRAME_US);
+}
+
+// where a reading is on an axis' range, exactly
+static int32_t exact(const joystick_cal_range_t *r, uint16_t raw) {
+  int32_t offset = (int32_t)host_mv(raw) - r->centre_mv;
+  int32_t span = offset < 0 ? r->centre_mv - r->min_mv : r->max_mv - r->centre_mv;
+  int32_t pos = offset * JOYSTICK_CAL_FULL_SCALE / span;
+  if (pos < -JOYSTICK_CAL_FULL_SCALE) return -JOYSTICK_CAL_FULL_SCALE;
+  if (pos > JOYSTICK_CAL_FULL_SCALE) return JOYSTICK_CAL_FULL_SCALE;
+  return pos;
+}
+
+// whether the LUT step a reading falls in has one end clamped and the other not
+static bool corner(const joystick_cal_range_t *r, uint16_t raw) {
+  uint32_t lo = raw >> JOYSTICK_CAL_LUT_SHIFT << JOYSTICK_CAL_LUT_SHIFT;
+  uint32_t hi = lo + (1 << JOYSTICK_CAL_LUT_SHIFT) > 4095 ? 4095 : lo + (1 << JOYSTICK_CAL_LUT_SHIFT);
+  return (abs(exact(r, lo)) == JOYSTICK_CAL_FULL_SCALE) != (abs(exact(r, hi)) == JOYSTICK_CAL_FULL_SCALE);
+}
+
+/**
+ * @brief Checks every reading's position against the exact one, and returns
+ * the largest difference away from the corners.
+ */
+static int32_t check_positions(const joystick_cal_t *cal) {
+  int32_t worst = 0, last = -JOYSTICK_CAL_FULL_SCALE;
+  for (uint16_t raw = 0; raw <= 4095; raw++) {
+    int32_t pos = joystick_cal_apply(cal, raw);
+    int32_t error = abs(pos - exact(&cal->range, raw));
+    if (corner(&cal->range, raw)) {
+      CHECK(error <= LUT_CORNER_TOLERANCE, "reading %u at %d, exactly %d", raw, pos, exact(&cal->range, raw));
+    } else {
+      CHECK(error <= LUT_TOLERANCE, "reading %u at %d, exactly %d", raw, pos, exact(&cal->range, raw));
+      if (error > worst) worst = error;
+    }
+    CHECK(pos >= last, "reading %u at %d, below the reading before it at %d", raw, pos, last);
+    last = pos;
+  }
+  return worst;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static void check_lut(void) {
+  host_nvs_erase();
+  joystick_cal_t cal;
+  boot(&cal, REST);
+
+  // never swept: the default travel around where it rested
+  const joystick_cal_range_t *r = &cal.range;
+  CHECK(r->centre_mv == host_mv(REST), "centre at %u mV, rested at %u mV", r->centre_mv, host_mv(REST));
+  CHECK(r->min_mv == r->centre_mv - CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV, "min at %u mV", r->min_mv);
+  CHECK(r->max_mv == r->centre_mv + CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV, "max at %u mV", r->max_mv);
+  CHECK(abs(joystick_cal_apply(&cal, REST)) <= LUT_TOLERANCE, "rest at %d", joystick_cal_apply(&cal, REST));
+  int32_t worst = check_positions(&cal);
+  printf("lut: default range %u / %u / %u mV, worst reading %d ten-thousandths off\n", r->min_mv, r->centre_mv,
+         r->max_mv, worst);
+
+  // swept to both ends: each half scaled on its own
+  sweep(&cal, REST, 0, -1);
+  sweep(&cal, 0, 4095, 1);
+  CHECK(r->min_mv == host_mv(0) && r->max_mv == host_mv(4095), "swept to %u / %u mV", r->min_mv, r->max_mv);
+  CHECK(joystick_cal_apply(&cal, 0) == -JOYSTICK_CAL_FULL_SCALE, "bottom at %d", joystick_cal_apply(&cal, 0));
+  CHECK(joystick_cal_apply(&cal, 4095) >= JOYSTICK_CAL_FULL_SCALE - LUT_TOLERANCE, "top at %d",
+        joystick_cal_apply(&cal, 4095));
+  worst = check_positions(&cal);
+  printf("lut: swept range %u / %u / %u mV, worst reading %d ten-thousandths off\n", r->min_mv, r->centre_mv,
+         r->max_mv, worst);
+}
+
+static void check_sweep(void) {
+  host_nvs_erase();
+  joystick_cal_t cal;
+  boot(&cal, REST);
+  const int64_t delay_us = CONFIG_JOYSTICK_CAL_SAVE_DELAY_MS * 1000;
+  uint32_t commits = host_nvs_commits;
+  joystick_cal_range_t range = cal.range, stored;
+
+  // wobbling inside the range changes nothing
+  for (int i = 0; i < 1000; i++) sweep(&cal, cal.lo_raw + i % 7, cal.hi_raw, (cal.hi_raw - cal.lo_raw) / 3);
+  CHECK(!memcmp(&range, &cal.range, sizeof(range)), "the range moved without being swept");
+  CHECK(host_nvs_commits == commits, "saved without being swept");
+
+  // past the top: widened there and then, saved only once it settles
+  sweep(&cal, REST, 4095, 64);
+  int64_t widened_us = host_now_us;
+  CHECK(cal.range.max_mv == host_mv(4095), "max at %u mV after the top", cal.range.max_mv);
+  CHECK(joystick_cal_apply(&cal, 4095) >= JOYSTICK_CAL_FULL_SCALE - LUT_TOLERANCE, "top at %d",
+        joystick_cal_apply(&cal, 4095));
+  hold(&cal, REST, delay_us / 2);
+  CHECK(host_nvs_commits == commits, "saved %lld ms after the top", (long long)(host_now_us - widened_us) / 1000);
+
+  // past the bottom before that: the save waits for the bottom instead
+  sweep(&cal, REST, 0, -64);
+  widened_us = host_now_us;
+  CHECK(cal.range.min_mv == host_mv(0), "min at %u mV after the bottom", cal.range.min_mv);
+  hold(&cal, REST, delay_us - FRAME_US);
+  CHECK(host_nvs_commits == commits, "saved %lld ms after the bottom", (long long)(host_now_us - widened_us) / 1000);
+  hold(&cal, REST, 2 * FRAME_US);
+  CHECK(host_nvs_commits == commits + 1, "%u saves once the range settled", host_nvs_commits - commits);
+  CHECK(cal.stored, "not marked stored once saved");
+  CHECK(host_nvs_get("x", &stored, sizeof(stored)) && !memcmp(&stored, &cal.range, sizeof(stored)),
+        "the saved range is not the swept one");
+
+  // and not again until it moves
+  hold(&cal, REST, 2 * delay_us);
+  CHECK(host_nvs_commits == commits + 1, "%u saves with nothing new", host_nvs_commits - commits);
+  printf("sweep: widened to %u / %u / %u mV, saved once, %d ms after the last widening\n", cal.range.min_mv,
+         cal.range.centre_mv, cal.range.max_mv, CONFIG_JOYSTICK_CAL_SAVE_DELAY_MS);
+}
+
+static void check_centre(void) {
+  // a stored range to boot against
+  host_nvs_erase();
+  joystick_cal_t cal;
+  boot(&cal, REST);
+  sweep(&cal, REST, 0, -64);
+  sweep(&cal, 0, 4095, 64);
+  hold(&cal, REST, CONFIG_JOYSTICK_CAL_SAVE_DELAY_MS * 1000 + FRAME_US);
+  joystick_cal_range_t stored;
+  CHECK(host_nvs_get("x", &stored, sizeof(stored)), "nothing stored to boot against");
+
+  // until the capture ends the stored range is used
+  joystick_cal_init(&cal, "x");
+  CHECK(cal.stored && !memcmp(&cal.range, &stored, sizeof(stored)), "the stored range did not load");
+  CHECK(abs(joystick_cal_apply(&cal, REST)) <= LUT_TOLERANCE, "rest at %d before the capture ended",
+        joystick_cal_apply(&cal, REST));
+
+  // resting a little off the stored centre: that is where it rests now
+  uint16_t drifted = REST + 40;
+  hold(&cal, drifted, CONFIG_JOYSTICK_CAL_CENTRE_MS * 1000 + FRAME_US);
+  CHECK(cal.range.centre_mv == host_mv(drifted), "centre at %u mV, rested at %u mV", cal.range.centre_mv,
+        host_mv(drifted));
+  CHECK(abs(joystick_cal_apply(&cal, drifted)) <= LUT_TOLERANCE, "drifted rest at %d",
+        joystick_cal_apply(&cal, drifted));
+
+  // held over at boot: the stored centre stays
+  uint16_t held = 3000;
+  CHECK(abs((int32_t)host_mv(held) - stored.centre_mv) > CONFIG_JOYSTICK_CAL_CENTRE_TOLERANCE_MV,
+        "%u is inside the tolerance", held);
+  joystick_cal_init(&cal, "x");
+  hold(&cal, held, CONFIG_JOYSTICK_CAL_CENTRE_MS * 1000 + FRAME_US);
+  CHECK(cal.range.centre_mv == stored.centre_mv, "centre at %u mV after a held boot, stored %u mV",
+        cal.range.centre_mv, stored.centre_mv);
+  CHECK(abs(joystick_cal_apply(&cal, REST)) <= LUT_TOLERANCE, "rest at %d after a held boot",
+        joystick_cal_apply(&cal, REST));
+  CHECK(joystick_cal_apply(&cal, held) > JOYSTICK_CAL_FULL_SCALE / 2, "held at %d", joystick_cal_apply(&cal, held));
+
+  // a malformed range is not loaded, so the boot-time centre is used
+  stored.min_mv = stored.centre_mv;
+  nvs_set_blob(0, "x", &stored, sizeof(stored));
+  joystick_cal_init(&cal, "x");
+  CHECK(!cal.stored, "a malformed range loaded");
+  hold(&cal, held, CONFIG_JOYSTICK_CAL_CENTRE_MS * 1000 + FRAME_US);
+  CHECK(cal.range.centre_mv == host_mv(held), "centre at %u mV with a malformed range", cal.range.centre_mv);
+  printf("centre: drifted by 40 counts taken, held at %u mV thrown away for %u mV\n", host_mv(held),
+         stored.centre_mv);
+}
+
+int main(void) {
+  check_lut();
+  check_sweep();
+  check_centre();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * joystick_math_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Checks util.h's axis_to_centi, which turns joystick_cal_apply positions
+ * into the hundredths the controller reports, against the double code it
+ * stands in for, and times both.
+ *
+ *   cc -std=gnu11 -O2 -Wall -I../main/include -o joystick_math_test joystick_math_test.c -lm
+ *   ./joystick_math_test
+ *
+ * Equivalence is on what leaves the controller: the text "%0.2f" prints for
+ * the position as a double against what CENTI_FMT prints for axis_to_centi,
+ * over every position joystick_cal_apply can return. The only differences
+ * allowed are "-0.00" just below centre, and exact halves, which the double
+ * rounds by whichever side of the half its binary lands on; anything else
+ * fails the run. Every position is also checked against exact rounding.
+ *
+ * The deadzone is a plain comparison in controller_main.c, on the positions
+ * before rounding, so there is nothing of it to check here.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "util.h"
+
+// full deflection, as joystick_cal.h has it
+#define FULL_SCALE (10000)
+
+/* -------------------------------------------------------------------------- */
+/*                                  OLD CODE                                  */
+/* -------------------------------------------------------------------------- */
+
+static double axis_double(int32_t axis) {
+  return axis / (double)FULL_SCALE;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static int check_rounding(void) {
+  // to the nearest hundredth, halves away from zero, and the same either side
+  int failures = 0;
+  for (int32_t axis = -FULL_SCALE; axis <= FULL_SCALE; axis++) {
+    int32_t centi = axis_to_centi(axis);
+    int32_t error = abs(centi * 100 - axis);
+    bool ok = error < 50 || (error == 50 && abs(centi * 100) > abs(axis));
+    ok &= axis_to_centi(-axis) == -centi;
+    if (!ok && failures++ < 5) printf("rounding: position %d came out %d\n", axis, centi);
+  }
+  printf("rounding: %d positions%s\n", 2 * FULL_SCALE + 1, failures ? " - FAILED" : "");
+  return failures;
+}
+
+static int check_text(void) {
+  int failures = 0, negative_zero = 0, halves = 0;
+  for (int32_t axis = -FULL_SCALE; axis <= FULL_SCALE; axis++) {
+    char old[32], new[32];
+    snprintf(old, sizeof(old), "%0.2f", axis_double(axis));
+    snprintf(new, sizeof(new), CENTI_FMT, CENTI_ARGS(axis_to_centi(axis)));
+    if (strcmp(old, new) == 0) continue;
+    if (strcmp(old, "-0.00") == 0 && strcmp(new, "0.00") == 0) {
+      negative_zero++;
+    } else if (abs(axis) % 100 == 50) {
+      halves++;
+    } else if (failures++ < 5) {
+      printf("text: position %d, old %s, new %s\n", axis, old, new);
+    }
+  }
+  printf("text: %d positions, %d differ: %d negative zero, %d exact halves%s\n", 2 * FULL_SCALE + 1,
+         failures + negative_zero + halves, negative_zero, halves, failures ? " - FAILED" : "");
+  return failures;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  BENCHMARK                                 */
+/* -------------------------------------------------------------------------- */
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// one report's worth: both axes, rounded and printed
+static void bench(void) {
+  enum { SAMPLES = 1 << 22 };
+  static int32_t positions[4096];
+  uint32_t seed = 1;
+  for (int i = 0; i < 4096; i++) {
+    seed = seed * 1103515245 + 12345;
+    positions[i] = (int32_t)((seed >> 8) % (2 * FULL_SCALE + 1)) - FULL_SCALE;
+  }
+
+  char text[64];
+  volatile int sink = 0;
+  double start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) {
+    sink += snprintf(text, sizeof(text), "%0.2f %0.2f", axis_double(positions[i & 4095]),
+                     axis_double(positions[(i + 1) & 4095]));
+  }
+  double old_ns = (now_ns() - start) / SAMPLES;
+
+  start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) {
+    int32_t x = axis_to_centi(positions[i & 4095]);
+    int32_t y = axis_to_centi(positions[(i + 1) & 4095]);
+    sink += snprintf(text, sizeof(text), CENTI_FMT " " CENTI_FMT, CENTI_ARGS(x), CENTI_ARGS(y));
+  }
+  double new_ns = (now_ns() - start) / SAMPLES;
+
+  printf("\nns per report (two axes, rounded and printed): double %.2f, fixed point %.2f\n", old_ns, new_ns);
+  printf("this host has hardware doubles; the ESP32 runs every double op above through soft-float\n");
+}
+
+int main(void) {
+  int failures = check_rounding() + check_text();
+  bench();
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
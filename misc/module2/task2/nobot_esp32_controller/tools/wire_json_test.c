@@ -0,0 +1,139 @@
+/*
+ * wire_json_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Checks wire.c's wire_encode_state_json writes byte for byte what the
+ * sprintf it replaced in controller_main.c wrote, and times both.
+ *
+ *   cc -std=gnu11 -O2 -Wall -I../main/include -o wire_json_test wire_json_test.c
+ *   ./wire_json_test
+ *
+ * The states are every button value against 18 pairs of axes, the int16
+ * extremes among them, then every position axis_to_centi can report on one
+ * axis against a spread on the other, about 1.2M in all. Exits non-zero on
+ * the first few mismatches.
+ *
+ * These are host numbers. The on-device stack high-water mark and cycle
+ * counts have not been measured.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "util.h"
+#include "../main/wire.c"
+
+static int failures = 0;
+static int checks = 0;
+static int compared = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                  OLD CODE                                  */
+/* -------------------------------------------------------------------------- */
+
+// controller_main.c's read_controller_task, before wire_encode_state_json
+static int old_json(char *message, size_t len, const wire_state_t *state) {
+  return snprintf(message, len, "{\"type\":\"controller_state\",\"data\":{\"buttons\":%d,\"js_x\":" CENTI_FMT ",\"js_y\":" CENTI_FMT "}}",
+                  state->buttons, CENTI_ARGS(state->js_x), CENTI_ARGS(state->js_y));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static void check(const wire_state_t *state) {
+  char old[256], new[WIRE_STATE_JSON_MAX_SIZE];
+  compared++;
+  int old_len = old_json(old, sizeof(old), state);
+  size_t new_len = WIRE_ENCODE_STATE_JSON(new, state);
+  CHECK(new_len == (size_t)old_len && strcmp(old, new) == 0, "old %s\n  new %s", old, new);
+  CHECK(new_len < WIRE_STATE_JSON_MAX_SIZE, "%zu bytes for a %zu-byte bound", new_len,
+        (size_t)WIRE_STATE_JSON_MAX_SIZE);
+}
+
+static void check_states(void) {
+  const int16_t axes[] = {INT16_MIN, INT16_MIN + 1, -10000, -101, -100, -99, -10, -9, -1,
+                          0,         1,             9,      10,   99,   100,  101, 10000, INT16_MAX};
+  const size_t count = sizeof(axes) / sizeof(axes[0]);
+  for (uint32_t buttons = 0; buttons <= 0xffff; buttons++) {
+    for (size_t x = 0; x < count; x++) {
+      check(&(wire_state_t){.buttons = buttons, .js_x = axes[x], .js_y = axes[count - 1 - x]});
+    }
+  }
+  // every position the controller reports, on both axes
+  for (int32_t centi = -100; centi <= 100; centi++) {
+    for (int32_t other = -100; other <= 100; other += 7) {
+      check(&(wire_state_t){.buttons = centi & 0xff, .js_x = centi, .js_y = other});
+      check(&(wire_state_t){.buttons = other & 0xff, .js_x = other, .js_y = centi});
+    }
+  }
+  // and the longest possible message
+  check(&(wire_state_t){.buttons = 0xffff, .js_x = INT16_MIN, .js_y = INT16_MIN});
+}
+
+static void check_rejects(void) {
+  char buf[WIRE_STATE_JSON_MAX_SIZE];
+  wire_state_t state = {0};
+  CHECK(wire_encode_state_json(buf, sizeof(buf) - 1, &state) == 0, "encoded into a short buffer");
+  CHECK(wire_encode_state_json(buf, 0, &state) == 0, "encoded into no buffer");
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  BENCHMARK                                 */
+/* -------------------------------------------------------------------------- */
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(void) {
+  enum { SAMPLES = 1 << 22 };
+  static wire_state_t states[4096];
+  uint32_t seed = 1;
+  for (int i = 0; i < 4096; i++) {
+    seed = seed * 1103515245 + 12345;
+    // what the controller sends: a few buttons, the sticks within +-1.00
+    states[i] = (wire_state_t){.buttons = seed >> 28, .js_x = (int16_t)((seed >> 8) % 201) - 100,
+                               .js_y = (int16_t)((seed >> 16) % 201) - 100};
+  }
+
+  char message[256];
+  volatile size_t sink = 0;
+  double start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) sink += old_json(message, sizeof(message), &states[i & 4095]);
+  double old_ns = (now_ns() - start) / SAMPLES;
+
+  start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) sink += WIRE_ENCODE_STATE_JSON(message, &states[i & 4095]);
+  double new_ns = (now_ns() - start) / SAMPLES;
+
+  printf("ns per message: snprintf %.1f, wire_encode_state_json %.1f (host, -O2)\n", old_ns, new_ns);
+}
+
+int main(void) {
+  check_states();
+  check_rejects();
+  printf("%d states against snprintf\n", compared);
+  bench();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * ws_reconnect_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Runs wifi_ws_client.c's connection manager against host.h's fake
+ * websocket, on a simulated clock, through outages that take many attempts
+ * to come back from, and checks the waits between attempts, the statistics,
+ * and what goes out on the connection that comes back.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o ws_reconnect_test ws_reconnect_test.c host/host.c
+ *   ./ws_reconnect_test [seed]
+ *
+ * - jitter: 100k draws at every backoff step fall in its upper half, and
+ *   reach both ends of it.
+ * - backoff: after a drop, each failed attempt doubles the wait from
+ *   CONFIG_WEBSOCKET_RECONNECT_MIN_MS up to CONFIG_WEBSOCKET_RECONNECT_MAX_MS,
+ *   and a connection resets it.
+ * - resync: the connection count goes up on every connection, and the
+ *   client_type greeting goes out ahead of the full state a controller
+ *   sends when it sees that.
+ * - no data: a connection quiet for NO_DATA_TIMEOUT_SEC is stopped and
+ *   counted as an outage, then reconnected like any other.
+ *
+ * The space controller's manager is the same; its tools/ws_reconnect_test.c
+ * runs the same checks.
+ *
+ * Waits are in FreeRTOS ticks, 10 ms here, so a wait may come out up to a
+ * tick short of its jittered delay.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "../main/mailbox.c"
+#include "../main/wifi_ws_client.c"
+
+#define TICK_US (portTICK_PERIOD_MS * 1000)
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+void trace_dump_serial(void) {}
+
+/* -------------------------------------------------------------------------- */
+/*                                   HELPERS                                  */
+/* -------------------------------------------------------------------------- */
+
+static websocket_client_stats_t stats_now(void) {
+  websocket_client_stats_t now;
+  websocket_client_get_stats(&now);
+  return now;
+}
+
+// the backoff after `failed` failed attempts
+static uint32_t backoff_after(int failed) {
+  uint32_t backoff_ms = CONFIG_WEBSOCKET_RECONNECT_MIN_MS;
+  while (failed-- > 0 && backoff_ms < CONFIG_WEBSOCKET_RECONNECT_MAX_MS) backoff_ms *= 2;
+  return backoff_ms < CONFIG_WEBSOCKET_RECONNECT_MAX_MS ? backoff_ms : CONFIG_WEBSOCKET_RECONNECT_MAX_MS;
+}
+
+/**
+ * @brief Runs until the manager starts the client again, and returns how
+ * long after `since_us` it did, or -1 if it did not within a minute.
+ */
+static int64_t next_attempt(int64_t since_us) {
+  uint32_t starts = host_ws_starts;
+  int64_t until_us = host_now_us + 60000000;
+  while (host_ws_starts == starts && host_now_us < until_us) host_run_until(host_now_us + TICK_US);
+  return host_ws_starts == starts ? -1 : host_ws_started_us - since_us;
+}
+
+/**
+ * @brief Checks a wait came out within the jittered range of a backoff.
+ */
+static void check_wait(int64_t waited_us, uint32_t backoff_ms, const char *what) {
+  int64_t low_us = (int64_t)backoff_ms / 2 * 1000 - TICK_US, high_us = (int64_t)backoff_ms * 1000;
+  CHECK(waited_us >= low_us && waited_us <= high_us, "%s: waited %lld ms, backoff %u ms", what,
+        (long long)waited_us / 1000, backoff_ms);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static void check_jitter(void) {
+  for (int step = 0; backoff_after(step - 1) < CONFIG_WEBSOCKET_RECONNECT_MAX_MS; step++) {
+    uint32_t backoff_ms = backoff_after(step), low = UINT32_MAX, high = 0;
+    for (int i = 0; i < 100000; i++) {
+      uint32_t delay_ms = jittered(backoff_ms);
+      if (delay_ms < low) low = delay_ms;
+      if (delay_ms > high) high = delay_ms;
+    }
+    CHECK(low == backoff_ms / 2 && high == backoff_ms, "a %u ms backoff drew %u-%u ms", backoff_ms, low, high);
+    printf("jitter: %5u ms backoff drew %5u-%5u ms\n", backoff_ms, low, high);
+  }
+}
+
+static void check_backoff(void) {
+  websocket_client_start();
+  host_ws_connect();
+  host_run_until(host_now_us + 1000000);
+  CHECK(websocket_client_connection() == 1, "connection %u", websocket_client_connection());
+
+  // down, and every attempt fails for a while: the waits double, up to the cap
+  websocket_client_stats_t before = stats_now();
+  int64_t down_us = host_now_us;
+  host_ws_drop();
+  int64_t since_us = host_now_us;
+  const int attempts = 12;
+  printf("backoff:");
+  for (int failed = 0; failed < attempts; failed++) {
+    int64_t waited_us = next_attempt(since_us);
+    check_wait(waited_us, backoff_after(failed), "after a failed attempt");
+    printf(" %lld", (long long)waited_us / 1000);
+    CHECK(stats_now().backoff_ms == backoff_after(failed + 1), "attempt %d: next backoff %u ms", failed + 1,
+          stats_now().backoff_ms);
+    if (failed < attempts - 1) {
+      host_ws_drop();
+      since_us = host_now_us;
+    }
+  }
+  printf(" ms\n");
+  CHECK(websocket_client_connection() == 1, "connected during an outage");
+
+  // the last attempt connects: the outage is over, and counted
+  int64_t outage_ms = (host_now_us - down_us) / 1000;
+  host_ws_connect();
+  host_run_until(host_now_us + 1000000);
+  websocket_client_stats_t after = stats_now();
+  CHECK(websocket_client_connection() == 2, "connection %u after the outage", websocket_client_connection());
+  CHECK(after.outages - before.outages == 1, "%u outages for one drop", after.outages - before.outages);
+  CHECK(after.attempts - before.attempts == attempts, "%u attempts", after.attempts - before.attempts);
+  CHECK(after.backoff_ms == 0, "backoff %u ms while connected", after.backoff_ms);
+  CHECK(after.reconnect_ms == outage_ms && after.reconnect_max_ms == after.reconnect_ms,
+        "reconnect %u ms (max %u) for a %lld ms outage", after.reconnect_ms, after.reconnect_max_ms,
+        (long long)outage_ms);
+  printf("backoff: %d attempts over %lld s, capped at %d ms\n", attempts, (long long)outage_ms / 1000,
+         CONFIG_WEBSOCKET_RECONNECT_MAX_MS);
+
+  // and the next drop starts from the bottom again
+  host_ws_drop();
+  since_us = host_now_us;
+  check_wait(next_attempt(since_us), CONFIG_WEBSOCKET_RECONNECT_MIN_MS, "after a reset");
+  host_ws_connect();
+  host_run_until(host_now_us + 1000000);
+  CHECK(stats_now().reconnect_max_ms == after.reconnect_max_ms, "a short outage raised the longest to %u ms",
+        stats_now().reconnect_max_ms);
+}
+
+static void check_resync(void) {
+  // what a controller loop does: a new connection gets the full state
+  uint32_t seen = websocket_client_connection();
+  host_ws_drop();
+  next_attempt(host_now_us);
+  uint32_t first = host_ws_sent_count;
+  host_ws_connect();
+  CHECK(websocket_client_connection() == seen + 1, "connection %u after %u", websocket_client_connection(), seen);
+  if (websocket_client_connection() != seen) websocket_client_send_state("full state", 10);
+  host_run_until(host_now_us + 1000000);
+  CHECK(host_ws_sent_count == first + 2, "%u frames on the new connection", host_ws_sent_count - first);
+  CHECK(strstr(host_ws_sent[first].data, "\"client_type\"") != NULL, "the greeting was not first");
+  CHECK(host_ws_sent[first + 1].len == 10 && memcmp(host_ws_sent[first + 1].data, "full state", 10) == 0,
+        "the full state was not second");
+  printf("resync: greeting, then the full state, on connection %u\n", websocket_client_connection());
+}
+
+static void check_no_data(void) {
+  websocket_client_stats_t before = stats_now();
+  uint32_t stops = host_ws_stops;
+  int64_t quiet_us = host_now_us;
+  // a pong now and then keeps it open
+  for (int i = 0; i < 4; i++) {
+    host_run_until(host_now_us + (NO_DATA_TIMEOUT_SEC - 10) * 1000000LL);
+    host_ws_receive("{\"type\":\"pong\"}");
+  }
+  CHECK(host_ws_stops == stops, "stopped a connection with data on it");
+  quiet_us = host_now_us;
+  host_run_until(quiet_us + NO_DATA_TIMEOUT_SEC * 1000000LL - TICK_US);
+  CHECK(host_ws_stops == stops, "stopped a connection %d s in", NO_DATA_TIMEOUT_SEC);
+  int64_t waited_us = next_attempt(quiet_us + NO_DATA_TIMEOUT_SEC * 1000000LL);
+  check_wait(waited_us, CONFIG_WEBSOCKET_RECONNECT_MIN_MS, "after no data");
+  websocket_client_stats_t after = stats_now();
+  CHECK(host_ws_stops > stops && after.outages - before.outages == 1, "%u stops, %u outages after no data",
+        host_ws_stops - stops, after.outages - before.outages);
+  host_ws_connect();
+  host_run_until(host_now_us + 1000000);
+  CHECK(stats_now().backoff_ms == 0, "still backing off after reconnecting");
+  printf("no data: stopped after %d s quiet, reconnected %lld ms later\n", NO_DATA_TIMEOUT_SEC,
+         (long long)waited_us / 1000);
+}
+
+int main(int argc, char **argv) {
+  host_seed(argc > 1 ? strtoul(argv[1], NULL, 0) : 1);
+  check_jitter();
+  check_backoff();
+  check_resync();
+  check_no_data();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
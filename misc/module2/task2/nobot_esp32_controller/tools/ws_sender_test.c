@@ -0,0 +1,260 @@
+/*
+ * ws_sender_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Runs wifi_ws_client.c's sender task against host.h's fake websocket and
+ * queues, on a simulated clock, and checks what reaches the socket and what
+ * the statistics count.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o ws_sender_test ws_sender_test.c host/host.c
+ *   ./ws_sender_test
+ *
+ * A stall is a send the fake socket holds for 100 ms, while the test keeps
+ * handing the client more.
+ *
+ * - greeting: the client_type message is the first frame on a connection.
+ * - latest wins: 50 states posted during a stall go out as the newest one
+ *   only, 49 counted as coalesced, behind the acks queued alongside them,
+ *   which go out in order.
+ * - outbox: 12 acks queued during a stall, into the depth-8 outbox, send 8
+ *   in order and drop 4.
+ * - drops and failures: anything sent on a connection that is down is
+ *   counted as dropped, and a send that errors or outlasts
+ *   CONFIG_WEBSOCKET_SEND_TIMEOUT_MS as failed.
+ * - histogram: send times either side of every bucket boundary land in the
+ *   right bucket.
+ * - trace: a requested dump goes to the console, and nothing onto the
+ *   socket, as this controller only speaks text frames.
+ *
+ * The space controller's sender is the same, bar binary frames and trace
+ * dumps over the socket; its tools/ws_sender_test.c covers those.
+ */
+
+#include <stdio.h>
+
+#include "host.h"
+#include "../main/mailbox.c"
+#include "../main/wifi_ws_client.c"
+
+// how long a stalled send holds the sender
+#define STALL_US (100000)
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TRACE                                   */
+/* -------------------------------------------------------------------------- */
+
+static int serial_dumps = 0;
+
+void trace_dump_serial(void) {
+  serial_dumps++;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   HELPERS                                  */
+/* -------------------------------------------------------------------------- */
+
+static void post_state(int n) {
+  char text[32];
+  int len = snprintf(text, sizeof(text), "state %d", n);
+  websocket_client_send_state(text, len);
+}
+
+static void ack(int n) {
+  char text[32];
+  int len = snprintf(text, sizeof(text), "ack %d", n);
+  websocket_client_send(text, len);
+}
+
+// whether frame `i` went out as `text`
+static bool sent(uint32_t i, const char *text) {
+  return i < host_ws_sent_count && host_ws_sent[i].len == (int)strlen(text) &&
+         memcmp(host_ws_sent[i].data, text, strlen(text)) == 0;
+}
+
+static const char *frame(uint32_t i) {
+  static char text[HOST_WS_FRAME_SIZE + 1];
+  if (i >= host_ws_sent_count) return "(none)";
+  snprintf(text, sizeof(text), "%.*s", host_ws_sent[i].len, host_ws_sent[i].data);
+  return text;
+}
+
+static websocket_client_stats_t stats_now(void) {
+  websocket_client_stats_t now;
+  websocket_client_get_stats(&now);
+  return now;
+}
+
+// lets the sender work through everything, sends taking no time
+static void settle(void) {
+  host_ws_send_us = 0;
+  host_run_until(host_now_us + 10 * STALL_US);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static void check_greeting(void) {
+  websocket_client_start();
+  host_run_tasks();
+  CHECK(host_ws_starts == 1 && host_ws_sent_count == 0, "%u starts, %u frames before connecting", host_ws_starts,
+        host_ws_sent_count);
+  host_ws_connect();
+  settle();
+  CHECK(host_ws_sent_count == 1 && strstr(frame(0), "\"client_type\"") && host_ws_sent[0].op_code == 0x1,
+        "first frame %s", frame(0));
+  CHECK(websocket_client_connection() == 1, "connection %u", websocket_client_connection());
+}
+
+static void check_latest_wins(void) {
+  websocket_client_stats_t before = stats_now();
+  uint32_t first = host_ws_sent_count;
+  host_ws_send_us = STALL_US;
+  post_state(0);
+  host_run_tasks();
+  // the sender is stuck on state 0: pile up states, and acks among them
+  for (int i = 1; i <= 50; i++) {
+    post_state(i);
+    if (i % 10 == 0 && i <= 30) ack(i / 10);
+  }
+  settle();
+  websocket_client_stats_t after = stats_now();
+  const char *expected[] = {"state 0", "ack 1", "ack 2", "ack 3", "state 50"};
+  for (uint32_t i = 0; i < 5; i++) {
+    CHECK(sent(first + i, expected[i]), "frame %u went out as %s, not %s", i, frame(first + i), expected[i]);
+  }
+  CHECK(host_ws_sent_count == first + 5, "%u frames for 51 states and 3 acks", host_ws_sent_count - first);
+  CHECK(after.coalesced - before.coalesced == 49, "%u coalesced", after.coalesced - before.coalesced);
+  CHECK(after.sent - before.sent == 5 && after.dropped == before.dropped, "%u sent, %u dropped",
+        after.sent - before.sent, after.dropped - before.dropped);
+  CHECK(after.depth == 0 && after.depth_max >= 3, "depth %u, max %u", after.depth, after.depth_max);
+  printf("latest wins: 50 states during a %d ms stall sent the newest, %u coalesced, 3 acks in order first\n",
+         STALL_US / 1000, after.coalesced - before.coalesced);
+}
+
+static void check_outbox(void) {
+  websocket_client_stats_t before = stats_now();
+  uint32_t first = host_ws_sent_count;
+  host_ws_send_us = STALL_US;
+  ack(0);
+  host_run_tasks();
+  // the sender is stuck on ack 0, with the outbox empty behind it
+  for (int i = 1; i <= 12; i++) ack(i);
+  CHECK(stats_now().depth == CONFIG_WEBSOCKET_OUTBOX_DEPTH, "depth %u with the outbox full", stats_now().depth);
+  settle();
+  websocket_client_stats_t after = stats_now();
+  for (uint32_t i = 0; i <= CONFIG_WEBSOCKET_OUTBOX_DEPTH; i++) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "ack %u", i);
+    CHECK(sent(first + i, expected), "frame %u went out as %s, not %s", i, frame(first + i), expected);
+  }
+  CHECK(host_ws_sent_count == first + 1 + CONFIG_WEBSOCKET_OUTBOX_DEPTH, "%u frames for 13 acks",
+        host_ws_sent_count - first);
+  CHECK(after.dropped - before.dropped == 12 - CONFIG_WEBSOCKET_OUTBOX_DEPTH, "%u dropped",
+        after.dropped - before.dropped);
+  CHECK(after.depth_max == CONFIG_WEBSOCKET_OUTBOX_DEPTH, "depth max %u", after.depth_max);
+  printf("outbox: 12 acks during a stall into a depth-%d outbox, %u sent in order, %u dropped\n",
+         CONFIG_WEBSOCKET_OUTBOX_DEPTH, host_ws_sent_count - first - 1, after.dropped - before.dropped);
+}
+
+static void check_drops_and_failures(void) {
+  // down, before the client has noticed: both dropped at the sender
+  websocket_client_stats_t before = stats_now();
+  uint32_t first = host_ws_sent_count;
+  host_ws_connected = false;
+  post_state(1);
+  ack(1);
+  settle();
+  websocket_client_stats_t after = stats_now();
+  CHECK(host_ws_sent_count == first, "%u frames with no connection", host_ws_sent_count - first);
+  CHECK(after.dropped - before.dropped == 2 && after.failed == before.failed, "%u dropped, %u failed disconnected",
+        after.dropped - before.dropped, after.failed - before.failed);
+  host_ws_connected = true;
+
+  // an error, then a send stuck past its timeout
+  before = after;
+  host_ws_fail = true;
+  ack(2);
+  settle();
+  host_ws_fail = false;
+  host_ws_send_us = 2 * CONFIG_WEBSOCKET_SEND_TIMEOUT_MS * 1000;
+  ack(3);
+  host_run_tasks();
+  settle();
+  after = stats_now();
+  CHECK(after.failed - before.failed == 2 && host_ws_sent_count == first, "%u failed, %u sent",
+        after.failed - before.failed, host_ws_sent_count - first);
+  CHECK(after.send_us[WEBSOCKET_SEND_HISTOGRAM_BUCKETS - 1] - before.send_us[WEBSOCKET_SEND_HISTOGRAM_BUCKETS - 1] == 1,
+        "the timed-out send was not counted as the slowest");
+
+  // and the sender still works after both
+  ack(4);
+  settle();
+  CHECK(sent(first, "ack 4"), "after the failures, %s went out", frame(first));
+  printf("drops: 2 while down; %u failed, an error and a %d ms send timeout\n", after.failed - before.failed,
+         CONFIG_WEBSOCKET_SEND_TIMEOUT_MS);
+}
+
+static uint32_t bucket_for(uint32_t us) {
+  uint32_t bucket = 0;
+  for (uint32_t limit = 256; bucket < WEBSOCKET_SEND_HISTOGRAM_BUCKETS - 1 && us >= limit; limit *= 2) bucket++;
+  return bucket;
+}
+
+static void check_histogram(void) {
+  const uint32_t times_us[] = {0, 255, 256, 511, 512, 1023, 1024, 2047, 2048, 4095, 4096, 8191, 8192, 16383, 16384,
+                               100000};
+  for (size_t i = 0; i < sizeof(times_us) / sizeof(times_us[0]); i++) {
+    websocket_client_stats_t before = stats_now();
+    host_ws_send_us = times_us[i];
+    ack(i);
+    host_run_until(host_now_us + STALL_US + times_us[i]);
+    websocket_client_stats_t after = stats_now();
+    uint32_t expected = bucket_for(times_us[i]);
+    for (uint32_t b = 0; b < WEBSOCKET_SEND_HISTOGRAM_BUCKETS; b++) {
+      CHECK(after.send_us[b] - before.send_us[b] == (b == expected), "a %u us send counted in bucket %u",
+            times_us[i], b);
+    }
+  }
+  settle();
+  printf("histogram: %zu send times either side of each boundary\n", sizeof(times_us) / sizeof(times_us[0]));
+}
+
+static void check_trace(void) {
+  uint32_t first = host_ws_sent_count;
+  host_ws_receive("{\"type\":\"trace\"}");
+  settle();
+  CHECK(serial_dumps == 1 && host_ws_sent_count == first, "%d serial dumps, %u frames", serial_dumps,
+        host_ws_sent_count - first);
+  printf("trace: a request dumps to the console\n");
+}
+
+int main(void) {
+  check_greeting();
+  check_latest_wins();
+  check_outbox();
+  check_drops_and_failures();
+  check_histogram();
+  check_trace();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
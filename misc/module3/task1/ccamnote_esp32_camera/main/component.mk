@@ -4,4 +4,4 @@
 # (Uses default behaviour of compiling all source files in directory, adding 'include' to include path.)
 COMPONENT_ADD_INCLUDEDIRS = include
 COMPONENT_SRCDIRS = src
-COMPONENT_PRIV_REQUIRES = log driver nvs_flash esp32-camera esp_websocket_client
\ No newline at end of file
+COMPONENT_PRIV_REQUIRES = log driver nvs_flash esp32-camera esp_http_client esp_timer esp_websocket_client
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+ * camera_commands.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __CAMERA_COMMANDS_H__
+#define __CAMERA_COMMANDS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_websocket_client.h"
+
+#include "config.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   FORMAT                                   */
+/* -------------------------------------------------------------------------- */
+
+// a command comes in as a websocket message, either
+//   text:   its name, exactly, e.g. "take_picture"
+//   binary: its opcode as the first byte, then any arguments
+// messages longer than CAMERA_COMMAND_MAX_SIZE are dropped whole.
+#define CAMERA_COMMAND_MAX_SIZE (32)
+
+typedef enum {
+  CAMERA_COMMAND_NONE = 0x00,
+  CAMERA_COMMAND_TAKE_PICTURE = 0x01,
+  CAMERA_COMMAND_FLASH_ON = 0x02,
+  CAMERA_COMMAND_FLASH_OFF = 0x03,
+  CAMERA_COMMAND_UPLOAD_HTTP = 0x04,
+  CAMERA_COMMAND_UPLOAD_WEBSOCKET = 0x05,
+  CAMERA_COMMAND_IMAGE_ACK = 0x06,  // binary only, see wifi_ws_client.h
+  CAMERA_COMMAND_COUNT
+} camera_command_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+// counters since boot
+typedef struct {
+  uint32_t dispatched;  // commands run
+  uint32_t unknown;     // whole messages that named no command
+  uint32_t oversized;   // messages dropped for being too long
+  uint32_t broken;      // messages dropped for a piece missing or out of order
+  uint32_t fragments;   // pieces after a message's first, put back together
+} camera_commands_stats_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t camera_commands_init(void);
+void camera_commands_receive(const esp_websocket_event_data_t *data);
+camera_command_t camera_commands_lookup(const char *text, size_t len);
+void camera_commands_get_stats(camera_commands_stats_t *stats);
+
+#endif /* __CAMERA_COMMANDS_H__ */
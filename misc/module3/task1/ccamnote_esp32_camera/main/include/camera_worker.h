@@ -0,0 +1,66 @@
+/*
+ * camera_worker.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __CAMERA_WORKER_H__
+#define __CAMERA_WORKER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#include "config.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+// the slow things the camera is asked to do, which the worker does in turn
+typedef enum {
+  CAMERA_JOB_TAKE_PICTURE,
+} camera_job_kind_t;
+
+// how pictures go to the server
+typedef enum {
+  CAMERA_TRANSPORT_HTTP,       // a POST to CONFIG_HTTP_SERVER_URI
+  CAMERA_TRANSPORT_WEBSOCKET,  // binary messages on the open websocket
+} camera_transport_t;
+
+typedef struct {
+  camera_job_kind_t kind;
+  int64_t queued_us;  // when it was asked for, on esp_timer's clock
+} camera_job_t;
+
+// counters since boot, and the timings of the last picture
+typedef struct {
+  uint32_t depth;        // jobs waiting right now
+  uint32_t depth_max;    // the most that have ever waited
+  uint32_t queued;       // jobs taken on
+  uint32_t coalesced;    // pictures asked for while one was already waiting
+  uint32_t dropped;      // jobs turned away with the queue full
+  uint32_t done;         // pictures the server has
+  uint32_t failed;       // pictures that went wrong, taking or uploading them
+  uint32_t overlapped;   // pictures taken while the one before was still uploading
+  uint32_t wait_ms;      // last picture, from being asked for to its capture starting
+  uint32_t capture_ms;   // last picture, taking it
+  uint32_t upload_ms;    // last picture, from its upload starting to the server's answer
+  uint32_t ack_ms;       // last picture, from being taken to the server's answer
+  uint32_t total_ms;     // last picture, from being asked for to the server's answer
+  uint32_t total_max_ms;
+  uint32_t upload_bytes; // last picture's size
+  uint32_t upload_kbps;  // last picture's upload throughput, in kbit/s
+  camera_transport_t transport;  // how the last picture went
+} camera_worker_stats_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+esp_err_t camera_worker_start(void);
+bool camera_worker_take_picture(void);
+void camera_worker_set_transport(camera_transport_t transport);
+void camera_worker_get_stats(camera_worker_stats_t *stats);
+
+#endif /* __CAMERA_WORKER_H__ */
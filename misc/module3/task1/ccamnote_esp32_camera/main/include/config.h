@@ -19,6 +19,20 @@
 #define CONFIG_WEBSOCKET_URI "ws://119c-130-132-173-230.ngrok.io"
 #define CONFIG_HTTP_SERVER_URI "http://119c-130-132-173-230.ngrok.io/image"
 
+// camera jobs waiting for the worker at once, see camera_worker.h
+#define CONFIG_CAMERA_JOB_QUEUE_DEPTH 4
+// frame buffers the camera captures into; one can be uploading while the
+// next picture is taken into another
+#define CONFIG_CAMERA_FB_COUNT 2
+// how pictures go to the server to begin with: 0 for HTTP, 1 for the
+// websocket; the server can switch it, see camera_commands.h
+#define CONFIG_CAMERA_UPLOAD_WEBSOCKET 0
+// websocket uploads, see wifi_ws_client.h: bytes per chunk, the most sent
+// ahead of the server's acknowledgements, and how long it may go quiet
+#define CONFIG_WS_UPLOAD_CHUNK_SIZE 4096
+#define CONFIG_WS_UPLOAD_WINDOW 16384
+#define CONFIG_WS_UPLOAD_ACK_TIMEOUT_MS 5000
+
 // Configuration for controller inputs
 #define CONFIG_PIN_JOYSTICK_VRX 3  // ANALOG 6, GPIO 34
 #define CONFIG_PIN_JOYSTICK_VRY 2  // ANALOG 7, GPIO 35
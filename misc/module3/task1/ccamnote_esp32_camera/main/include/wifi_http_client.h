@@ -8,6 +8,7 @@
 #ifndef __WIFI_HTTP_CLIENT_H__
 #define __WIFI_HTTP_CLIENT_H__
 
+#include <stdint.h>
 #include "esp_log.h"
 #include "esp_event.h"
 #include "esp_http_client.h"
@@ -15,7 +16,16 @@
 
 #include "config.h"
 
-// sends JPEG image data as a POST request to the HTTP server
+// how the upload connection has been used, since boot
+typedef struct {
+  uint32_t requests;     // images the server answered for
+  uint32_t connections;  // connections opened, or tried
+  uint32_t reused;       // images sent on a connection an earlier one opened
+  uint32_t repaired;     // images sent again after their reused connection turned out dead
+} http_upload_stats_t;
+
+// sends JPEG image data as a POST request to the HTTP server, on a kept-alive connection
 esp_err_t http_post_image(const char *post_url, camera_fb_t *fb);
+void http_get_upload_stats(http_upload_stats_t *stats);
 
 #endif /* __WIFI_HTTP_CLIENT_H__  */
\ No newline at end of file
@@ -8,6 +8,8 @@
 #ifndef __WIFI_WS_CLIENT_H__
 #define __WIFI_WS_CLIENT_H__
 
+#include <stddef.h>
+#include <stdint.h>
 #include "esp_event.h"
 
 #include "config.h"
@@ -15,9 +17,37 @@
 // set this to point to the websocket URI you will be sending controller inputs to.
 #define WEBSOCKET_URI CONFIG_WEBSOCKET_URI
 
+// an image sent over the websocket goes as binary messages of one chunk
+// each, behind a header. all fields are little-endian, and the header byte
+// follows the controllers' binary wire format, version 1 of kind 0x3:
+//
+//   offset  size  field
+//   0       1     0x13
+//   1       1     flags, none yet
+//   2       2     image id, +1 per image, wraps
+//   4       4     where this chunk goes in the image
+//   8       4     the image's size
+//   12      4     low 32 bits of the camera's microsecond clock when it was taken
+//   16      ...   the chunk
+//
+// the server answers with an image_ack command, binary only (see
+// camera_commands.h): its opcode, the image id (2 bytes), and how many of
+// its bytes it has from the start (4 bytes).
+
+// counters since boot, for images sent over the websocket
+typedef struct {
+  uint32_t images;    // images the server acknowledged whole
+  uint32_t chunks;    // chunks sent
+  uint32_t stalls;    // times the send window was full, and the sender waited on the server
+  uint32_t timeouts;  // images given up on, with the server not acknowledging
+} websocket_image_stats_t;
+
 esp_err_t websocket_client_start(void);
 void websocket_client_send(const char *data, int len);
 esp_err_t websocket_client_listen(esp_event_handler_t event_handler);
 void websocket_client_stop(void);
+esp_err_t websocket_client_send_image(const uint8_t *buf, size_t len, int64_t captured_us);
+void websocket_client_image_acked(uint16_t id, uint32_t received);
+void websocket_client_get_image_stats(websocket_image_stats_t *stats);
 
 #endif /* __WIFI_WS_CLIENT_H__  */
\ No newline at end of file
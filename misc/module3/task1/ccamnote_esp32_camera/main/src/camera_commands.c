@@ -0,0 +1,252 @@
+/*
+ * camera_commands.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+#include "camera_commands.h"
+#include "camera_worker.h"
+#include "controller_camera.h"
+#include "wifi_ws_client.h"
+
+static const char *TAG = "CCAMNotary Camera Commands";
+
+// websocket opcodes, RFC 6455
+#define WS_OPCODE_CONTINUATION (0x0)
+#define WS_OPCODE_TEXT (0x1)
+#define WS_OPCODE_BINARY (0x2)
+#define WS_OPCODE_CONTROL (0x8)
+
+/* -------------------------------------------------------------------------- */
+/*                                  COMMANDS                                  */
+/* -------------------------------------------------------------------------- */
+
+static void take_picture(const uint8_t *args, size_t len) {
+  ESP_LOGI(TAG, "Picture ordered by websocket. Queueing...");
+  camera_worker_take_picture();
+}
+
+static void flash_on(const uint8_t *args, size_t len) {
+  ESP_LOGI(TAG, "Turning flash on!");
+  controller_camera_set_flash(true);
+}
+
+static void flash_off(const uint8_t *args, size_t len) {
+  ESP_LOGI(TAG, "Turning flash off!");
+  controller_camera_set_flash(false);
+}
+
+static void upload_http(const uint8_t *args, size_t len) {
+  ESP_LOGI(TAG, "Uploading pictures over HTTP.");
+  camera_worker_set_transport(CAMERA_TRANSPORT_HTTP);
+}
+
+static void upload_websocket(const uint8_t *args, size_t len) {
+  ESP_LOGI(TAG, "Uploading pictures over the websocket.");
+  camera_worker_set_transport(CAMERA_TRANSPORT_WEBSOCKET);
+}
+
+// args: image id (2 bytes), bytes received (4 bytes)
+static void image_ack(const uint8_t *args, size_t len) {
+  if (len < 6) return;
+  uint16_t id = args[0] | args[1] << 8;
+  uint32_t received = args[2] | args[3] << 8 | args[4] << 16 | (uint32_t)args[5] << 24;
+  websocket_client_image_acked(id, received);
+}
+
+typedef struct {
+  const char *name;  // what it is called in a text message, NULL if binary only
+  void (*run)(const uint8_t *args, size_t len);
+  size_t args;       // bytes of arguments a binary message must carry
+} command_entry_t;
+
+// every command, by opcode. all run on the websocket's task, so anything
+// slow goes to the camera worker
+static const command_entry_t commands[CAMERA_COMMAND_COUNT] = {
+    [CAMERA_COMMAND_TAKE_PICTURE] = {"take_picture", take_picture},
+    [CAMERA_COMMAND_FLASH_ON] = {"flash_on", flash_on},
+    [CAMERA_COMMAND_FLASH_OFF] = {"flash_off", flash_off},
+    [CAMERA_COMMAND_UPLOAD_HTTP] = {"upload_http", upload_http},
+    [CAMERA_COMMAND_UPLOAD_WEBSOCKET] = {"upload_websocket", upload_websocket},
+    [CAMERA_COMMAND_IMAGE_ACK] = {NULL, image_ack, 6},
+};
+
+// text commands by the length of their name, which tells them all apart: a
+// perfect hash, so a lookup is one index and one compare.
+// camera_commands_init fills it in, and refuses names it cannot tell apart
+static camera_command_t by_length[CAMERA_COMMAND_MAX_SIZE + 1];
+
+/**
+ * @brief Builds the text command lookup.
+ *
+ * @return esp_err_t - ESP_ERR_INVALID_STATE if two names are the same
+ * length, or one is too long; the lookup needs a new key then.
+ */
+esp_err_t camera_commands_init(void) {
+  memset(by_length, 0, sizeof(by_length));
+  for (camera_command_t command = 1; command < CAMERA_COMMAND_COUNT; command++) {
+    if (commands[command].name == NULL) continue;
+    size_t len = strlen(commands[command].name);
+    if (len > CAMERA_COMMAND_MAX_SIZE || by_length[len] != CAMERA_COMMAND_NONE) {
+      ESP_LOGE(TAG, "Command \"%s\" cannot be told apart by its length", commands[command].name);
+      return ESP_ERR_INVALID_STATE;
+    }
+    by_length[len] = command;
+  }
+  return ESP_OK;
+}
+
+/**
+ * @brief Finds the command a text message names.
+ *
+ * @param text The message, not null-terminated.
+ * @param len Its length.
+ * @return camera_command_t - The command, or CAMERA_COMMAND_NONE.
+ */
+camera_command_t camera_commands_lookup(const char *text, size_t len) {
+  if (len > CAMERA_COMMAND_MAX_SIZE) return CAMERA_COMMAND_NONE;
+  camera_command_t command = by_length[len];
+  if (command == CAMERA_COMMAND_NONE || memcmp(commands[command].name, text, len) != 0) return CAMERA_COMMAND_NONE;
+  return command;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 REASSEMBLY                                 */
+/* -------------------------------------------------------------------------- */
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static camera_commands_stats_t stats = {0};
+
+// the message coming in. the websocket client hands over a frame longer
+// than its buffer in pieces, each with its offset into the frame, and a
+// message split across frames comes as continuation frames after the first.
+// only ever touched on the websocket's task
+static struct {
+  uint8_t data[CAMERA_COMMAND_MAX_SIZE];
+  uint8_t op_code;  // text or binary, from the message's first frame
+  int len;          // bytes so far
+  int frame_end;    // where the frame being received ends, in the message
+  int frame_start;  // where it started
+  bool held;        // whole frames, but no command yet: a continuation may finish it
+  bool skipping;    // the rest of this message is being dropped
+} message = {0};
+
+static void count(uint32_t *counter) {
+  portENTER_CRITICAL(&stats_lock);
+  (*counter)++;
+  portEXIT_CRITICAL(&stats_lock);
+}
+
+/**
+ * @brief Runs the command a whole message names, if any.
+ *
+ * @return bool - Whether there was one.
+ */
+static bool dispatch(void) {
+  camera_command_t command = CAMERA_COMMAND_NONE;
+  const uint8_t *args = NULL;
+  size_t len = 0;
+  if (message.op_code == WS_OPCODE_TEXT) {
+    command = camera_commands_lookup((const char *)message.data, message.len);
+  } else if (message.len > 0 && message.data[0] < CAMERA_COMMAND_COUNT) {
+    // any bytes after the opcode are the command's own. short of them, a
+    // continuation may still bring the rest
+    command = message.data[0];
+    args = message.data + 1;
+    len = message.len - 1;
+    if (len < commands[command].args) return false;
+  }
+  if (command == CAMERA_COMMAND_NONE) return false;
+  count(&stats.dispatched);
+  commands[command].run(args, len);
+  return true;
+}
+
+/**
+ * @brief Starts on a new message, giving up on one still held.
+ *
+ * @param data Its first frame.
+ */
+static void start_message(const esp_websocket_event_data_t *data) {
+  if (message.held) count(&stats.unknown);
+  message.op_code = data->op_code;
+  message.len = 0;
+  message.frame_start = 0;
+  message.held = false;
+  message.skipping = false;
+}
+
+/**
+ * @brief Takes a piece of a websocket message, and runs its command once
+ * the message is whole.
+ *
+ * Pieces are copied into a fixed buffer as they come, so the command never
+ * depends on the client's buffer size or on the server splitting messages.
+ * A message too long for any command, or with a piece missing or out of
+ * order, is dropped; the next message starts afresh. Control frames are not
+ * commands, and are left to the client.
+ *
+ * @param data The websocket data event.
+ */
+void camera_commands_receive(const esp_websocket_event_data_t *data) {
+  if (data->op_code >= WS_OPCODE_CONTROL) return;
+
+  if (data->payload_offset == 0) {
+    // a new frame: the start of a message, or the rest of a held one
+    if (data->op_code != WS_OPCODE_CONTINUATION) {
+      start_message(data);
+    } else if (message.held) {
+      count(&stats.fragments);
+      message.held = false;
+    } else {
+      if (!message.skipping) count(&stats.broken);
+      message.skipping = true;
+      return;
+    }
+    message.frame_start = message.len;
+    message.frame_end = message.len + data->payload_len;
+    if (data->payload_len < 0 || message.frame_end > CAMERA_COMMAND_MAX_SIZE) {
+      count(&stats.oversized);
+      message.skipping = true;
+    }
+  } else if (message.skipping) {
+    return;
+  } else if (message.held || message.frame_start + data->payload_offset != message.len ||
+             message.frame_start + data->payload_len != message.frame_end) {
+    count(&stats.broken);
+    message.held = false;
+    message.skipping = true;
+  } else {
+    count(&stats.fragments);
+  }
+  if (message.skipping) return;
+
+  if (data->data_len < 0 || message.len + data->data_len > message.frame_end) {
+    count(&stats.broken);
+    message.skipping = true;
+    return;
+  }
+  memcpy(message.data + message.len, data->data_ptr, data->data_len);
+  message.len += data->data_len;
+  if (message.len < message.frame_end) return;
+
+  // a whole frame. without a command yet, it may be the first part of a
+  // split message, so hold on to it until the next message says otherwise
+  if (!dispatch()) message.held = true;
+}
+
+/**
+ * @brief Copies out the command counters.
+ *
+ * @param out Where to copy them.
+ */
+void camera_commands_get_stats(camera_commands_stats_t *out) {
+  portENTER_CRITICAL(&stats_lock);
+  *out = stats;
+  portEXIT_CRITICAL(&stats_lock);
+}
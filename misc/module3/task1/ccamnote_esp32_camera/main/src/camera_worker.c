@@ -0,0 +1,291 @@
+/*
+ * camera_worker.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "camera_worker.h"
+#include "controller_camera.h"
+#include "wifi_http_client.h"
+#include "wifi_ws_client.h"
+
+static const char *TAG = "CCAMNotary Camera Worker";
+
+/* ---------------------------------- QUEUE --------------------------------- */
+
+static QueueHandle_t jobs;
+static TaskHandle_t worker;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static camera_worker_stats_t stats = {0};
+// whether a picture is waiting its turn, not yet being taken. set and
+// cleared under stats_lock
+static bool picture_waiting = false;
+
+/**
+ * @brief Hands a job to the worker, never waiting.
+ *
+ * @param job The job.
+ * @return bool - Whether it was queued; false if the queue was full.
+ */
+static bool queue_job(const camera_job_t *job) {
+  bool queued = xQueueSend(jobs, job, 0) == pdTRUE;
+  uint32_t depth = uxQueueMessagesWaiting(jobs);
+  portENTER_CRITICAL(&stats_lock);
+  if (queued) {
+    stats.queued++;
+  } else {
+    stats.dropped++;
+  }
+  if (depth > stats.depth_max) stats.depth_max = depth;
+  portEXIT_CRITICAL(&stats_lock);
+  return queued;
+}
+
+/**
+ * @brief Asks the worker for a picture, to be taken and uploaded.
+ *
+ * Returns straight away. If a picture is already waiting its turn, the
+ * request is folded into that one: the picture taken then is as new as
+ * either would have been. A picture being taken or uploaded right now does
+ * not count, so one asked for during an upload is taken as soon as a frame
+ * buffer is free, while the upload goes on.
+ *
+ * @return bool - Whether a picture is now on its way; false if the queue was full.
+ */
+bool camera_worker_take_picture(void) {
+  portENTER_CRITICAL(&stats_lock);
+  bool waiting = picture_waiting;
+  if (waiting) {
+    stats.coalesced++;
+  } else {
+    picture_waiting = true;
+  }
+  portEXIT_CRITICAL(&stats_lock);
+  if (waiting) return true;
+
+  camera_job_t job = {.kind = CAMERA_JOB_TAKE_PICTURE, .queued_us = esp_timer_get_time()};
+  if (queue_job(&job)) return true;
+  portENTER_CRITICAL(&stats_lock);
+  picture_waiting = false;
+  portEXIT_CRITICAL(&stats_lock);
+  ESP_LOGW(TAG, "Dropped a picture - job queue full.");
+  return false;
+}
+
+/* -------------------------------- UPLOADER -------------------------------- */
+
+// a picture taken, on its way to the server. its timings go with it, and
+// into the stats once it is uploaded, so they never mix with those of the
+// picture taken while it uploads
+typedef struct {
+  camera_fb_t *fb;
+  int64_t queued_us;    // when it was asked for
+  int64_t started_us;   // when its capture started
+  int64_t captured_us;  // when it was taken
+} upload_t;
+
+static QueueHandle_t uploads;
+static TaskHandle_t uploader;
+// frame buffers free for the next capture. one is held from capture until
+// its upload is done, so taking one first keeps a capture from timing out
+// waiting for the camera while every buffer is queued for upload
+static SemaphoreHandle_t free_frames;
+// whether an upload is going on right now, under stats_lock
+static bool uploading = false;
+// how the next picture goes, under stats_lock
+static camera_transport_t transport = CONFIG_CAMERA_UPLOAD_WEBSOCKET ? CAMERA_TRANSPORT_WEBSOCKET : CAMERA_TRANSPORT_HTTP;
+
+static const char *transport_names[] = {
+    [CAMERA_TRANSPORT_HTTP] = "HTTP",
+    [CAMERA_TRANSPORT_WEBSOCKET] = "websocket",
+};
+
+/**
+ * @brief Switches how pictures go to the server, from the next upload on.
+ *
+ * @param to The transport.
+ */
+void camera_worker_set_transport(camera_transport_t to) {
+  portENTER_CRITICAL(&stats_lock);
+  transport = to;
+  portEXIT_CRITICAL(&stats_lock);
+}
+
+/**
+ * @brief Sends a picture to the server, and waits for it to have it all.
+ *
+ * @param upload The picture.
+ * @param via How to send it.
+ * @return esp_err_t - ESP_OK once the server has acknowledged it.
+ */
+static esp_err_t send_picture(const upload_t *upload, camera_transport_t via) {
+  switch (via) {
+    case CAMERA_TRANSPORT_WEBSOCKET:
+      return websocket_client_send_image(upload->fb->buf, upload->fb->len, upload->captured_us);
+    case CAMERA_TRANSPORT_HTTP:
+    default:
+      return http_post_image(CONFIG_HTTP_SERVER_URI, upload->fb);
+  }
+}
+
+/**
+ * @brief Uploads the pictures the worker takes, one at a time.
+ *
+ * Runs apart from the worker, so the next picture can be taken while this
+ * one is still on its way. Each frame buffer goes back to the camera once
+ * the server has answered for it.
+ *
+ * @param pvParameter Placeholder values to pass into the task function (unused)
+ */
+static void camera_uploader_task(void *pvParameter) {
+  upload_t upload;
+  while (true) {
+    if (!xQueueReceive(uploads, &upload, portMAX_DELAY)) continue;
+    portENTER_CRITICAL(&stats_lock);
+    uploading = true;
+    camera_transport_t via = transport;
+    portEXIT_CRITICAL(&stats_lock);
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = send_picture(&upload, via);
+    int64_t acked_us = esp_timer_get_time();
+    uint32_t len = upload.fb->len;
+    controller_camera_return_fb(upload.fb);
+    xSemaphoreGive(free_frames);
+
+    camera_worker_stats_t now;
+    portENTER_CRITICAL(&stats_lock);
+    uploading = false;
+    if (err == ESP_OK) {
+      stats.done++;
+      stats.wait_ms = (upload.started_us - upload.queued_us) / 1000;
+      stats.capture_ms = (upload.captured_us - upload.started_us) / 1000;
+      stats.upload_ms = (acked_us - start_us) / 1000;
+      stats.ack_ms = (acked_us - upload.captured_us) / 1000;
+      stats.total_ms = (acked_us - upload.queued_us) / 1000;
+      if (stats.total_ms > stats.total_max_ms) stats.total_max_ms = stats.total_ms;
+      stats.upload_bytes = len;
+      stats.upload_kbps = acked_us > start_us ? (uint64_t)len * 8000 / (acked_us - start_us) : 0;
+      stats.transport = via;
+    } else {
+      stats.failed++;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    camera_worker_get_stats(&now);
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "Upload over %s failed: %s", transport_names[via], esp_err_to_name(err));
+    } else {
+      ESP_LOGI(TAG, "Picture of %u bytes acked over %s in %u ms from capture (waited %u, capture %u, upload %u "
+                    "at %u kbit/s), %u ms from request (max %u). %u done, %u failed, %u coalesced, %u overlapped, "
+                    "%u dropped, depth %u (max %u)",
+               now.upload_bytes, transport_names[via], now.ack_ms, now.wait_ms, now.capture_ms, now.upload_ms,
+               now.upload_kbps,
+               now.total_ms, now.total_max_ms, now.done, now.failed, now.coalesced, now.overlapped,
+               now.dropped, now.depth, now.depth_max);
+    }
+    // HTTP logs its connection counters as it sends; the websocket's go here
+    if (via == CAMERA_TRANSPORT_WEBSOCKET) {
+      websocket_image_stats_t ws;
+      websocket_client_get_image_stats(&ws);
+      ESP_LOGI(TAG, "Websocket uploads: %u images in %u chunks, %u stalls on a full window, %u timeouts.",
+               ws.images, ws.chunks, ws.stalls, ws.timeouts);
+    }
+  }
+}
+
+/* --------------------------------- WORKER --------------------------------- */
+
+/**
+ * @brief Takes a picture, and hands it on to be uploaded.
+ *
+ * @param job The job, for when it was asked for.
+ * @return esp_err_t - ESP_OK once the picture is on its way.
+ */
+static esp_err_t take_picture(const camera_job_t *job) {
+  xSemaphoreTake(free_frames, portMAX_DELAY);
+  upload_t upload = {.queued_us = job->queued_us, .started_us = esp_timer_get_time()};
+  // from here on, a new request wants a newer picture than this one
+  portENTER_CRITICAL(&stats_lock);
+  picture_waiting = false;
+  if (uploading) stats.overlapped++;
+  portEXIT_CRITICAL(&stats_lock);
+
+  esp_err_t err = controller_camera_take_photo(&upload.fb);
+  if (err != ESP_OK) {
+    xSemaphoreGive(free_frames);
+    return err;
+  }
+  upload.captured_us = esp_timer_get_time();
+  ESP_LOGI(TAG, "JPEG picture taken of size %d bytes.", upload.fb->len);
+
+  // never waits: there is room for every frame buffer
+  xQueueSend(uploads, &upload, portMAX_DELAY);
+  return ESP_OK;
+}
+
+/**
+ * @brief Does the camera's jobs one at a time, in the order they came.
+ *
+ * Captures and uploads take hundreds of milliseconds, so they happen here
+ * rather than in the websocket's event handler, which stays free for pings,
+ * flash commands and more requests meanwhile. Uploads go on in the uploader,
+ * so the worker is free to take the next picture as soon as a frame buffer
+ * is. A failed job is logged and counted, and the worker moves on to the next.
+ *
+ * @param pvParameter Placeholder values to pass into the task function (unused)
+ */
+static void camera_worker_task(void *pvParameter) {
+  camera_job_t job;
+  while (true) {
+    if (!xQueueReceive(jobs, &job, portMAX_DELAY)) continue;
+    esp_err_t err = ESP_OK;
+    switch (job.kind) {
+      case CAMERA_JOB_TAKE_PICTURE:
+        err = take_picture(&job);
+        break;
+    }
+    if (err != ESP_OK) {
+      portENTER_CRITICAL(&stats_lock);
+      stats.failed++;
+      portEXIT_CRITICAL(&stats_lock);
+      ESP_LOGW(TAG, "Picture failed: %s", esp_err_to_name(err));
+    }
+  }
+}
+
+/**
+ * @brief Starts the camera worker, and its uploader.
+ *
+ * @return esp_err_t - ESP_ERR_NO_MEM if the queues or tasks could not be made.
+ */
+esp_err_t camera_worker_start(void) {
+  jobs = xQueueCreate(CONFIG_CAMERA_JOB_QUEUE_DEPTH, sizeof(camera_job_t));
+  uploads = xQueueCreate(CONFIG_CAMERA_FB_COUNT, sizeof(upload_t));
+  free_frames = xSemaphoreCreateCounting(CONFIG_CAMERA_FB_COUNT, CONFIG_CAMERA_FB_COUNT);
+  if (jobs == NULL || uploads == NULL || free_frames == NULL) return ESP_ERR_NO_MEM;
+  // the HTTP client runs on the uploader's stack
+  if (xTaskCreate(camera_uploader_task, "camera_uploader_task", 8192, NULL, 4, &uploader) != pdPASS) return ESP_ERR_NO_MEM;
+  if (xTaskCreate(camera_worker_task, "camera_worker_task", 3072, NULL, 4, &worker) != pdPASS) return ESP_ERR_NO_MEM;
+  return ESP_OK;
+}
+
+/**
+ * @brief Copies out the worker's counters and timings.
+ *
+ * @param out Where to copy them.
+ */
+void camera_worker_get_stats(camera_worker_stats_t *out) {
+  uint32_t depth = jobs ? uxQueueMessagesWaiting(jobs) : 0;
+  portENTER_CRITICAL(&stats_lock);
+  *out = stats;
+  portEXIT_CRITICAL(&stats_lock);
+  out->depth = depth;
+}
@@ -39,7 +39,7 @@ esp_err_t controller_camera_init() {
       .pixel_format = PIXFORMAT_JPEG,
       .frame_size = FRAMESIZE_UXGA,
       .jpeg_quality = 10,
-      .fb_count = 2,
+      .fb_count = CONFIG_CAMERA_FB_COUNT,
       .grab_mode = CAMERA_GRAB_LATEST};
   ESP_ERROR_CHECK(esp_camera_init(&camera_config));
 
@@ -24,9 +24,10 @@
 #include "nvs_flash.h"
 #include "config.h"
 
+#include "camera_commands.h"
+#include "camera_worker.h"
 #include "controller_camera.h"
 #include "wifi_connect.h"
-#include "wifi_http_client.h"
 #include "wifi_ws_client.h"
 
 #define JOYSTICK_DEADZONE 0.05
@@ -59,37 +60,17 @@ static esp_err_t stall_forever(void) {
 /**
  * @brief Websocket callback handler for receiving server messages
  *
- * @param mac The MAC address of the message sender.
- * @param incomingData The message sent over ESP-NOW.
- * @param len The length of the message.
+ * Runs on the websocket's task, so it only ever hands work off: the command
+ * layer puts messages back together and runs the command each one names,
+ * with pictures going to the camera worker.
+ *
+ * @param handler_args
+ * @param base
+ * @param event_id
+ * @param event_data The websocket data event.
  */
 static void receive_websocket_data(void* handler_args, esp_event_base_t base, int32_t event_id, void* event_data) {
-  esp_websocket_event_data_t* data = (esp_websocket_event_data_t*)event_data;
-  if (data->op_code == 10) return;  // ignore simple pings
-  // figure out what we got from the websocket
-  char command[13];
-  snprintf(command, sizeof command, "%s", (char*)data->data_ptr);
-  // if we're sent the take_picture command, do so
-  if (!strncmp("take_picture", command, strlen("take_picture"))) {
-    ESP_LOGI(TAG, "Picture ordered by websocket. Proceeding...");
-    camera_fb_t* fb = NULL;
-    // take a picture with the camera into picBuf and bufLen
-    ESP_ERROR_CHECK(controller_camera_take_photo(&fb));
-    ESP_LOGI(TAG, "JPEG picture taken of size %d bytes.", fb->len);
-    // now upload it using the HTTP client
-    ESP_ERROR_CHECK(http_post_image(CONFIG_HTTP_SERVER_URI, fb));
-    ESP_LOGI(TAG, "Picture uploaded to server!");
-    // and finally clean up the frame buffer
-    ESP_ERROR_CHECK(controller_camera_return_fb(fb));
-    // when flash turns on, tell the camera to turn the flash on
-  } else if (!strncmp("flash_on", command, strlen("flash_on"))) {
-    ESP_LOGI(TAG, "Turning flash on!");
-    controller_camera_set_flash(true);
-    // likewise for flash off
-  } else if (!strncmp("flash_off", command, strlen("flash_off"))) {
-    ESP_LOGI(TAG, "Turning flash off!");
-    controller_camera_set_flash(false);
-  }
+  camera_commands_receive((esp_websocket_event_data_t*)event_data);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -114,11 +95,15 @@ void app_main() {
   // 3. initialize the on-board ESP32 wifi
   ESP_ERROR_CHECK(wifi_init_sta());
 
-  // 4. create websocket client task and listen for data. no WS sending is done here.
+  // 4. start the worker that takes and uploads pictures, off the websocket's task
+  ESP_ERROR_CHECK(camera_worker_start());
+  ESP_ERROR_CHECK(camera_commands_init());
+
+  // 5. create websocket client task and listen for data. no WS sending is done here.
   ESP_ERROR_CHECK(websocket_client_start());
   ESP_ERROR_CHECK(websocket_client_listen(receive_websocket_data));
 
-  // 5. infinite loop of delay, as we now are just waiting for WS data to tell
+  // 6. infinite loop of delay, as we now are just waiting for WS data to tell
   //    us to take a picture and upload it to the server.
   ESP_ERROR_CHECK(stall_forever());
 }
\ No newline at end of file
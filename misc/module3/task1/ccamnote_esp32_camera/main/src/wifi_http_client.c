@@ -5,13 +5,35 @@
  * 2022 the nobot space,
  */
 
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
 #include "wifi_http_client.h"
 
 #define MAX_HTTP_RECV_BUFFER 512
 #define MAX_HTTP_OUTPUT_BUFFER 2048
+// the most of an image handed to the client in one write
+#define HTTP_UPLOAD_CHUNK_SIZE 4096
 
 static const char *TAG = "CCAMNotary HTTP Client";
 
+/* ---------------------------- UPLOAD CONNECTION --------------------------- */
+
+// the one client every upload goes through, made on the first. its
+// connection stays open from one upload to the next, so only the first
+// picture, and any after the connection drops, pays for a TCP handshake.
+// only ever used from the uploading task
+static esp_http_client_handle_t upload_client = NULL;
+static const char *upload_url = NULL;
+// whether the connection is up, as far as the last request could tell
+static bool connection_open = false;
+// set when the server says it will close the connection after this response
+static bool server_closing = false;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static http_upload_stats_t stats = {0};
+
 /**
  * @brief Handles received HTTP events from the HTTP client.
  *
@@ -31,6 +53,7 @@ esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
       break;
     case HTTP_EVENT_ON_HEADER:
       ESP_LOGD(TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s", evt->header_key, evt->header_value);
+      if (!strcasecmp(evt->header_key, "Connection") && !strcasecmp(evt->header_value, "close")) server_closing = true;
       break;
     case HTTP_EVENT_ON_DATA:
       ESP_LOGD(TAG, "HTTP_EVENT_ON_DATA, len=%d", evt->data_len);
@@ -46,34 +69,129 @@ esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
 }
 
 /**
- * @brief Sends a JPEG image buffer in an HTTP request to the server
+ * @brief Makes the upload client, or remakes it for a different URL.
  *
  * @param post_url The full URL of the server to post to
- * @param buf The frame buffer represented as uint8_ts, from fb->buf
- * @param buflen The length of the frame buffer, from fb->len
+ * @return esp_err_t - ESP_ERR_NO_MEM if the client could not be made.
  */
-esp_err_t http_post_image(const char *post_url, camera_fb_t *fb) {
+static esp_err_t upload_client_for(const char *post_url) {
+  if (upload_client && !strcmp(upload_url, post_url)) return ESP_OK;
+  if (upload_client) esp_http_client_cleanup(upload_client);
   esp_http_client_config_t config = {
       .url = post_url,
       .event_handler = _http_event_handler,
       .method = HTTP_METHOD_POST,
+      // have TCP probe the connection while it sits idle between pictures
+      .keep_alive_enable = true,
+      .keep_alive_idle = 5,
+      .keep_alive_interval = 5,
+      .keep_alive_count = 3,
   };
+  upload_client = esp_http_client_init(&config);
+  upload_url = upload_client ? post_url : NULL;
+  connection_open = false;
+  if (!upload_client) return ESP_ERR_NO_MEM;
+  esp_http_client_set_header(upload_client, "Content-Type", "image/jpg");
+  return ESP_OK;
+}
+
+/**
+ * @brief Sends one POST of the image on the upload client's connection,
+ * opening one first if there is none.
+ *
+ * The picture is streamed straight out of the camera's frame buffer, a
+ * chunk at a time, rather than handed over whole to be copied and sent in
+ * one go. The response is read to its end, so the connection is ready for
+ * the next request.
+ *
+ * @param fb The frame buffer, whose buf and len are sent
+ * @param status_code Set to the server's answer
+ * @return esp_err_t - ESP_OK once the server has answered, whatever it said.
+ */
+static esp_err_t post_once(camera_fb_t *fb, int *status_code) {
+  server_closing = false;
+  esp_err_t err = esp_http_client_open(upload_client, fb->len);
+  if (err != ESP_OK) return err;
+
+  // stream the body, picking up wherever a partial write left off
+  size_t sent = 0;
+  while (sent < fb->len) {
+    size_t chunk = fb->len - sent < HTTP_UPLOAD_CHUNK_SIZE ? fb->len - sent : HTTP_UPLOAD_CHUNK_SIZE;
+    int wrote = esp_http_client_write(upload_client, (const char *)fb->buf + sent, chunk);
+    if (wrote <= 0) {
+      ESP_LOGW(TAG, "Failed to write image after %d of %d bytes.", sent, fb->len);
+      return ESP_FAIL;
+    }
+    sent += wrote;
+  }
+
+  // then wait for the server's answer, and drain it so the request ends cleanly
+  if (esp_http_client_fetch_headers(upload_client) < 0) return ESP_FAIL;
+  char response[MAX_HTTP_RECV_BUFFER];
+  while (esp_http_client_read(upload_client, response, sizeof(response)) > 0) {
+  }
+  if (!esp_http_client_is_complete_data_received(upload_client)) return ESP_FAIL;
+  *status_code = esp_http_client_get_status_code(upload_client);
+  return ESP_OK;
+}
 
-  // init the HTTP client, attaching the image data to the post field
-  esp_http_client_handle_t http_client = esp_http_client_init(&config);
-  esp_http_client_set_method(http_client, HTTP_METHOD_POST);
-  esp_http_client_set_post_field(http_client, (const char *)fb->buf, fb->len);
-  esp_http_client_set_header(http_client, "Content-Type", "image/jpg");
-
-  // send the HTTP client's request
-  esp_err_t err = esp_http_client_perform(http_client);
-  if (err == ESP_OK) {
-    int status_code = esp_http_client_get_status_code(http_client);
-    ESP_LOGI(TAG, "Sent buffer of len %d. Got status code %d.", fb->len, status_code);
+/**
+ * @brief Sends a JPEG image buffer in an HTTP request to the server
+ *
+ * Reuses the connection the last upload left open. The server may have
+ * closed it meanwhile, which only shows once this request fails on it; the
+ * image is then sent again on a fresh connection, as the frame buffer is
+ * still whole. It counts as sent once the server answers with a 2xx status.
+ *
+ * @param post_url The full URL of the server to post to
+ * @param fb The frame buffer, whose buf and len are sent
+ */
+esp_err_t http_post_image(const char *post_url, camera_fb_t *fb) {
+  esp_err_t err = upload_client_for(post_url);
+  if (err != ESP_OK) return err;
+
+  bool reused = connection_open;
+  int status_code = 0;
+  err = post_once(fb, &status_code);
+  if (err != ESP_OK && reused) {
+    ESP_LOGI(TAG, "Kept-alive connection was dead, reconnecting.");
+    esp_http_client_close(upload_client);
+    portENTER_CRITICAL(&stats_lock);
+    stats.repaired++;
+    portEXIT_CRITICAL(&stats_lock);
+    reused = false;
+    err = post_once(fb, &status_code);
   }
 
-  // clean up the HTTP client now
-  esp_http_client_cleanup(http_client);
+  // keep the connection for the next upload, unless it broke or the server is closing it
+  connection_open = err == ESP_OK && !server_closing;
+  if (!connection_open) esp_http_client_close(upload_client);
+
+  http_upload_stats_t now;
+  portENTER_CRITICAL(&stats_lock);
+  if (err == ESP_OK) stats.requests++;
+  if (err == ESP_OK && reused) stats.reused++;
+  if (!reused) stats.connections++;
+  now = stats;
+  portEXIT_CRITICAL(&stats_lock);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to send buffer of len %d: %s", fb->len, esp_err_to_name(err));
+    return err;
+  }
+  ESP_LOGI(TAG, "Sent buffer of len %d on a %s connection. Got status code %d. "
+                "%u requests on %u connections, %u reused, %u repaired.",
+           fb->len, reused ? "reused" : "new", status_code,
+           now.requests, now.connections, now.reused, now.repaired);
+  return status_code >= 200 && status_code < 300 ? ESP_OK : ESP_FAIL;
+}
 
-  return err;
-}
\ No newline at end of file
+/**
+ * @brief Copies out the upload connection counters.
+ *
+ * @param out Where to copy them.
+ */
+void http_get_upload_stats(http_upload_stats_t *out) {
+  portENTER_CRITICAL(&stats_lock);
+  *out = stats;
+  portEXIT_CRITICAL(&stats_lock);
+}
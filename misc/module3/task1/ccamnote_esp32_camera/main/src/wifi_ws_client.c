@@ -21,6 +21,10 @@
 
 #define NO_DATA_TIMEOUT_SEC 300
 
+// image chunks, as laid out in wifi_ws_client.h
+#define IMAGE_CHUNK_HEADER (0x13)
+#define IMAGE_CHUNK_HEADER_SIZE (16)
+
 /** \brief Tag for ESP logging */
 static const char *TAG = "CCAMNotary WebSocket Client";
 
@@ -71,12 +75,13 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base, i
       ESP_LOGI(TAG, "WEBSOCKET_EVENT_DISCONNECTED");
       break;
     case WEBSOCKET_EVENT_DATA:
-      // opcode 10 is just pings, ignore those
+      // opcode 10 is just pings, ignore those. data comes with every image
+      // chunk acknowledged, so it is only logged when debugging
       if (data->op_code != 10) {
-        ESP_LOGI(TAG, "WEBSOCKET_EVENT_DATA");
-        ESP_LOGI(TAG, "Received opcode=%d", data->op_code);
-        ESP_LOGI(TAG, "Received=%.*s", data->data_len, (char *)data->data_ptr);
-        ESP_LOGI(TAG, "Total payload length=%d, data-len=%d, current payload offset=%d\r\n", data->payload_len, data->data_len, data->payload_offset);
+        ESP_LOGD(TAG, "WEBSOCKET_EVENT_DATA");
+        ESP_LOGD(TAG, "Received opcode=%d", data->op_code);
+        ESP_LOGD(TAG, "Received=%.*s", data->data_len, (char *)data->data_ptr);
+        ESP_LOGD(TAG, "Total payload length=%d, data-len=%d, current payload offset=%d\r\n", data->payload_len, data->data_len, data->payload_offset);
       }
       xTimerReset(shutdown_signal_timer, portMAX_DELAY);
       break;
@@ -127,6 +132,142 @@ esp_err_t websocket_client_listen(esp_event_handler_t event_handler) {
   return esp_websocket_register_events(client, WEBSOCKET_EVENT_DATA, event_handler, (void *)client);
 }
 
+/* ------------------------------ IMAGE UPLOAD ------------------------------ */
+
+static portMUX_TYPE image_lock = portMUX_INITIALIZER_UNLOCKED;
+static websocket_image_stats_t image_stats = {0};
+
+// the image being sent, and how much of it the server has acknowledged.
+// the sender sets these up, and the websocket's task moves acked along
+static TaskHandle_t image_sender = NULL;
+static uint16_t image_id = 0;
+static uint32_t image_acked = 0;
+
+/**
+ * @brief Writes a value little-endian.
+ *
+ * @param buf Where to write it.
+ * @param value The value.
+ * @param size How many bytes of it.
+ */
+static void put_le(uint8_t *buf, uint32_t value, size_t size) {
+  for (size_t i = 0; i < size; i++) buf[i] = value >> (8 * i);
+}
+
+/**
+ * @brief Waits for the server to acknowledge an image up to some point.
+ *
+ * @param upto The bytes of the image that have to be acknowledged.
+ * @param stall Counted if this has to wait at all.
+ * @return bool - False if the server went quiet for CONFIG_WS_UPLOAD_ACK_TIMEOUT_MS.
+ */
+static bool wait_for_acks(uint32_t upto, uint32_t *stall) {
+  bool waited = false;
+  while (true) {
+    portENTER_CRITICAL(&image_lock);
+    bool acked = image_acked >= upto;
+    if (!acked && !waited && stall) (*stall)++;
+    portEXIT_CRITICAL(&image_lock);
+    if (acked) return true;
+    waited = true;
+    if (!ulTaskNotifyTake(pdTRUE, CONFIG_WS_UPLOAD_ACK_TIMEOUT_MS / portTICK_PERIOD_MS)) return false;
+  }
+}
+
+/**
+ * @brief Sends an image as binary messages on the open websocket.
+ *
+ * The image goes out in chunks of CONFIG_WS_UPLOAD_CHUNK_SIZE, each its own
+ * message with a header saying which image it is and where the chunk goes,
+ * so other messages can go between them. The server acknowledges what it
+ * has as chunks come in, and no more than CONFIG_WS_UPLOAD_WINDOW bytes go
+ * unacknowledged: a slow server holds up the sender, rather than piling
+ * chunks up in buffers along the way. Returns once the server has
+ * acknowledged the whole image, the same point an HTTP upload returns at.
+ *
+ * Only one image is sent at a time; call from one task only.
+ *
+ * @param buf The image.
+ * @param len Its length.
+ * @param captured_us When it was taken, on esp_timer's clock.
+ * @return esp_err_t - ESP_ERR_INVALID_STATE if the websocket is not
+ * connected, ESP_ERR_TIMEOUT if the server stopped acknowledging.
+ */
+esp_err_t websocket_client_send_image(const uint8_t *buf, size_t len, int64_t captured_us) {
+  static uint8_t message[IMAGE_CHUNK_HEADER_SIZE + CONFIG_WS_UPLOAD_CHUNK_SIZE];
+  static uint16_t next_id = 0;
+  if (!esp_websocket_client_is_connected(client)) return ESP_ERR_INVALID_STATE;
+
+  // acknowledgements of earlier images are ignored from here on
+  ulTaskNotifyTake(pdTRUE, 0);
+  portENTER_CRITICAL(&image_lock);
+  image_id = next_id++;
+  image_acked = 0;
+  image_sender = xTaskGetCurrentTaskHandle();
+  portEXIT_CRITICAL(&image_lock);
+
+  message[0] = IMAGE_CHUNK_HEADER;
+  message[1] = 0;
+  put_le(message + 2, image_id, 2);
+  put_le(message + 8, len, 4);
+  put_le(message + 12, (uint32_t)captured_us, 4);
+  esp_err_t err = ESP_OK;
+  uint32_t chunks = 0, stalls = 0;
+  size_t sent = 0;
+  while (sent < len) {
+    size_t chunk = len - sent < CONFIG_WS_UPLOAD_CHUNK_SIZE ? len - sent : CONFIG_WS_UPLOAD_CHUNK_SIZE;
+    if (sent + chunk > CONFIG_WS_UPLOAD_WINDOW && !wait_for_acks(sent + chunk - CONFIG_WS_UPLOAD_WINDOW, &stalls)) {
+      err = ESP_ERR_TIMEOUT;
+      break;
+    }
+    put_le(message + 4, sent, 4);
+    memcpy(message + IMAGE_CHUNK_HEADER_SIZE, buf + sent, chunk);
+    if (esp_websocket_client_send_bin(client, (const char *)message, IMAGE_CHUNK_HEADER_SIZE + chunk,
+                                      CONFIG_WS_UPLOAD_ACK_TIMEOUT_MS / portTICK_PERIOD_MS) < 0) {
+      err = ESP_FAIL;
+      break;
+    }
+    chunks++;
+    sent += chunk;
+  }
+  if (err == ESP_OK && !wait_for_acks(len, NULL)) err = ESP_ERR_TIMEOUT;
+
+  portENTER_CRITICAL(&image_lock);
+  image_sender = NULL;
+  if (err == ESP_OK) image_stats.images++;
+  if (err == ESP_ERR_TIMEOUT) image_stats.timeouts++;
+  image_stats.chunks += chunks;
+  image_stats.stalls += stalls;
+  portEXIT_CRITICAL(&image_lock);
+  return err;
+}
+
+/**
+ * @brief Takes the server's acknowledgement of part of an image.
+ *
+ * @param id The image.
+ * @param received How many of its bytes the server has, from the start.
+ */
+void websocket_client_image_acked(uint16_t id, uint32_t received) {
+  portENTER_CRITICAL(&image_lock);
+  TaskHandle_t sender = image_sender;
+  bool current = sender && id == image_id;
+  if (current && received > image_acked) image_acked = received;
+  portEXIT_CRITICAL(&image_lock);
+  if (current) xTaskNotifyGive(sender);
+}
+
+/**
+ * @brief Copies out the image upload counters.
+ *
+ * @param out Where to copy them.
+ */
+void websocket_client_get_image_stats(websocket_image_stats_t *out) {
+  portENTER_CRITICAL(&image_lock);
+  *out = image_stats;
+  portEXIT_CRITICAL(&image_lock);
+}
+
 /**
  * @brief Ends the websocket connection.
  */
@@ -0,0 +1,93 @@
+/*
+ * camera_commands_bench.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Times the text command lookup against the snprintf and strncmp chain it
+ * replaced, on its own and with a whole message going through
+ * camera_commands_receive.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o camera_commands_bench camera_commands_bench.c host/host.c
+ *   ./camera_commands_bench
+ *
+ * The old chain only knew the first three commands, so both sides are fed
+ * those. Builds camera_commands.c itself, against the stand-ins in host/.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "host.h"
+#include "../main/src/camera_commands.c"
+
+#define ROUNDS (10000000)
+
+static const char *names[] = {"take_picture", "flash_on", "flash_off"};
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  OLD CODE                                  */
+/* -------------------------------------------------------------------------- */
+
+// the websocket handler's parsing before camera_commands
+static int old_chain(const char *data, int len) {
+  char command[13];
+  snprintf(command, sizeof(command), "%.*s", len, data);
+  if (!strncmp("take_picture", command, strlen("take_picture"))) return CAMERA_COMMAND_TAKE_PICTURE;
+  if (!strncmp("flash_on", command, strlen("flash_on"))) return CAMERA_COMMAND_FLASH_ON;
+  if (!strncmp("flash_off", command, strlen("flash_off"))) return CAMERA_COMMAND_FLASH_OFF;
+  return CAMERA_COMMAND_NONE;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  BENCHMARK                                 */
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+  if (camera_commands_init() != ESP_OK) return 1;
+  size_t lens[3];
+  for (int i = 0; i < 3; i++) lens[i] = strlen(names[i]);
+
+  // both must agree before they are timed
+  for (int i = 0; i < 3; i++) {
+    if (old_chain(names[i], lens[i]) != (int)camera_commands_lookup(names[i], lens[i])) {
+      printf("\"%s\" looks up differently\nFAILED\n", names[i]);
+      return 1;
+    }
+  }
+
+  volatile int sink = 0;
+  double start = now_ns();
+  for (int i = 0; i < ROUNDS; i++) sink += old_chain(names[i % 3], lens[i % 3]);
+  double old_ns = (now_ns() - start) / ROUNDS;
+
+  start = now_ns();
+  for (int i = 0; i < ROUNDS; i++) sink += camera_commands_lookup(names[i % 3], lens[i % 3]);
+  double lookup_ns = (now_ns() - start) / ROUNDS;
+
+  // the whole path a websocket data event takes, copy and dispatch included
+  esp_websocket_event_data_t event = {.op_code = WS_OPCODE_TEXT};
+  start = now_ns();
+  for (int i = 0; i < ROUNDS; i++) {
+    event.data_ptr = names[i % 3];
+    event.data_len = event.payload_len = lens[i % 3];
+    camera_commands_receive(&event);
+  }
+  double receive_ns = (now_ns() - start) / ROUNDS;
+
+  uint32_t ran = 0;
+  for (camera_command_t c = 1; c < CAMERA_COMMAND_COUNT; c++) ran += host_ran[c];
+  printf("ns per message: old snprintf/strncmp chain %.1f, lookup %.1f, camera_commands_receive %.1f\n", old_ns,
+         lookup_ns, receive_ns);
+  if (ran != ROUNDS) {
+    printf("%u of %d messages ran a command\nFAILED\n", ran, ROUNDS);
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * camera_commands_fuzz.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Throws random websocket traffic at camera_commands_receive, the way the
+ * client's data events would hand it over, and checks every valid command
+ * in it still runs exactly once.
+ *
+ *   cc -std=gnu11 -g -O1 -Wall -fsanitize=address,undefined -Ihost -I../main/include \
+ *     -o camera_commands_fuzz camera_commands_fuzz.c host/host.c
+ *   ./camera_commands_fuzz [messages] [seed]
+ *
+ * The traffic mixes valid commands, as text or binary, whole or in random
+ * pieces, and split across continuation frames, with random garbage, stray
+ * pieces at bad offsets and lengths, and pings. Garbage is only there to
+ * leave the reassembly in odd states: what it runs is not checked, but the
+ * next valid command must run regardless, and the sanitizers must stay
+ * quiet. Builds camera_commands.c itself, against the stand-ins in host/.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "../main/src/camera_commands.c"
+
+// websocket opcodes, RFC 6455
+#define OP_PING (0x9)
+
+/* -------------------------------------------------------------------------- */
+/*                                   TRAFFIC                                  */
+/* -------------------------------------------------------------------------- */
+
+// the arguments of the last image_ack sent
+static uint16_t sent_ack_id;
+static uint32_t sent_ack_received;
+
+static void piece(uint8_t op, const uint8_t *data, int len, int payload_len, int payload_offset) {
+  esp_websocket_event_data_t event = {
+      .data_ptr = (const char *)data,
+      .data_len = len,
+      .op_code = op,
+      .payload_len = payload_len,
+      .payload_offset = payload_offset};
+  camera_commands_receive(&event);
+}
+
+/**
+ * @brief Sends one websocket frame, in random pieces as the client's buffer
+ * would cut it up.
+ */
+static void frame(uint8_t op, const uint8_t *data, int len) {
+  int offset = 0;
+  do {
+    int n = len > offset ? 1 + rand() % (len - offset) : 0;
+    piece(op, data + offset, n, len, offset);
+    offset += n;
+  } while (offset < len);
+}
+
+/**
+ * @brief Sends a message as two frames, the second a continuation, with a
+ * ping between them now and then as RFC 6455 allows.
+ */
+static void split_message(uint8_t op, const uint8_t *data, int len) {
+  int split = rand() % 2 ? rand() % (len + 1) : len;
+  frame(op, data, split);
+  if (split == len) return;
+  if (rand() % 4 == 0) frame(OP_PING, data, 1);
+  frame(WS_OPCODE_CONTINUATION, data + split, len - split);
+}
+
+/**
+ * @brief Sends a valid command one of the ways a server may, and returns
+ * the command it is.
+ */
+static camera_command_t send_command(void) {
+  camera_command_t command;
+  do {
+    command = 1 + rand() % (CAMERA_COMMAND_COUNT - 1);
+  } while (commands[command].name == NULL && rand() % 2);
+
+  if (commands[command].name == NULL || rand() % 3 == 0) {
+    // binary: the opcode and its arguments
+    uint8_t message[7] = {command};
+    int len = 1;
+    if (command == CAMERA_COMMAND_IMAGE_ACK) {
+      for (; len < 7; len++) message[len] = rand();
+      sent_ack_id = message[1] | message[2] << 8;
+      sent_ack_received = message[3] | message[4] << 8 | message[5] << 16 | (uint32_t)message[6] << 24;
+    }
+    split_message(WS_OPCODE_BINARY, message, len);
+    return command;
+  }
+
+  // text: its name
+  split_message(WS_OPCODE_TEXT, (const uint8_t *)commands[command].name, strlen(commands[command].name));
+  return command;
+}
+
+/**
+ * @brief Sends something that is not a valid command.
+ */
+static void send_noise(void) {
+  uint8_t junk[200];
+  int len = rand() % sizeof(junk);
+  for (int i = 0; i < len; i++) junk[i] = rand();
+  switch (rand() % 4) {
+    case 0:
+      // a whole message of garbage, of any kind
+      frame(rand() % 3, junk, len);
+      break;
+    case 1:
+      // a piece out of nowhere, lengths and offsets that may not add up
+      piece(rand() % 16, junk, len, rand() % 300 - 10, rand() % 300);
+      break;
+    case 2:
+      // the first piece of a frame whose rest never comes
+      if (len > 1) piece(rand() % 3, junk, 1 + rand() % (len - 1), len, 0);
+      break;
+    default:
+      frame(OP_PING, junk, len % 8);
+      break;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    CHECK                                   */
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char **argv) {
+  int messages = argc > 1 ? atoi(argv[1]) : 200000;
+  srand(argc > 2 ? atoi(argv[2]) : 1);
+  if (camera_commands_init() != ESP_OK) return 1;
+
+  int sent = 0, lost = 0, noise = 0;
+  for (int i = 0; i < messages; i++) {
+    if (rand() % 2) {
+      send_noise();
+      noise++;
+      continue;
+    }
+    uint32_t before[CAMERA_COMMAND_COUNT];
+    memcpy(before, host_ran, sizeof(before));
+    camera_command_t command = send_command();
+    sent++;
+
+    // exactly that command ran, exactly once, with its arguments intact
+    bool ok = true;
+    for (camera_command_t c = 1; c < CAMERA_COMMAND_COUNT; c++) {
+      ok &= host_ran[c] == before[c] + (c == command);
+    }
+    if (command == CAMERA_COMMAND_IMAGE_ACK) {
+      ok &= host_acked_id == sent_ack_id && host_acked_received == sent_ack_received;
+    }
+    if (!ok && lost++ < 10) {
+      fprintf(stderr, "message %d: command %d (%s) did not run exactly once\n", i, command,
+              commands[command].name ? commands[command].name : "binary");
+    }
+  }
+
+  camera_commands_stats_t stats;
+  camera_commands_get_stats(&stats);
+  printf("%d valid commands among %d noise messages: %d lost or doubled\n", sent, noise, lost);
+  printf("dispatched %u, unknown %u, oversized %u, broken %u, fragments %u\n", stats.dispatched, stats.unknown,
+         stats.oversized, stats.broken, stats.fragments);
+  if (lost) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * camera_worker_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Runs camera_worker.c's worker and uploader tasks on a simulated clock,
+ * against a camera and an uploader that take as long as the test says, and
+ * checks which requests get a picture of their own and which are folded
+ * into another.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o camera_worker_test camera_worker_test.c host/rtos.c
+ *   ./camera_worker_test
+ *
+ * - coalescing: requests that come in while a picture is waiting its turn
+ *   are folded into it; one that comes in once its capture has started is
+ *   queued behind it, and gets a capture of its own.
+ * - answered: under a steady stream of requests faster than pictures can
+ *   be taken, every request has a capture that starts no earlier than it
+ *   does, no more frame buffers are ever out than the camera has, and the
+ *   job queue never holds more than the one waiting picture.
+ * - failures: a capture or an upload that fails is counted, its frame
+ *   buffer goes back, and the next picture goes through.
+ * - timings: with one picture taken while the one before uploads, the
+ *   wait, capture, upload and total reported for each are its own.
+ *
+ * The worker's job queue holds one kind of job, and coalescing keeps at
+ * most one of it waiting, so the queue never fills and nothing is dropped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rtos.h"
+#include "../main/src/camera_worker.c"
+
+#define MS (1000)
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                   CAMERA                                   */
+/* -------------------------------------------------------------------------- */
+
+// how long a capture and an upload take, and whether the next one fails
+static int64_t capture_us = 100 * MS;
+static int64_t upload_us = 300 * MS;
+static bool capture_fails = false;
+static bool upload_fails = false;
+
+static camera_fb_t frames[CONFIG_CAMERA_FB_COUNT];
+static bool frame_out[CONFIG_CAMERA_FB_COUNT];
+static uint8_t jpeg[CONFIG_CAMERA_FB_COUNT][1024];
+
+// when each capture and upload started, in order, and how many there were
+#define LOG_SIZE (1024)
+static int64_t captures_us[LOG_SIZE];
+static int capture_count = 0;
+static int64_t uploads_us[LOG_SIZE];
+static int upload_count = 0;
+static int frames_most_out = 0;
+
+static int frames_out(void) {
+  int out = 0;
+  for (int i = 0; i < CONFIG_CAMERA_FB_COUNT; i++) out += frame_out[i];
+  return out;
+}
+
+esp_err_t controller_camera_take_photo(camera_fb_t **fb) {
+  int slot = 0;
+  while (slot < CONFIG_CAMERA_FB_COUNT && frame_out[slot]) slot++;
+  // the driver would block here, with every buffer out
+  CHECK(slot < CONFIG_CAMERA_FB_COUNT, "a capture started with every frame buffer out");
+  if (slot == CONFIG_CAMERA_FB_COUNT) return ESP_FAIL;
+  captures_us[capture_count++ % LOG_SIZE] = host_now_us;
+  frame_out[slot] = true;
+  if (frames_out() > frames_most_out) frames_most_out = frames_out();
+  host_busy(capture_us);
+  if (capture_fails) {
+    capture_fails = false;
+    frame_out[slot] = false;
+    return ESP_FAIL;
+  }
+  frames[slot] = (camera_fb_t){.buf = jpeg[slot], .len = sizeof(jpeg[slot])};
+  *fb = &frames[slot];
+  return ESP_OK;
+}
+
+esp_err_t controller_camera_return_fb(camera_fb_t *fb) {
+  int i = fb - frames;
+  CHECK(i >= 0 && i < CONFIG_CAMERA_FB_COUNT && frame_out[i], "returned a frame buffer that was not out");
+  frame_out[i] = false;
+  return ESP_OK;
+}
+
+static esp_err_t upload(void) {
+  uploads_us[upload_count++ % LOG_SIZE] = host_now_us;
+  host_busy(upload_us);
+  if (!upload_fails) return ESP_OK;
+  upload_fails = false;
+  return ESP_FAIL;
+}
+
+esp_err_t http_post_image(const char *post_url, camera_fb_t *fb) {
+  return upload();
+}
+
+esp_err_t websocket_client_send_image(const uint8_t *buf, size_t len, int64_t captured_us) {
+  return upload();
+}
+
+void websocket_client_get_image_stats(websocket_image_stats_t *out) {
+  *out = (websocket_image_stats_t){0};
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   HELPERS                                  */
+/* -------------------------------------------------------------------------- */
+
+static camera_worker_stats_t stats_now(void) {
+  camera_worker_stats_t now;
+  camera_worker_get_stats(&now);
+  return now;
+}
+
+// lets every picture asked for so far be taken and uploaded
+static void settle(void) {
+  host_run_until(host_now_us + 10000 * MS);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static void check_coalescing(void) {
+  // five requests in one go, as from the websocket's handler: one picture
+  for (int i = 0; i < 5; i++) CHECK(camera_worker_take_picture(), "request %d was turned away", i);
+  camera_worker_stats_t now = stats_now();
+  CHECK(now.queued == 1 && now.coalesced == 4 && now.depth == 1, "5 requests: %u queued, %u coalesced, depth %u",
+        now.queued, now.coalesced, now.depth);
+
+  // the worker starts on it; three more during its capture are a newer picture
+  host_run_tasks();
+  CHECK(capture_count == 1 && stats_now().depth == 0, "%d captures started, depth %u", capture_count,
+        stats_now().depth);
+  int64_t asked_us = host_now_us;
+  for (int i = 0; i < 3; i++) camera_worker_take_picture();
+  now = stats_now();
+  CHECK(now.queued == 2 && now.coalesced == 6 && now.depth == 1, "3 more: %u queued, %u coalesced, depth %u",
+        now.queued, now.coalesced, now.depth);
+
+  settle();
+  now = stats_now();
+  CHECK(capture_count == 2 && upload_count == 2 && now.done == 2 && now.failed == 0,
+        "%d captures, %d uploads, %u done", capture_count, upload_count, now.done);
+  CHECK(captures_us[1] >= asked_us, "the second capture started before it was asked for");
+  CHECK(now.depth_max == 1 && now.dropped == 0, "depth max %u, %u dropped", now.depth_max, now.dropped);
+  printf("coalescing: 8 requests, 2 pictures, %u coalesced\n", now.coalesced);
+}
+
+static void check_answered(void) {
+  // a request every 70 ms for 10 s, against 100 ms captures and 300 ms uploads
+  camera_worker_stats_t before = stats_now();
+  int first = capture_count;
+  int64_t asked_us[200];
+  int asked = 0;
+  for (int64_t at_us = host_now_us; asked < 143; at_us += 70 * MS) {
+    host_run_until(at_us);
+    asked_us[asked++] = host_now_us;
+    camera_worker_take_picture();
+    CHECK(stats_now().depth <= 1, "%u jobs waiting", stats_now().depth);
+  }
+  settle();
+  camera_worker_stats_t now = stats_now();
+
+  int unanswered = 0;
+  for (int i = 0, capture = first; i < asked; i++) {
+    while (capture < capture_count && captures_us[capture % LOG_SIZE] < asked_us[i]) capture++;
+    unanswered += capture == capture_count;
+  }
+  CHECK(unanswered == 0, "%d of %d requests never got a capture that started after them", unanswered, asked);
+  CHECK(frames_most_out <= CONFIG_CAMERA_FB_COUNT && frames_out() == 0, "%d frame buffers out at most, %d left out",
+        frames_most_out, frames_out());
+  uint32_t pictures = now.done - before.done;
+  CHECK(pictures == (uint32_t)(capture_count - first) &&
+            pictures + (now.coalesced - before.coalesced) == (uint32_t)asked,
+        "%d requests: %u pictures, %u coalesced", asked, pictures, now.coalesced - before.coalesced);
+  CHECK(now.depth_max == 1 && now.dropped == 0, "depth max %u, %u dropped", now.depth_max, now.dropped);
+  printf("answered: %d requests 70 ms apart, %u pictures over %s, %u coalesced, %d frame buffers out at most\n",
+         asked, pictures, transport_names[now.transport], now.coalesced - before.coalesced, frames_most_out);
+}
+
+static void check_failures(void) {
+  camera_worker_stats_t before = stats_now();
+  capture_fails = true;
+  camera_worker_take_picture();
+  settle();
+  camera_worker_stats_t now = stats_now();
+  CHECK(now.failed - before.failed == 1 && now.done == before.done, "a failed capture: %u failed, %u done",
+        now.failed - before.failed, now.done - before.done);
+  CHECK(frames_out() == 0, "%d frame buffers out after a failed capture", frames_out());
+
+  upload_fails = true;
+  camera_worker_take_picture();
+  settle();
+  now = stats_now();
+  CHECK(now.failed - before.failed == 2 && now.done == before.done, "a failed upload: %u failed, %u done",
+        now.failed - before.failed, now.done - before.done);
+  CHECK(frames_out() == 0, "%d frame buffers out after a failed upload", frames_out());
+
+  // and the worker carries on
+  for (int i = 0; i < CONFIG_CAMERA_FB_COUNT + 1; i++) {
+    camera_worker_take_picture();
+    settle();
+  }
+  now = stats_now();
+  CHECK(now.done - before.done == CONFIG_CAMERA_FB_COUNT + 1 && now.failed - before.failed == 2,
+        "after the failures: %u done, %u failed", now.done - before.done, now.failed - before.failed);
+  printf("failures: a capture and an upload failed, %u pictures after\n", now.done - before.done);
+}
+
+/**
+ * @brief Checks the timings reported are of one picture: asked for at
+ * `asked_us`, captured from `started_us` to `captured_us`, and uploaded
+ * from `uploading_us` until now.
+ */
+static void check_timings_of(const char *which, int64_t asked_us, int64_t started_us, int64_t captured_us,
+                             int64_t uploading_us) {
+  camera_worker_stats_t now = stats_now();
+  CHECK(now.wait_ms == (started_us - asked_us) / MS && now.capture_ms == (captured_us - started_us) / MS &&
+            now.upload_ms == (host_now_us - uploading_us) / MS && now.ack_ms == (host_now_us - captured_us) / MS &&
+            now.total_ms == (host_now_us - asked_us) / MS,
+        "%s picture: wait %u, capture %u, upload %u, ack %u, total %u ms", which, now.wait_ms, now.capture_ms,
+        now.upload_ms, now.ack_ms, now.total_ms);
+}
+
+static void check_timings(void) {
+  // A is asked for and captured in 100 ms, then uploads for 300 ms. B is
+  // asked for 150 ms in, and captured in 40 ms while A uploads
+  camera_worker_stats_t before = stats_now();
+  int64_t a_us = host_now_us;
+  camera_worker_take_picture();
+  host_run_tasks();
+  capture_us = 40 * MS;
+  host_run_until(a_us + 150 * MS);
+  camera_worker_take_picture();
+  host_run_until(a_us + 400 * MS);
+  CHECK(stats_now().done - before.done == 1, "%u done when A is acked", stats_now().done - before.done);
+  check_timings_of("A", a_us, a_us, a_us + 100 * MS, a_us + 100 * MS);
+  host_run_until(a_us + 700 * MS);
+  CHECK(stats_now().done - before.done == 2, "%u done when B is acked", stats_now().done - before.done);
+  check_timings_of("B", a_us + 150 * MS, a_us + 150 * MS, a_us + 190 * MS, a_us + 400 * MS);
+  CHECK(stats_now().overlapped - before.overlapped == 1, "%u overlapped", stats_now().overlapped - before.overlapped);
+  capture_us = 100 * MS;
+  printf("timings: B captured while A uploaded, each reported with its own wait and capture\n");
+}
+
+int main(void) {
+  CHECK(camera_worker_start() == ESP_OK, "the worker did not start");
+  check_coalescing();
+  check_answered();
+  check_failures();
+  check_timings();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
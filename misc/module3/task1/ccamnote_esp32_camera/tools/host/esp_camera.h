@@ -0,0 +1,18 @@
+/*
+ * esp_camera.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __HOST_ESP_CAMERA_H__
+#define __HOST_ESP_CAMERA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  uint8_t *buf;
+  size_t len;
+} camera_fb_t;
+
+#endif /* __HOST_ESP_CAMERA_H__ */
@@ -0,0 +1,19 @@
+/*
+ * esp_err.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __HOST_ESP_ERR_H__
+#define __HOST_ESP_ERR_H__
+
+typedef int esp_err_t;
+
+#define ESP_OK (0)
+#define ESP_FAIL (-1)
+#define ESP_ERR_NO_MEM (0x101)
+#define ESP_ERR_INVALID_STATE (0x103)
+
+const char *esp_err_to_name(esp_err_t err);
+
+#endif /* __HOST_ESP_ERR_H__ */
@@ -0,0 +1,15 @@
+/*
+ * esp_event.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __HOST_ESP_EVENT_H__
+#define __HOST_ESP_EVENT_H__
+
+#include <stdint.h>
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t base, int32_t id, void *data);
+
+#endif /* __HOST_ESP_EVENT_H__ */
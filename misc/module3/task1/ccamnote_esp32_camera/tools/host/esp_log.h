@@ -0,0 +1,22 @@
+/*
+ * esp_log.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __HOST_ESP_LOG_H__
+#define __HOST_ESP_LOG_H__
+
+#include <stdio.h>
+
+// commands and uploads log as they go, which would drown the output of a
+// long run; the arguments are still taken, so nothing logged goes unused
+static inline void host_log_quietly(const char *tag, ...) {}
+
+#define ESP_LOGD(tag, format, ...) host_log_quietly(tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) host_log_quietly(tag, ##__VA_ARGS__)
+// the tests bring on the failures these warn of
+#define ESP_LOGW(tag, format, ...) host_log_quietly(tag, ##__VA_ARGS__)
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "%s: " format "\n", tag, ##__VA_ARGS__)
+
+#endif /* __HOST_ESP_LOG_H__ */
@@ -0,0 +1,23 @@
+/*
+ * esp_websocket_client.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __HOST_ESP_WEBSOCKET_CLIENT_H__
+#define __HOST_ESP_WEBSOCKET_CLIENT_H__
+
+#include <stdint.h>
+
+// the fields of a WEBSOCKET_EVENT_DATA event, as ESP-IDF 4.4 lays them out
+typedef struct {
+  const char *data_ptr;
+  int data_len;
+  uint8_t op_code;
+  void *client;
+  void *user_context;
+  int payload_len;
+  int payload_offset;
+} esp_websocket_event_data_t;
+
+#endif /* __HOST_ESP_WEBSOCKET_CLIENT_H__ */
@@ -0,0 +1,12 @@
+/*
+ * esp_wifi.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __HOST_ESP_WIFI_H__
+#define __HOST_ESP_WIFI_H__
+
+// config.h names WIFI_AUTH_* in macros only, so nothing is needed here
+
+#endif /* __HOST_ESP_WIFI_H__ */
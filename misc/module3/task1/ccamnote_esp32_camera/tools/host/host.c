@@ -0,0 +1,154 @@
+/*
+ * host.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "camera_worker.h"
+#include "controller_camera.h"
+#include "esp_http_client.h"
+#include "wifi_ws_client.h"
+
+#include "host.h"
+
+uint32_t host_ran[CAMERA_COMMAND_COUNT];
+uint16_t host_acked_id;
+uint32_t host_acked_received;
+
+const char *esp_err_to_name(esp_err_t err) {
+  return err == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+/* -------------------------------- COMMANDS -------------------------------- */
+
+bool camera_worker_take_picture(void) {
+  host_ran[CAMERA_COMMAND_TAKE_PICTURE]++;
+  return true;
+}
+
+void camera_worker_set_transport(camera_transport_t transport) {
+  host_ran[transport == CAMERA_TRANSPORT_HTTP ? CAMERA_COMMAND_UPLOAD_HTTP : CAMERA_COMMAND_UPLOAD_WEBSOCKET]++;
+}
+
+esp_err_t controller_camera_set_flash(bool on) {
+  host_ran[on ? CAMERA_COMMAND_FLASH_ON : CAMERA_COMMAND_FLASH_OFF]++;
+  return ESP_OK;
+}
+
+void websocket_client_image_acked(uint16_t id, uint32_t received) {
+  host_ran[CAMERA_COMMAND_IMAGE_ACK]++;
+  host_acked_id = id;
+  host_acked_received = received;
+}
+
+/* ---------------------------------- HTTP ---------------------------------- */
+
+uint32_t host_http_connects = 0;
+uint32_t host_http_inits = 0;
+uint32_t host_http_cleanups = 0;
+bool host_http_refuse = false;
+bool host_http_closing = false;
+int host_http_status = 200;
+bool host_http_dead_at_headers = false;
+uint8_t host_http_body[HOST_HTTP_BODY_SIZE];
+size_t host_http_body_len = 0;
+
+struct host_http_client {
+  esp_http_client_config_t config;
+  bool connected;   // as the client sees it
+  bool dropped;     // by the server, which the client has yet to find out
+  int expected;     // the body length the request was opened with
+  size_t received;  // of its body, so far
+  bool answered;    // whether the response has been read
+};
+
+// the one client there is, for host_http_drop to reach
+static struct host_http_client *http_client = NULL;
+static uint32_t write_seed = 1;
+
+void host_http_drop(void) {
+  if (http_client && http_client->connected) http_client->dropped = true;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config) {
+  struct host_http_client *client = calloc(1, sizeof(struct host_http_client));
+  if (client == NULL) return NULL;
+  client->config = *config;
+  http_client = client;
+  host_http_inits++;
+  return client;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value) {
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len) {
+  if (!client->connected) {
+    if (host_http_refuse) return ESP_FAIL;
+    client->connected = true;
+    client->dropped = false;
+    host_http_connects++;
+  }
+  client->expected = write_len;
+  client->received = 0;
+  client->answered = false;
+  return ESP_OK;
+}
+
+// takes some of what it is given, as a socket with little room would
+int esp_http_client_write(esp_http_client_handle_t client, const char *buffer, int len) {
+  if (!client->connected || (client->dropped && !host_http_dead_at_headers)) return -1;
+  write_seed ^= write_seed << 13;
+  write_seed ^= write_seed >> 17;
+  write_seed ^= write_seed << 5;
+  int taken = 1 + write_seed % len;
+  if (!client->dropped && client->received + taken <= HOST_HTTP_BODY_SIZE) {
+    memcpy(host_http_body + client->received, buffer, taken);
+  }
+  client->received += taken;
+  return taken;
+}
+
+int esp_http_client_fetch_headers(esp_http_client_handle_t client) {
+  if (!client->connected || client->dropped || client->received != (size_t)client->expected) return ESP_FAIL;
+  host_http_body_len = client->received;
+  if (host_http_closing && client->config.event_handler) {
+    esp_http_client_event_t event = {
+        .event_id = HTTP_EVENT_ON_HEADER, .client = client, .header_key = "Connection", .header_value = "close"};
+    client->config.event_handler(&event);
+  }
+  return 2;
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len) {
+  if (client->answered || len < 2) return 0;
+  memcpy(buffer, "ok", 2);
+  client->answered = true;
+  return 2;
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client) {
+  return client->answered;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client) {
+  return host_http_status;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client) {
+  client->connected = false;
+  client->dropped = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+  if (http_client == client) http_client = NULL;
+  free(client);
+  host_http_cleanups++;
+  return ESP_OK;
+}
@@ -0,0 +1,51 @@
+/*
+ * host.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Just enough of ESP-IDF and FreeRTOS to run camera_commands.c and
+ * wifi_http_client.c on a desktop. What the commands would do to the
+ * camera is only counted. The HTTP client is a fake with one connection to
+ * a server the test controls: it can drop the connection while it sits
+ * idle, which the client only finds out on its next request, turn new
+ * connections away, or answer with Connection: close.
+ */
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "camera_commands.h"
+
+// how many times each command has run
+extern uint32_t host_ran[CAMERA_COMMAND_COUNT];
+// what the last image_ack said
+extern uint16_t host_acked_id;
+extern uint32_t host_acked_received;
+
+// the most of a request body the fake server keeps
+#define HOST_HTTP_BODY_SIZE (256 * 1024)
+
+// connections opened, and clients made and cleaned up
+extern uint32_t host_http_connects;
+extern uint32_t host_http_inits;
+extern uint32_t host_http_cleanups;
+// whether new connections are refused, whether the server closes each
+// connection after answering, and the status it answers with
+extern bool host_http_refuse;
+extern bool host_http_closing;
+extern int host_http_status;
+// where a request on a dropped connection fails: its first write, or, as
+// when the socket still takes the bytes, waiting for the answer
+extern bool host_http_dead_at_headers;
+// the body of the last request the server answered, and its length
+extern uint8_t host_http_body[HOST_HTTP_BODY_SIZE];
+extern size_t host_http_body_len;
+
+// the server closes the open connection, unknown to the client
+void host_http_drop(void);
+
+#endif /* __HOST_H__ */
@@ -0,0 +1,197 @@
+/*
+ * rtos.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "rtos.h"
+
+int64_t host_now_us = 0;
+
+const char *esp_err_to_name(esp_err_t err) {
+  return err == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+int64_t esp_timer_get_time(void) {
+  return host_now_us;
+}
+
+/* ---------------------------------- TASKS --------------------------------- */
+
+// far more than any task gets on the camera, as host code is bigger
+#define TASK_STACK_SIZE (256 * 1024)
+
+struct host_queue {
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t head;
+  UBaseType_t count;
+  uint8_t items[];
+};
+
+struct host_task {
+  TaskFunction_t code;
+  void *arg;
+  UBaseType_t priority;
+  ucontext_t context;
+  void *stack;
+  bool started;
+  bool done;
+  int64_t wake_us;            // when its wait ends, INT64_MAX for never
+  struct host_queue *queue;   // what it waits on, if anything
+  bool for_space;             // whether it waits to send, rather than to receive
+  struct host_task *next;
+};
+
+static struct host_task test_task = {.wake_us = INT64_MAX};
+static struct host_task *tasks = NULL;
+static struct host_task *current = &test_task;
+// where a task that blocks goes back to
+static ucontext_t scheduler;
+
+static int64_t ticks_us(TickType_t ticks) {
+  return ticks == portMAX_DELAY ? INT64_MAX : host_now_us + (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+/**
+ * @brief Switches from the running task back to the test, until `wake_us`
+ * or, with a queue, until it has an item or, `for_space`, room for one.
+ */
+static void block(int64_t wake_us, struct host_queue *queue, bool for_space) {
+  if (current == &test_task) {
+    fprintf(stderr, "host: the test's own task cannot block\n");
+    abort();
+  }
+  current->wake_us = wake_us;
+  current->queue = queue;
+  current->for_space = for_space;
+  swapcontext(&current->context, &scheduler);
+}
+
+static bool ready(const struct host_task *task) {
+  if (task->done) return false;
+  if (!task->started || task->wake_us <= host_now_us) return true;
+  if (task->queue == NULL) return false;
+  return task->for_space ? task->queue->count < task->queue->length : task->queue->count > 0;
+}
+
+// a task that returns is gone
+static void trampoline(void) {
+  current->code(current->arg);
+  current->done = true;
+}
+
+void host_run_tasks(void) {
+  while (true) {
+    struct host_task *next = NULL;
+    for (struct host_task *t = tasks; t; t = t->next) {
+      if (ready(t) && (next == NULL || t->priority > next->priority)) next = t;
+    }
+    if (next == NULL) return;
+    next->wake_us = INT64_MAX;
+    next->queue = NULL;
+    if (!next->started) {
+      getcontext(&next->context);
+      next->stack = malloc(TASK_STACK_SIZE);
+      next->context.uc_stack.ss_sp = next->stack;
+      next->context.uc_stack.ss_size = TASK_STACK_SIZE;
+      next->context.uc_link = &scheduler;
+      makecontext(&next->context, trampoline, 0);
+      next->started = true;
+    }
+    current = next;
+    swapcontext(&scheduler, &next->context);
+    current = &test_task;
+  }
+}
+
+void host_run_until(int64_t until_us) {
+  host_run_tasks();
+  while (true) {
+    int64_t next_us = INT64_MAX;
+    for (struct host_task *t = tasks; t; t = t->next) {
+      if (!t->done && t->wake_us < next_us) next_us = t->wake_us;
+    }
+    if (next_us > until_us) break;
+    host_now_us = next_us;
+    host_run_tasks();
+  }
+  host_now_us = until_us;
+  host_run_tasks();
+}
+
+void host_busy(int64_t for_us) {
+  block(host_now_us + for_us, NULL, false);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *out) {
+  struct host_task *task = calloc(1, sizeof(struct host_task));
+  if (task == NULL) return pdFALSE;
+  task->code = code;
+  task->arg = arg;
+  task->priority = priority;
+  task->wake_us = INT64_MAX;
+  struct host_task **last = &tasks;
+  while (*last) last = &(*last)->next;
+  *last = task;
+  if (out) *out = task;
+  return pdPASS;
+}
+
+/* --------------------------------- QUEUES --------------------------------- */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  struct host_queue *queue = calloc(1, sizeof(struct host_queue) + length * item_size);
+  if (queue == NULL) return NULL;
+  queue->length = length;
+  queue->item_size = item_size;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+  int64_t until_us = ticks_us(ticks);
+  while (queue->count == queue->length) {
+    if (ticks == 0 || current == &test_task || host_now_us >= until_us) return pdFALSE;
+    block(until_us, queue, true);
+  }
+  UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  if (queue->item_size) memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+  queue->count++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+  int64_t until_us = ticks_us(ticks);
+  while (queue->count == 0) {
+    if (ticks == 0 || current == &test_task || host_now_us >= until_us) return pdFALSE;
+    block(until_us, queue, false);
+  }
+  if (queue->item_size) memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+  QueueHandle_t semaphore = xQueueCreate(max, 0);
+  if (semaphore) semaphore->count = initial;
+  return semaphore;
+}
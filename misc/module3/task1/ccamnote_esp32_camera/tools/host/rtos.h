@@ -0,0 +1,29 @@
+/*
+ * rtos.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Just enough of FreeRTOS to run camera_worker.c's tasks on a desktop, on
+ * a simulated clock, in place of host.c. The test's own code is one task,
+ * and never blocks; tasks made with xTaskCreate each get a stack of their
+ * own, and run one at a time, from the test, until they wait on a queue or
+ * a semaphore, or are held up by host_busy the way a capture or an upload
+ * holds up the task doing it.
+ */
+
+#ifndef __HOST_RTOS_H__
+#define __HOST_RTOS_H__
+
+#include <stdint.h>
+
+// the simulated esp_timer_get_time()
+extern int64_t host_now_us;
+
+// runs every task that can, each until it blocks, without moving the clock
+void host_run_tasks(void);
+// moves the clock forward, running the tasks whenever one is due to wake
+void host_run_until(int64_t until_us);
+// holds the calling task for a while, as slow work would
+void host_busy(int64_t for_us);
+
+#endif /* __HOST_RTOS_H__ */
@@ -0,0 +1,168 @@
+/*
+ * http_upload_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Runs wifi_http_client.c's uploads against host.c's fake HTTP client, and
+ * checks the connection is kept from one picture to the next, and repaired
+ * when the server has closed it meanwhile.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o http_upload_test http_upload_test.c host/host.c
+ *   ./http_upload_test
+ *
+ * - keep-alive: 100 uploads, with the server dropping the idle connection
+ *   before every tenth, half the time found out on the first write and half
+ *   waiting for the answer. All 100 go through, on 11 connections: 89
+ *   reused, 10 repaired. The server gets every image whole, though the fake
+ *   socket takes a random part of each write.
+ * - closing: a server answering with Connection: close gets a new
+ *   connection for each upload, none of them counted as repaired.
+ * - failures: a refused connection fails the upload, and a fresh one is
+ *   not tried twice; an error status fails it too, but keeps the
+ *   connection. Either way the next upload goes through.
+ * - url: posting somewhere else makes a new client.
+ *
+ * The time a kept-alive connection saves is not measured here.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "../main/src/wifi_http_client.c"
+
+#define URL "http://server/image"
+#define IMAGE_SIZE (50000)
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                   HELPERS                                  */
+/* -------------------------------------------------------------------------- */
+
+static uint8_t image[IMAGE_SIZE];
+
+/**
+ * @brief Uploads a new picture, and checks the server got it whole if the
+ * upload went through.
+ */
+static esp_err_t upload(const char *url) {
+  for (size_t i = 0; i < sizeof(image); i++) image[i] = rand();
+  camera_fb_t fb = {.buf = image, .len = sizeof(image)};
+  esp_err_t err = http_post_image(url, &fb);
+  if (err == ESP_OK) {
+    CHECK(host_http_body_len == sizeof(image) && memcmp(host_http_body, image, sizeof(image)) == 0,
+          "the server got %zu bytes of a %zu-byte image, not all as sent", host_http_body_len, sizeof(image));
+  }
+  return err;
+}
+
+static http_upload_stats_t stats_now(void) {
+  http_upload_stats_t now;
+  http_get_upload_stats(&now);
+  return now;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static void check_keep_alive(void) {
+  int failed = 0;
+  for (int i = 0; i < 100; i++) {
+    if (i % 10 == 9) {
+      host_http_dead_at_headers = (i / 10) % 2;
+      host_http_drop();
+    }
+    failed += upload(URL) != ESP_OK;
+  }
+  http_upload_stats_t now = stats_now();
+  CHECK(failed == 0, "%d uploads failed", failed);
+  CHECK(host_http_connects == 11 && now.connections == 11, "%u connections opened, %u counted", host_http_connects,
+        now.connections);
+  CHECK(now.requests == 100 && now.reused == 89 && now.repaired == 10, "%u requests, %u reused, %u repaired",
+        now.requests, now.reused, now.repaired);
+  CHECK(host_http_inits == 1, "%u clients made for one url", host_http_inits);
+  printf("keep-alive: 100 uploads on %u connections, %u reused, %u repaired, %d failed\n", host_http_connects,
+         now.reused, now.repaired, failed);
+}
+
+static void check_closing(void) {
+  http_upload_stats_t before = stats_now();
+  uint32_t connects = host_http_connects;
+  // the first goes on the open connection, which the server then closes
+  host_http_closing = true;
+  for (int i = 0; i < 5; i++) CHECK(upload(URL) == ESP_OK, "upload %d failed with the server closing", i);
+  host_http_closing = false;
+  CHECK(upload(URL) == ESP_OK && upload(URL) == ESP_OK, "an upload failed after the server stopped closing");
+  http_upload_stats_t now = stats_now();
+  CHECK(host_http_connects - connects == 5, "%u connections for 5 closed by the server",
+        host_http_connects - connects);
+  CHECK(now.reused - before.reused == 2 && now.repaired == before.repaired, "%u reused, %u repaired",
+        now.reused - before.reused, now.repaired - before.repaired);
+  printf("closing: 7 uploads, the server closing the first 5, on %u new connections\n",
+         host_http_connects - connects);
+}
+
+static void check_failures(void) {
+  // dropped, and the server turns the fresh connection away: one repair, then it fails
+  http_upload_stats_t before = stats_now();
+  host_http_drop();
+  host_http_refuse = true;
+  CHECK(upload(URL) != ESP_OK, "an upload went through with connections refused");
+  http_upload_stats_t now = stats_now();
+  CHECK(now.repaired - before.repaired == 1 && now.requests == before.requests, "%u repaired, %u requests",
+        now.repaired - before.repaired, now.requests - before.requests);
+  // with no connection to begin with, a refusal is not tried again
+  CHECK(upload(URL) != ESP_OK, "an upload went through with connections refused");
+  CHECK(stats_now().repaired == now.repaired, "a fresh connection was repaired");
+  host_http_refuse = false;
+  uint32_t connects = host_http_connects;
+  CHECK(upload(URL) == ESP_OK, "an upload failed once connections were taken again");
+  CHECK(host_http_connects - connects == 1, "%u connections to come back", host_http_connects - connects);
+
+  // an error status: the upload fails, on a connection that stays good
+  host_http_status = 500;
+  CHECK(upload(URL) == ESP_FAIL, "a 500 was taken as sent");
+  host_http_status = 200;
+  CHECK(upload(URL) == ESP_OK, "an upload failed after a 500");
+  CHECK(host_http_connects - connects == 1, "%u connections across a 500", host_http_connects - connects);
+  printf("failures: refused connections and a 500 failed their uploads, and the next went through\n");
+}
+
+static void check_url(void) {
+  uint32_t inits = host_http_inits, cleanups = host_http_cleanups, connects = host_http_connects;
+  CHECK(upload("http://elsewhere/image") == ESP_OK, "an upload elsewhere failed");
+  CHECK(host_http_inits - inits == 1 && host_http_cleanups - cleanups == 1 && host_http_connects - connects == 1,
+        "a new url: %u clients made, %u cleaned up, %u connections", host_http_inits - inits,
+        host_http_cleanups - cleanups, host_http_connects - connects);
+  CHECK(upload("http://elsewhere/image") == ESP_OK && host_http_connects - connects == 1,
+        "the new url's connection was not kept");
+  printf("url: a new url, a new client\n");
+}
+
+int main(void) {
+  srand(1);
+  check_keep_alive();
+  check_closing();
+  check_failures();
+  check_url();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
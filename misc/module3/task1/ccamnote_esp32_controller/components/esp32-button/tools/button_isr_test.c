@@ -0,0 +1,209 @@
+/*
+ * button_isr_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Feeds simulated edge traces through the ISR debounce mode, and checks
+ * every press and release comes out once, stamped with its first edge and
+ * within one debounce window of it.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../include -o button_isr_test button_isr_test.c host/host.c
+ *   ./button_isr_test [transitions] [seed]
+ *
+ * Add -fsanitize=address,undefined to also check that deleting a group
+ * with a debounce window open leaves no timer behind on it. The host runs
+ * everything on one thread, so races with the esp_timer task or the other
+ * core are not covered.
+ *
+ * Builds button.c itself, against the stand-ins in host/, on a simulated
+ * clock. Exits non-zero on the first event that is missing, extra, late or
+ * stamped wrong.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "../src/button.c"
+
+#define WINDOW_US (CONFIG_ESP32_BUTTON_DEBOUNCE_MS * 1000)
+#define MAX_BOUNCES (6)
+#define MAX_BOUNCE_US (800)  // apart, so a transition always settles inside the window
+
+/* -------------------------------------------------------------------------- */
+/*                                   TRACES                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  int pin;
+  int level;
+  int64_t at_us;
+} edge_t;
+
+// what a transition should come out as
+typedef struct {
+  int pin;
+  uint8_t event;    // BUTTON_DOWN, BUTTON_UP, or 0 for a glitch that settles back
+  int64_t edge_us;  // its first edge
+} expect_t;
+
+typedef struct {
+  int pin;
+  bool inverted;
+  int level;
+  int64_t next_us;
+  button_group_handle_t group;
+} input_t;
+
+static edge_t *edges;
+static size_t edge_count;
+static expect_t *expected;
+static size_t expected_count;
+
+static int compare_edges(const void *a, const void *b) {
+  const edge_t *x = a, *y = b;
+  return x->at_us < y->at_us ? -1 : x->at_us > y->at_us;
+}
+
+/**
+ * @brief Lays down a transition on an input: a first edge, then bounces
+ * closer together than MAX_BOUNCE_US. One in five is a glitch that bounces
+ * back to where it started.
+ */
+static void add_transition(input_t *input) {
+  bool glitch = rand() % 5 == 0;
+  int toggles = 1 + 2 * (rand() % MAX_BOUNCES);
+  if (glitch) toggles++;
+  int64_t at = input->next_us;
+  for (int i = 0; i < toggles; i++) {
+    input->level ^= 1;
+    edges[edge_count++] = (edge_t){input->pin, input->level, at};
+    at += 50 + rand() % MAX_BOUNCE_US;
+  }
+  uint8_t event = 0;
+  if (!glitch) event = (input->level != input->inverted) ? BUTTON_DOWN : BUTTON_UP;
+  expected[expected_count++] = (expect_t){input->pin, event, input->next_us};
+  // quiet until well after the window closes
+  input->next_us = at + WINDOW_US + 1000 + rand() % (200 * 1000);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    CHECK                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  button_event_t event;
+  int64_t delivered_us;
+} received_t;
+
+static input_t inputs[2];
+static received_t *received;
+static size_t received_count;
+
+// runs after every timer callback, as a consumer would on being notified
+static void drain(void) {
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    button_event_t event;
+    while (ring_pop(inputs[i].group, &event)) {
+      received[received_count++] = (received_t){event, host_now_us};
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int transitions = argc > 1 ? atoi(argv[1]) : 20000;
+  srand(argc > 2 ? atoi(argv[2]) : 1);
+
+  edges = calloc(transitions * (2 * MAX_BOUNCES + 2), sizeof(edge_t));
+  expected = calloc(transitions, sizeof(expect_t));
+  received = calloc(2 * transitions, sizeof(received_t));
+
+  // one pulled-down button and one inverted, pulled-up one, as two groups
+  inputs[0] = (input_t){.pin = 4, .inverted = false, .level = 0};
+  inputs[1] = (input_t){.pin = 33, .inverted = true, .level = 1};
+  host_levels = 1ULL << inputs[1].pin;
+  for (size_t i = 0; i < 2; i++) {
+    button_group_config_t config = BUTTON_GROUP_CONFIG_DEFAULT();
+    config.pin_select = PIN_BIT(inputs[i].pin);
+    config.inverted = inputs[i].inverted;
+    config.pull_mode = inputs[i].inverted ? GPIO_PULLUP_ONLY : GPIO_PULLDOWN_ONLY;
+    config.isr_debounce = true;
+    config.queue_size = 16;
+    inputs[i].group = button_group_create(&config);
+    if (inputs[i].group == NULL) {
+      fprintf(stderr, "could not create group %zu\n", i);
+      return 1;
+    }
+    inputs[i].next_us = 1000 + rand() % 5000;
+  }
+
+  for (int i = 0; i < transitions; i++) add_transition(&inputs[i % 2]);
+  qsort(edges, edge_count, sizeof(edge_t), compare_edges);
+
+  host_timer_hook = drain;
+  for (size_t i = 0; i < edge_count; i++) {
+    host_advance(edges[i].at_us);
+    host_set_level(edges[i].pin, edges[i].level);
+  }
+  host_advance(host_now_us + 10 * WINDOW_US);
+
+  // match every transition to what came out for its pin, in order
+  size_t next[GPIO_NUM_MAX] = {0};
+  size_t events = 0, glitches = 0;
+  int64_t latency_max = 0;
+  int failures = 0;
+  for (size_t i = 0; i < expected_count && failures < 10; i++) {
+    const expect_t *want = &expected[i];
+    size_t *r = &next[want->pin];
+    while (*r < received_count && received[*r].event.pin != want->pin) (*r)++;
+    if (want->event == 0) {
+      // a glitch must come out as nothing at all
+      glitches++;
+      if (*r < received_count && received[*r].event.time_us == want->edge_us) {
+        fprintf(stderr, "pin %d: glitch at %lld us reported as event %d\n", want->pin,
+                (long long)want->edge_us, received[*r].event.event);
+        failures++;
+        (*r)++;
+      }
+      continue;
+    }
+    events++;
+    if (*r >= received_count) {
+      fprintf(stderr, "pin %d: event %d at %lld us never came\n", want->pin, want->event, (long long)want->edge_us);
+      failures++;
+      continue;
+    }
+    const received_t *got = &received[(*r)++];
+    int64_t latency = got->delivered_us - want->edge_us;
+    if (latency > latency_max) latency_max = latency;
+    if (got->event.event != want->event || got->event.time_us != want->edge_us || latency < 0 || latency > WINDOW_US) {
+      fprintf(stderr, "pin %d: wanted event %d at %lld us, got %d stamped %lld, delivered %lld us later\n",
+              want->pin, want->event, (long long)want->edge_us, got->event.event, (long long)got->event.time_us,
+              (long long)latency);
+      failures++;
+    }
+  }
+  if (received_count != events && failures == 0) {
+    fprintf(stderr, "%zu events for %zu transitions\n", received_count, events);
+    failures++;
+  }
+
+  // delete with a debounce window still open: nothing may fire on the
+  // freed group afterwards, which -fsanitize=address would catch
+  host_timer_hook = NULL;
+  for (size_t i = 0; i < 2; i++) {
+    host_set_level(inputs[i].pin, !gpio_get_level(inputs[i].pin));
+    button_group_delete(inputs[i].group);
+  }
+  host_advance(host_now_us + 10 * WINDOW_US);
+
+  printf("%zu edges, %zu presses and releases, %zu glitches: %zu events, latest %lld us after its edge "
+         "(window %d us)\n",
+         edge_count, events, glitches, received_count, (long long)latency_max, WINDOW_US);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
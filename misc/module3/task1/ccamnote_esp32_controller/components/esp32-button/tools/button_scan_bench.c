@@ -0,0 +1,350 @@
+/*
+ * button_scan_bench.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Compares the polled scanner's vertical-counter debounce with the per-pin
+ * history loop it replaced: that they report the same presses and releases,
+ * and what a scan tick costs each of them as the number of buttons grows.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../include -o button_scan_bench button_scan_bench.c host/host.c
+ *   ./button_scan_bench [ticks] [seed]
+ *
+ * Two checks, both on random level traces, then the benchmark:
+ *   exact      scan_group against a one-pin-at-a-time model of the same
+ *              2-bit counter, on noisy traces. Every event must match, tick
+ *              for tick.
+ *   old loop   scan_group against the old MASK shift-register debouncer, on
+ *              traces that bounce for up to 3 samples per transition and
+ *              then hold for at least 20. Both must report the same presses
+ *              and releases in the same order; the old one reports each a
+ *              couple of ticks later.
+ * The benchmark then times a scan tick of each, for 1 to 40 buttons, at
+ * rest and with every button changing about every 40 ticks.
+ * Exits non-zero if either check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "host.h"
+#include "../src/button.c"
+
+#define MAX_PINS (40)
+#define MAX_EVENTS (1 << 20)
+
+typedef struct {
+  uint8_t pin;
+  uint8_t event;
+  uint32_t tick;
+} seen_t;
+
+static seen_t *seen_new, *seen_old;
+static size_t count_new, count_old;
+
+static uint64_t pins_mask(int pins) {
+  return pins >= 64 ? ~0ULL : (1ULL << pins) - 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  OLD LOOP                                  */
+/* -------------------------------------------------------------------------- */
+
+// the per-pin debouncer the vertical counter replaced, as it was, minus the
+// queue and the logging
+typedef struct {
+  uint8_t pin;
+  uint16_t history;
+  uint32_t down_time;
+} old_debounce_t;
+
+#define MASK 0b1111000000111111
+
+static bool old_rose(old_debounce_t *d) {
+  if ((d->history & MASK) == 0b0000000000111111) {
+    d->history = 0xffff;
+    return 1;
+  }
+  return 0;
+}
+
+static bool old_fell(old_debounce_t *d) {
+  if ((d->history & MASK) == 0b1111000000000000) {
+    d->history = 0x0000;
+    return 1;
+  }
+  return 0;
+}
+
+static void old_scan(old_debounce_t *debounce, int pin_count, uint32_t tick) {
+  for (int idx = 0; idx < pin_count; idx++) {
+    old_debounce_t *d = &debounce[idx];
+    d->history = (d->history << 1) | gpio_get_level(d->pin);
+    if (old_fell(d)) {
+      d->down_time = 0;
+      seen_old[count_old++ & (MAX_EVENTS - 1)] = (seen_t){d->pin, BUTTON_UP, tick};
+    } else if (old_rose(d) && d->down_time == 0) {
+      d->down_time = tick + 1;
+      seen_old[count_old++ & (MAX_EVENTS - 1)] = (seen_t){d->pin, BUTTON_DOWN, tick};
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  NEW SCAN                                  */
+/* -------------------------------------------------------------------------- */
+
+static button_group_handle_t group_create(int pins) {
+  button_group_config_t config = BUTTON_GROUP_CONFIG_DEFAULT();
+  config.pin_select = pins_mask(pins);
+  config.scan_period_ms = 0;  // scanned here, not by the scanner task
+  config.queue_size = 64;
+  return button_group_create(&config);
+}
+
+static void new_scan(button_group_handle_t group, uint32_t tick) {
+  scan_group(group, host_levels, tick);
+  button_event_t event;
+  while (ring_pop(group, &event)) {
+    seen_new[count_new++ & (MAX_EVENTS - 1)] = (seen_t){event.pin, event.event, tick};
+  }
+}
+
+// the same 2-bit counter as scan_group, one pin at a time
+typedef struct {
+  bool state;
+  uint8_t count;
+} model_t;
+
+static void model_scan(model_t *model, int pins, uint32_t tick) {
+  for (int pin = 0; pin < pins; pin++) {
+    bool level = (host_levels >> pin) & 1;
+    if (level == model[pin].state) {
+      model[pin].count = 0;
+    } else if (++model[pin].count == 4) {
+      model[pin].count = 0;
+      model[pin].state = level;
+      seen_old[count_old++ & (MAX_EVENTS - 1)] = (seen_t){pin, level ? BUTTON_DOWN : BUTTON_UP, tick};
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   TRACES                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  bool level;
+  int hold;    // samples left before the next transition
+  int bounce;  // samples of bouncing left in the transition under way
+} trace_t;
+
+// noisy: every sample of every pin flips with some chance
+static void step_noisy(int pins) {
+  for (int pin = 0; pin < pins; pin++) {
+    if (rand() % 4 == 0) host_levels ^= 1ULL << pin;
+  }
+}
+
+// clean: a transition bounces for up to 3 samples, then holds for 20 to 60
+static void step_clean(trace_t *trace, int pins) {
+  for (int pin = 0; pin < pins; pin++) {
+    trace_t *t = &trace[pin];
+    bool level;
+    if (t->bounce > 0) {
+      t->bounce--;
+      level = rand() & 1;
+    } else if (t->hold > 0) {
+      t->hold--;
+      level = t->level;
+    } else {
+      t->level = !t->level;
+      t->bounce = rand() % 4;
+      t->hold = 20 + rand() % 41;
+      level = t->bounce ? !t->level : t->level;
+    }
+    host_levels = (host_levels & ~(1ULL << pin)) | ((uint64_t)level << pin);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static int check_exact(uint32_t ticks, int pins) {
+  button_group_handle_t group = group_create(pins);
+  model_t model[MAX_PINS] = {0};
+  host_levels = 0;
+  count_new = count_old = 0;
+  for (uint32_t tick = 0; tick < ticks && count_new < MAX_EVENTS; tick++) {
+    step_noisy(pins);
+    new_scan(group, tick);
+    model_scan(model, pins, tick);
+  }
+  button_group_delete(group);
+  // scan_group walks toggled pins lowest first, and so does the model
+  size_t limit = count_new < MAX_EVENTS ? count_new : MAX_EVENTS;
+  if (count_new != count_old) {
+    printf("exact: %zu events from the scan, %zu from the model\n", count_new, count_old);
+    return 1;
+  }
+  for (size_t i = 0; i < limit; i++) {
+    if (memcmp(&seen_new[i], &seen_old[i], sizeof(seen_t)) != 0) {
+      printf("exact: event %zu differs: pin %d event %d tick %u against pin %d event %d tick %u\n", i,
+             seen_new[i].pin, seen_new[i].event, seen_new[i].tick, seen_old[i].pin, seen_old[i].event,
+             seen_old[i].tick);
+      return 1;
+    }
+  }
+  printf("exact:    %d pins, %u noisy ticks, %zu events, all identical\n", pins, ticks, count_new);
+  return 0;
+}
+
+static int check_old(uint32_t ticks, int pins) {
+  button_group_handle_t group = group_create(pins);
+  old_debounce_t old[MAX_PINS] = {0};
+  trace_t trace[MAX_PINS] = {0};
+  for (int pin = 0; pin < pins; pin++) {
+    old[pin].pin = pin;
+    trace[pin].hold = 20 + rand() % 41;
+  }
+  host_levels = 0;
+  count_new = count_old = 0;
+  for (uint32_t tick = 0; tick < ticks && count_new < MAX_EVENTS; tick++) {
+    step_clean(trace, pins);
+    new_scan(group, tick);
+    old_scan(old, pins, tick);
+  }
+  button_group_delete(group);
+
+  // per pin, the same events in the same order; the old loop runs later
+  int failures = 0;
+  uint64_t lag = 0, lag_max = 0, matched = 0;
+  for (int pin = 0; pin < pins; pin++) {
+    size_t o = 0;
+    for (size_t n = 0; n < count_new; n++) {
+      if (seen_new[n].pin != pin) continue;
+      while (o < count_old && seen_old[o].pin != pin) o++;
+      // the last transition or two may still be settling for the old loop
+      if (o == count_old) break;
+      if (seen_old[o].event != seen_new[n].event || seen_old[o].tick < seen_new[n].tick) {
+        if (failures++ < 5) {
+          printf("old loop: pin %d, event %d at tick %u, old loop has %d at %u\n", pin, seen_new[n].event,
+                 seen_new[n].tick, seen_old[o].event, seen_old[o].tick);
+        }
+      }
+      uint32_t d = seen_old[o].tick - seen_new[n].tick;
+      lag += d;
+      if (d > lag_max) lag_max = d;
+      matched++;
+      o++;
+    }
+    while (o < count_old && seen_old[o].pin != pin) o++;
+    if (o < count_old) {
+      failures++;
+      printf("old loop: pin %d has events the scan never reported\n", pin);
+    }
+  }
+  if (matched + pins < count_new) {
+    failures++;
+    printf("old loop: matched %llu of %zu events\n", (unsigned long long)matched, count_new);
+  }
+  if (failures) return 1;
+  printf("old loop: %d pins, %u bouncy ticks, %llu events, same order, old loop %.2f ticks later on average "
+         "(at most %llu)\n",
+         pins, ticks, (unsigned long long)matched, matched ? (double)lag / matched : 0.0,
+         (unsigned long long)lag_max);
+  return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  BENCHMARK                                 */
+/* -------------------------------------------------------------------------- */
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// a mostly idle panel: the levels a tick sees, with the odd press
+static uint64_t *bench_levels(uint32_t ticks, int pins) {
+  uint64_t *levels = malloc(ticks * sizeof(uint64_t));
+  trace_t trace[MAX_PINS] = {0};
+  for (int pin = 0; pin < pins; pin++) trace[pin].hold = rand() % 200;
+  host_levels = 0;
+  for (uint32_t tick = 0; tick < ticks; tick++) {
+    step_clean(trace, pins);
+    levels[tick] = host_levels;
+  }
+  return levels;
+}
+
+static double bench_old(const uint64_t *levels, uint32_t ticks, int pins) {
+  old_debounce_t old[MAX_PINS] = {0};
+  for (int pin = 0; pin < pins; pin++) old[pin].pin = pin;
+  count_old = 0;
+  double start = now_ns();
+  for (uint32_t tick = 0; tick < ticks; tick++) {
+    host_levels = levels[tick];
+    old_scan(old, pins, tick);
+  }
+  return (now_ns() - start) / ticks;
+}
+
+static double bench_new(const uint64_t *levels, uint32_t ticks, int pins) {
+  button_group_handle_t group = group_create(pins);
+  count_new = 0;
+  double start = now_ns();
+  for (uint32_t tick = 0; tick < ticks; tick++) {
+    host_levels = levels[tick];
+    new_scan(group, tick);
+  }
+  double ns = (now_ns() - start) / ticks;
+  button_group_delete(group);
+  return ns;
+}
+
+/**
+ * @brief Times both debouncers on a panel at rest, and on one where every
+ * button is pressed or released about every 40 ticks.
+ */
+static void bench(uint32_t ticks, int pins) {
+  uint64_t *busy = bench_levels(ticks, pins);
+  uint64_t *idle = calloc(ticks, sizeof(uint64_t));
+  double old_idle = bench_old(idle, ticks, pins);
+  double new_idle = bench_new(idle, ticks, pins);
+  double old_busy = bench_old(busy, ticks, pins);
+  double new_busy = bench_new(busy, ticks, pins);
+  free(busy);
+  free(idle);
+  printf("%8d %10.1f %10.1f %10.1f %10.1f\n", pins, old_idle, new_idle, old_busy, new_busy);
+}
+
+int main(int argc, char **argv) {
+  uint32_t ticks = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+  srand(argc > 2 ? atoi(argv[2]) : 1);
+  seen_new = calloc(MAX_EVENTS, sizeof(seen_t));
+  seen_old = calloc(MAX_EVENTS, sizeof(seen_t));
+
+  int failures = 0;
+  const int sizes[] = {1, 4, 8, 16, 24, 32, 40};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    failures += check_exact(ticks / 10, sizes[i]);
+    failures += check_old(ticks / 10, sizes[i]);
+  }
+
+  // the old loop's gpio_get_level is a call into host.c per pin, as it is a
+  // call into the GPIO driver per pin on the target
+  printf("\nns per scan tick     at rest               busy\n%8s %10s %10s %10s %10s\n", "pins", "per-pin",
+         "vertical", "per-pin", "vertical");
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) bench(ticks, sizes[i]);
+
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef __HOST_GPIO_H__
+#define __HOST_GPIO_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define GPIO_NUM_MAX (40)
+
+typedef enum {
+  GPIO_PULLUP_ONLY,
+  GPIO_PULLDOWN_ONLY,
+  GPIO_PULLUP_PULLDOWN,
+  GPIO_FLOATING,
+} gpio_pull_mode_t;
+
+typedef enum {
+  GPIO_INTR_DISABLE,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_NEGEDGE,
+  GPIO_INTR_ANYEDGE,
+} gpio_int_type_t;
+
+typedef enum {
+  GPIO_MODE_INPUT = 1,
+} gpio_mode_t;
+
+typedef struct {
+  uint64_t pin_bit_mask;
+  gpio_mode_t mode;
+  int pull_up_en;
+  int pull_down_en;
+  gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void *arg);
+
+esp_err_t gpio_config(const gpio_config_t *config);
+int gpio_get_level(int pin);
+esp_err_t gpio_install_isr_service(int flags);
+esp_err_t gpio_isr_handler_add(int pin, gpio_isr_t handler, void *arg);
+esp_err_t gpio_isr_handler_remove(int pin);
+esp_err_t gpio_intr_enable(int pin);
+esp_err_t gpio_intr_disable(int pin);
+
+#endif /* __HOST_GPIO_H__ */
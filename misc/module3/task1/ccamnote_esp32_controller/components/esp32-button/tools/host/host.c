@@ -0,0 +1,297 @@
+/*
+ * host.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "soc/soc.h"
+
+#include "host.h"
+
+int64_t host_now_us = 0;
+uint64_t host_levels = 0;
+void (*host_timer_hook)(void) = NULL;
+
+const char *esp_err_to_name(esp_err_t err) {
+  return err == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+/* ---------------------------------- TIMERS -------------------------------- */
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void *arg;
+  bool active;
+  int64_t deadline_us;
+  uint64_t period_us;  // 0 for one-shot
+  struct esp_timer *next;
+};
+
+static struct esp_timer *timers = NULL;
+
+int64_t esp_timer_get_time(void) {
+  return host_now_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+  struct esp_timer *timer = calloc(1, sizeof(struct esp_timer));
+  if (timer == NULL) return ESP_ERR_NO_MEM;
+  timer->callback = args->callback;
+  timer->arg = args->arg;
+  timer->next = timers;
+  timers = timer;
+  *out = timer;
+  return ESP_OK;
+}
+
+static esp_err_t start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+  if (timer->active) return ESP_ERR_INVALID_STATE;
+  timer->active = true;
+  timer->deadline_us = host_now_us + timeout_us;
+  timer->period_us = period_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  return start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+  return start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer->active) return ESP_ERR_INVALID_STATE;
+  timer->active = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  if (timer == NULL) return ESP_ERR_INVALID_ARG;
+  if (timer->active) return ESP_ERR_INVALID_STATE;
+  for (struct esp_timer **link = &timers; *link; link = &(*link)->next) {
+    if (*link == timer) {
+      *link = timer->next;
+      break;
+    }
+  }
+  free(timer);
+  return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+  return timer->active;
+}
+
+/**
+ * @brief Moves the clock forward, firing every timer that comes due on the
+ * way, earliest first, with the clock set to its deadline.
+ *
+ * @param until_us Where the clock ends up.
+ */
+void host_advance(int64_t until_us) {
+  for (;;) {
+    struct esp_timer *due = NULL;
+    for (struct esp_timer *timer = timers; timer; timer = timer->next) {
+      if (timer->active && timer->deadline_us <= until_us && (due == NULL || timer->deadline_us < due->deadline_us)) {
+        due = timer;
+      }
+    }
+    if (due == NULL) break;
+    if (due->deadline_us > host_now_us) host_now_us = due->deadline_us;
+    if (due->period_us) {
+      due->deadline_us += due->period_us;
+    } else {
+      due->active = false;
+    }
+    due->callback(due->arg);
+    if (host_timer_hook) host_timer_hook();
+  }
+  if (until_us > host_now_us) host_now_us = until_us;
+}
+
+/* ----------------------------------- GPIO --------------------------------- */
+
+static struct {
+  gpio_isr_t handler;
+  void *arg;
+  bool enabled;
+} pins[GPIO_NUM_MAX];
+
+uint32_t host_reg_read(uint32_t reg) {
+  return reg == 0 ? (uint32_t)host_levels : (uint32_t)(host_levels >> 32);
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+  for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+    if (config->pin_bit_mask & (1ULL << pin)) pins[pin].enabled = config->intr_type != GPIO_INTR_DISABLE;
+  }
+  return ESP_OK;
+}
+
+int gpio_get_level(int pin) {
+  return (host_levels >> pin) & 1;
+}
+
+esp_err_t gpio_install_isr_service(int flags) {
+  static bool installed = false;
+  if (installed) return ESP_ERR_INVALID_STATE;
+  installed = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(int pin, gpio_isr_t handler, void *arg) {
+  pins[pin].handler = handler;
+  pins[pin].arg = arg;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(int pin) {
+  pins[pin].handler = NULL;
+  pins[pin].arg = NULL;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(int pin) {
+  pins[pin].enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(int pin) {
+  pins[pin].enabled = false;
+  return ESP_OK;
+}
+
+/**
+ * @brief Drives a pin, running its any-edge interrupt if the level changed
+ * while the interrupt is enabled. Edges while it is masked are not latched.
+ *
+ * @param pin The GPIO.
+ * @param level 0 or 1.
+ */
+void host_set_level(int pin, int level) {
+  uint64_t bit = 1ULL << pin;
+  if (((host_levels & bit) != 0) == (level != 0)) return;
+  host_levels ^= bit;
+  if (pins[pin].enabled && pins[pin].handler) pins[pin].handler(pins[pin].arg);
+}
+
+/* --------------------------------- FREERTOS ------------------------------- */
+
+struct host_queue {
+  uint8_t *items;
+  UBaseType_t item_size;
+  UBaseType_t length;
+  UBaseType_t head;
+  UBaseType_t count;
+};
+
+struct host_task {
+  int unused;
+};
+
+static struct host_task current_task;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  struct host_queue *queue = calloc(1, sizeof(struct host_queue));
+  if (queue == NULL) return NULL;
+  queue->items = calloc(length ? length : 1, item_size ? item_size : 1);
+  queue->item_size = item_size;
+  queue->length = length;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+  if (queue->count == queue->length) return pdFALSE;
+  UBaseType_t slot = (queue->head + queue->count) % queue->length;
+  if (queue->item_size && item) memcpy(queue->items + slot * queue->item_size, item, queue->item_size);
+  queue->count++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+  if (queue->count == 0) return pdFALSE;
+  if (queue->item_size && item) memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return queue->count;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  free(queue->items);
+  free(queue);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  SemaphoreHandle_t sem = xQueueCreate(1, 0);
+  xSemaphoreGive(sem);
+  return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+  return xQueueCreate(1, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+  vQueueDelete(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  if (sem->count == 0 && ticks) host_advance(host_now_us);
+  return xQueueReceive(sem, NULL, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  return xQueueSend(sem, NULL, 0);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio, TaskHandle_t *out) {
+  if (out) *out = &current_task;
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return &current_task;
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return host_now_us / 1000;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  host_advance(host_now_us + (int64_t)ticks * 1000);
+}
+
+void vTaskDelayUntil(TickType_t *last_wake, TickType_t period) {
+  *last_wake += period;
+  host_advance((int64_t)*last_wake * 1000);
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  return 0;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t ticks) {
+  return pdFALSE;
+}
@@ -0,0 +1,27 @@
+/*
+ * host.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Just enough of ESP-IDF and FreeRTOS to run button.c on a desktop, on a
+ * simulated clock. Timers fire and GPIO interrupts run from the calling
+ * thread, in time order, as the test moves the clock forward.
+ */
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// the simulated esp_timer_get_time()
+extern int64_t host_now_us;
+// every GPIO level, as GPIO_IN_REG and GPIO_IN1_REG read them
+extern uint64_t host_levels;
+// called after every timer callback, with the clock at the time it fired
+extern void (*host_timer_hook)(void);
+
+void host_advance(int64_t until_us);
+void host_set_level(int pin, int level);
+
+#endif /* __HOST_H__ */
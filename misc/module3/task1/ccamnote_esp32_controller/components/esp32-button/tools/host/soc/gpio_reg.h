@@ -0,0 +1,7 @@
+#ifndef __HOST_GPIO_REG_H__
+#define __HOST_GPIO_REG_H__
+
+#define GPIO_IN_REG (0)
+#define GPIO_IN1_REG (1)
+
+#endif /* __HOST_GPIO_REG_H__ */
@@ -0,0 +1,9 @@
+#ifndef __HOST_SOC_H__
+#define __HOST_SOC_H__
+
+#include <stdint.h>
+
+uint32_t host_reg_read(uint32_t reg);
+#define REG_READ(reg) host_reg_read(reg)
+
+#endif /* __HOST_SOC_H__ */
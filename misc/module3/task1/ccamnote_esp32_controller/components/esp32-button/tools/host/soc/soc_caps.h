@@ -0,0 +1,6 @@
+#ifndef __HOST_SOC_CAPS_H__
+#define __HOST_SOC_CAPS_H__
+
+#define SOC_GPIO_PIN_COUNT (40)
+
+#endif /* __HOST_SOC_CAPS_H__ */
@@ -0,0 +1,6 @@
+#ifndef __HOST_TRACE_H__
+#define __HOST_TRACE_H__
+
+#define TRACE(...) ((void)0)
+
+#endif /* __HOST_TRACE_H__ */
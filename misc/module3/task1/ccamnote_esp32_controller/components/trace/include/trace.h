@@ -0,0 +1,106 @@
+/*
+ * trace.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "trace_events.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   CONFIG                                   */
+/* -------------------------------------------------------------------------- */
+
+#ifndef CONFIG_TRACE_RING_EVENTS
+#define CONFIG_TRACE_RING_EVENTS (512)
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                   FORMAT                                   */
+/* -------------------------------------------------------------------------- */
+
+// a dump is a header followed by `count` events, oldest first, all fields
+// little-endian. this is what trace_dump hands its writer, what
+// trace_dump_serial prints in hex, and what tools/trace_decode reads.
+//
+// header:
+//   offset  size  field
+//   0       4     TRACE_DUMP_MAGIC, "TRC1"
+//   4       2     TRACE_DUMP_VERSION
+//   6       2     size of one event, TRACE_EVENT_SIZE
+//   8       4     CPU clock in Hz, what the cycle counts tick at
+//   12      4     events recorded since boot; any older than the dump's first were overwritten
+//   16      4     events in the dump
+//   20      4     cores
+//   24      16    per core, its 40-bit cycle count when the dump was taken
+//   40      16    per core, esp_timer_get_time() at that same moment
+//
+// event:
+//   0       4     sequence number, +1 per event across all cores
+//   4       4     the recording core's cycle count, low 32 bits
+//   8       2     id, the position in TRACE_EVENTS
+//   10      1     the core it was recorded on
+//   11      1     the recording core's cycle count, bits 32..39
+//   12      16    four arguments
+#define TRACE_DUMP_MAGIC (0x31435254)
+#define TRACE_DUMP_VERSION (1)
+#define TRACE_DUMP_CORES (2)
+#define TRACE_DUMP_HEADER_SIZE (56)
+#define TRACE_EVENT_SIZE (28)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+#define TRACE_EVENT_ID(id, format) id,
+typedef enum {
+  TRACE_EVENTS(TRACE_EVENT_ID)
+  TRACE_EVENT_COUNT
+} trace_event_t;
+#undef TRACE_EVENT_ID
+
+typedef struct {
+  uint32_t seq;
+  uint32_t cycles;
+  uint16_t id;
+  uint8_t core;
+  uint8_t epoch;  // how often the cycle count has wrapped
+  uint32_t args[4];
+} trace_record_t;
+
+_Static_assert(sizeof(trace_record_t) == TRACE_EVENT_SIZE, "a trace record is laid out as it goes on the wire");
+
+// takes every chunk of a dump in turn; returning false ends the dump there
+typedef bool (*trace_writer_t)(const void *data, size_t len, void *arg);
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// records an event with up to four integer arguments. costs a few dozen
+// cycles and never blocks, so it is safe anywhere, interrupts included
+#if CONFIG_TRACE_ENABLE
+#define TRACE(id, ...) TRACE_ARGS((id), ##__VA_ARGS__, 0, 0, 0, 0)
+#define TRACE_ARGS(id, a, b, c, d, ...) \
+  trace_record((id), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+#else
+#define TRACE(id, ...) ((void)0)
+#endif
+
+// keeps count of the cycle counters wrapping, even when nothing is traced.
+// call once, early on
+void trace_init(void);
+void trace_record(uint16_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+// streams the ring out through `write`, oldest event first. returns how many events it held
+uint32_t trace_dump(trace_writer_t write, void *arg);
+// prints a dump on the console as "TRACE <hex>" lines, for tools/trace_decode
+void trace_dump_serial(void);
+
+#endif /* __TRACE_H__ */
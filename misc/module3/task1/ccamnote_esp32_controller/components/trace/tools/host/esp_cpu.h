@@ -0,0 +1,8 @@
+#ifndef __HOST_ESP_CPU_H__
+#define __HOST_ESP_CPU_H__
+
+#include <stdint.h>
+
+uint32_t esp_cpu_get_ccount(void);
+
+#endif /* __HOST_ESP_CPU_H__ */
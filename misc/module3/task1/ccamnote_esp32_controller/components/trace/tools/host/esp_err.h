@@ -0,0 +1,8 @@
+#ifndef __HOST_ESP_ERR_H__
+#define __HOST_ESP_ERR_H__
+
+typedef int esp_err_t;
+
+#define ESP_OK (0)
+
+#endif /* __HOST_ESP_ERR_H__ */
@@ -0,0 +1,10 @@
+#ifndef __HOST_ESP_FREERTOS_HOOKS_H__
+#define __HOST_ESP_FREERTOS_HOOKS_H__
+
+#include "esp_err.h"
+
+typedef void (*esp_freertos_tick_cb_t)(void);
+
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t cb, unsigned int cpu);
+
+#endif /* __HOST_ESP_FREERTOS_HOOKS_H__ */
@@ -0,0 +1,12 @@
+#ifndef __HOST_ESP_IPC_H__
+#define __HOST_ESP_IPC_H__
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef void (*esp_ipc_func_t)(void *arg);
+
+esp_err_t esp_ipc_call_blocking(uint32_t cpu, esp_ipc_func_t func, void *arg);
+
+#endif /* __HOST_ESP_IPC_H__ */
@@ -0,0 +1,16 @@
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+
+typedef unsigned int UBaseType_t;
+
+// two cores, which the test takes turns running on
+#define portNUM_PROCESSORS (2)
+int xPortGetCoreID(void);
+
+// one core runs at a time, so there is nothing to mask
+#define portSET_INTERRUPT_MASK_FROM_ISR() (0)
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(state) ((void)(state))
+
+#endif /* __HOST_FREERTOS_H__ */
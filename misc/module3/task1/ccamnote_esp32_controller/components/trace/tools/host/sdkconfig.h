@@ -0,0 +1,9 @@
+#ifndef __HOST_SDKCONFIG_H__
+#define __HOST_SDKCONFIG_H__
+
+// a small ring, so a short run wraps it
+#define CONFIG_TRACE_ENABLE (1)
+#define CONFIG_TRACE_RING_EVENTS (64)
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ (160)
+
+#endif /* __HOST_SDKCONFIG_H__ */
@@ -0,0 +1,235 @@
+/*
+ * trace_decode.cpp
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Decodes a trace dump from the controller into one line per event.
+ *
+ *   c++ -std=c++17 -O2 -I../include -o trace_decode trace_decode.cpp
+ *   ./trace_decode capture.log      # `idf.py monitor` output with a trace_dump_serial in it
+ *   ./trace_decode trace.bin        # a raw dump, as the websocket server saves it
+ *
+ * Reads stdin when no file is given.
+ */
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "trace_events.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   FORMAT                                   */
+/* -------------------------------------------------------------------------- */
+
+// mirrors trace.h in the firmware
+namespace {
+
+constexpr uint32_t DUMP_MAGIC = 0x31435254;
+constexpr uint16_t DUMP_VERSION = 1;
+constexpr size_t DUMP_CORES = 2;
+constexpr size_t HEADER_SIZE = 56;
+constexpr size_t EVENT_SIZE = 28;
+constexpr uint16_t ID_LOST = 0xffff;
+
+#define TRACE_EVENT_NAME(id, format) {#id, format},
+struct EventInfo {
+  const char *name;
+  const char *format;
+};
+const EventInfo EVENTS[] = {TRACE_EVENTS(TRACE_EVENT_NAME)};
+#undef TRACE_EVENT_NAME
+constexpr size_t EVENT_COUNT = sizeof(EVENTS) / sizeof(EVENTS[0]);
+
+struct Header {
+  uint32_t cpu_hz;
+  uint32_t recorded;
+  uint32_t count;
+  uint32_t cores;
+  uint64_t anchor_cycles[DUMP_CORES];
+  int64_t anchor_us[DUMP_CORES];
+};
+
+struct Event {
+  uint32_t seq;
+  uint64_t cycles;  // 40 bits, with the wraps
+  uint16_t id;
+  uint8_t core;
+  uint32_t args[4];
+  double time_us;  // on esp_timer's clock, filled in by place_on_timeline
+};
+
+uint64_t get_le(const uint8_t *p, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) value |= uint64_t(p[i]) << (8 * i);
+  return value;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   INPUT                                    */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Picks the last dump out of a console capture: the hex after "TRACE " on
+ * every line from the last "TRACE BEGIN" on, up to "TRACE END".
+ */
+std::vector<uint8_t> from_console(const std::string &text) {
+  std::vector<uint8_t> dump;
+  std::istringstream lines(text);
+  std::string line;
+  bool inside = false;
+  while (std::getline(lines, line)) {
+    size_t at = line.find("TRACE ");
+    if (at == std::string::npos) continue;
+    std::string rest = line.substr(at + 6);
+    if (rest.rfind("BEGIN", 0) == 0) {
+      dump.clear();
+      inside = true;
+    } else if (rest.rfind("END", 0) == 0) {
+      inside = false;
+    } else if (inside) {
+      for (size_t i = 0; i + 1 < rest.size() && isxdigit(rest[i]) && isxdigit(rest[i + 1]); i += 2) {
+        dump.push_back(std::stoi(rest.substr(i, 2), nullptr, 16));
+      }
+    }
+  }
+  return dump;
+}
+
+bool parse(const std::vector<uint8_t> &dump, Header &header, std::vector<Event> &events) {
+  if (dump.size() < HEADER_SIZE || get_le(&dump[0], 4) != DUMP_MAGIC) {
+    std::cerr << "not a trace dump\n";
+    return false;
+  }
+  if (get_le(&dump[4], 2) != DUMP_VERSION || get_le(&dump[6], 2) != EVENT_SIZE) {
+    std::cerr << "trace dump version " << get_le(&dump[4], 2) << " is not one this decoder reads\n";
+    return false;
+  }
+  header.cpu_hz = get_le(&dump[8], 4);
+  header.recorded = get_le(&dump[12], 4);
+  header.count = get_le(&dump[16], 4);
+  header.cores = get_le(&dump[20], 4);
+  for (size_t core = 0; core < DUMP_CORES; core++) {
+    header.anchor_cycles[core] = get_le(&dump[24 + 8 * core], 8);
+    header.anchor_us[core] = int64_t(get_le(&dump[40 + 8 * core], 8));
+  }
+  if (header.cpu_hz == 0 || header.cores == 0 || header.cores > DUMP_CORES) {
+    std::cerr << "trace dump header is corrupt\n";
+    return false;
+  }
+  size_t available = (dump.size() - HEADER_SIZE) / EVENT_SIZE;
+  if (available < header.count) {
+    std::cerr << "trace dump is cut short: " << available << " of " << header.count << " events\n";
+    header.count = available;
+  }
+  for (size_t i = 0; i < header.count; i++) {
+    const uint8_t *p = &dump[HEADER_SIZE + i * EVENT_SIZE];
+    Event event{};
+    event.seq = get_le(p, 4);
+    event.cycles = get_le(p + 4, 4) | uint64_t(p[11]) << 32;
+    event.id = get_le(p + 8, 2);
+    event.core = p[10];
+    for (size_t arg = 0; arg < 4; arg++) event.args[arg] = get_le(p + 12 + 4 * arg, 4);
+    events.push_back(event);
+  }
+  return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  TIMELINE                                  */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Puts every event on esp_timer's clock. Each core's cycle count is 40 bits
+ * with its wraps, which themselves wrap every 2^40 cycles (1.9 h at
+ * 160 MHz), so walking back from the dump's anchor, the gaps between one
+ * core's events are added up as they go. A gap of 2^40 cycles or more on
+ * one core would go unseen, except that events are numbered in the order
+ * they were recorded across both cores: an event that comes out later than
+ * the one recorded after it was really that much earlier.
+ */
+void place_on_timeline(const Header &header, std::vector<Event> &events) {
+  constexpr uint64_t WRAP = uint64_t(1) << 40;
+  const double cycles_per_us = header.cpu_hz / 1e6;
+  // how far back from its anchor each core has got, and the cycle count it was at
+  uint64_t age[DUMP_CORES] = {0};
+  uint64_t last_cycles[DUMP_CORES];
+  bool seen[DUMP_CORES] = {false};
+  double earliest_after = 1e300;
+  for (auto event = events.rbegin(); event != events.rend(); ++event) {
+    if (event->id == ID_LOST || event->core >= header.cores) continue;
+    size_t core = event->core;
+    uint64_t from = seen[core] ? last_cycles[core] : header.anchor_cycles[core];
+    age[core] += (from - event->cycles) & (WRAP - 1);
+    last_cycles[core] = event->cycles;
+    seen[core] = true;
+    event->time_us = header.anchor_us[core] - age[core] / cycles_per_us;
+    // the two cores' events interleave within a microsecond or so of each other
+    while (event->time_us > earliest_after + 1.0) {
+      age[core] += WRAP;
+      event->time_us -= WRAP / cycles_per_us;
+    }
+    if (event->time_us < earliest_after) earliest_after = event->time_us;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   OUTPUT                                   */
+/* -------------------------------------------------------------------------- */
+
+void print(const Header &header, const std::vector<Event> &events) {
+  std::printf("%u events recorded, the last %u in this dump, %u core(s) at %u MHz\n", header.recorded,
+              header.count, header.cores, header.cpu_hz / 1000000);
+  const Event *previous = nullptr;
+  for (const Event &event : events) {
+    if (event.id == ID_LOST) {
+      std::printf("%14s                  #%-8u (overwritten while dumping)\n", "", event.seq);
+      continue;
+    }
+    char text[256];
+    if (event.id < EVENT_COUNT) {
+      std::snprintf(text, sizeof(text), EVENTS[event.id].format, event.args[0], event.args[1], event.args[2],
+                    event.args[3]);
+    } else {
+      std::snprintf(text, sizeof(text), "unknown event %u (%u, %u, %u, %u)", event.id, event.args[0],
+                    event.args[1], event.args[2], event.args[3]);
+    }
+    double delta_us = previous ? event.time_us - previous->time_us : 0;
+    std::printf("%14.3f ms %+10.3f ms  #%-8u core %u  %s\n", event.time_us / 1000, delta_us / 1000, event.seq,
+                event.core, text);
+    previous = &event;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::string input;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::cerr << "cannot open " << argv[1] << "\n";
+      return 1;
+    }
+    input.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  } else {
+    input.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+  }
+
+  // a raw dump starts with the magic, anything else is a console capture
+  std::vector<uint8_t> dump(input.begin(), input.end());
+  if (dump.size() < 4 || get_le(&dump[0], 4) != DUMP_MAGIC) dump = from_console(input);
+
+  Header header;
+  std::vector<Event> events;
+  if (!parse(dump, header, events)) return 1;
+  place_on_timeline(header, events);
+  print(header, events);
+  return 0;
+}
@@ -0,0 +1,391 @@
+/*
+ * trace_ring_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Runs trace.c on two simulated cores, whose cycle counters run at
+ * 160 MHz from different starting points, and checks what its dumps hold,
+ * then has trace_decode put them back on esp_timer's clock.
+ *
+ *   c++ -std=c++17 -O2 -I../include -o trace_decode trace_decode.cpp
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../include -o trace_ring_test trace_ring_test.c
+ *   ./trace_ring_test [./trace_decode]
+ *
+ * - ring: 100 events, 1 ms apart on alternating cores, into a 64-event
+ *   ring, with 40 s of nothing but FreeRTOS ticks after the 70th. The gap
+ *   wraps both cycle counters; the dump holds the newest 64, in order, each
+ *   with its 40-bit cycle count, and the anchors put each on the time it
+ *   was recorded at.
+ * - serial: trace_dump_serial prints the same bytes trace_dump writes.
+ * - decode: trace_decode reads both, prints the same for each, and puts
+ *   every event on the microsecond it was recorded at.
+ * - lost: events recorded while a dump is being written overwrite the
+ *   oldest it has yet to copy, and a slot still being written when it is
+ *   copied; those go out marked lost, and the rest whole.
+ *
+ * Writes trace.bin and trace.log in the working directory. The ns per
+ * event it prints is a host number; cycles on the ESP32 were not measured.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/trace.c"
+
+#define CPU_MHZ (CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ)
+#define CYCLES_40 ((UINT64_C(1) << 40) - 1)
+// esp_timer's clock at the start of the run
+#define BOOT_US (5000000)
+#define EVENTS (100)
+#define GAP_AFTER (70)
+#define GAP_US (40000000)
+#define TICK_US (10000)
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                    CORES                                   */
+/* -------------------------------------------------------------------------- */
+
+static int64_t now_us = 0;
+static int running_on = 0;
+// where each core's cycle counter was at the start of the run
+static const uint64_t core_start[portNUM_PROCESSORS] = {123456789, 987654321};
+static esp_freertos_tick_cb_t tick_hooks[portNUM_PROCESSORS];
+
+static uint64_t cycles_at(int core, int64_t us) {
+  return core_start[core] + (uint64_t)us * CPU_MHZ;
+}
+
+int xPortGetCoreID(void) {
+  return running_on;
+}
+
+uint32_t esp_cpu_get_ccount(void) {
+  return cycles_at(running_on, now_us);
+}
+
+int64_t esp_timer_get_time(void) {
+  return BOOT_US + now_us;
+}
+
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t cb, unsigned int cpu) {
+  tick_hooks[cpu] = cb;
+  return ESP_OK;
+}
+
+esp_err_t esp_ipc_call_blocking(uint32_t cpu, esp_ipc_func_t func, void *arg) {
+  int was_on = running_on;
+  running_on = cpu;
+  func(arg);
+  running_on = was_on;
+  return ESP_OK;
+}
+
+/**
+ * @brief Moves the clock on, running every core's tick hook on the way.
+ */
+static void idle(int64_t for_us) {
+  int was_on = running_on;
+  for (int64_t until_us = now_us + for_us; now_us + TICK_US <= until_us;) {
+    now_us += TICK_US;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      running_on = core;
+      if (tick_hooks[core]) tick_hooks[core]();
+    }
+  }
+  running_on = was_on;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   EVENTS                                   */
+/* -------------------------------------------------------------------------- */
+
+// what every event was, by sequence number
+typedef struct {
+  int core;
+  int64_t time_us;
+  uint16_t id;
+  uint32_t args[4];
+} recorded_t;
+
+static recorded_t recorded[1024];
+
+static void record(int core, uint16_t id, uint32_t a, uint32_t b) {
+  running_on = core;
+  uint32_t seq = head;
+  TRACE(id, a, b, seq);
+  recorded[seq] = (recorded_t){.core = core, .time_us = BOOT_US + now_us, .id = id, .args = {a, b, seq, 0}};
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    DUMPS                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint8_t bytes[TRACE_DUMP_HEADER_SIZE + RING_EVENTS * TRACE_EVENT_SIZE];
+  size_t len;
+  int writes;
+  int record_on_write;  // events to record on core 1 while the header is written
+} dump_t;
+
+static bool to_memory(const void *data, size_t len, void *arg) {
+  dump_t *dump = arg;
+  if (dump->len + len > sizeof(dump->bytes)) return false;
+  memcpy(dump->bytes + dump->len, data, len);
+  dump->len += len;
+  if (dump->writes++ == 0) {
+    for (int i = 0; i < dump->record_on_write; i++) record(1, TRACE_TOUCHPAD, 1000 + i, 0);
+  }
+  return true;
+}
+
+static uint64_t get_le(const uint8_t *p, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) value |= (uint64_t)p[i] << (8 * i);
+  return value;
+}
+
+static const trace_record_t *event_at(const dump_t *dump, uint32_t i) {
+  return (const trace_record_t *)(dump->bytes + TRACE_DUMP_HEADER_SIZE) + i;
+}
+
+/**
+ * @brief Puts an event on esp_timer's clock from its core's anchor, as
+ * trace_decode does for a core with no gap of 2^40 cycles in it.
+ */
+static int64_t time_of(const dump_t *dump, const trace_record_t *event) {
+  uint64_t anchor_cycles = get_le(dump->bytes + 24 + 8 * event->core, 8);
+  int64_t anchor_us = get_le(dump->bytes + 40 + 8 * event->core, 8);
+  uint64_t cycles = event->cycles | (uint64_t)event->epoch << 32;
+  return anchor_us - (int64_t)(((anchor_cycles - cycles) & CYCLES_40) / CPU_MHZ);
+}
+
+static bool write_file(const char *path, const void *data, size_t len) {
+  FILE *file = fopen(path, "wb");
+  if (!file) return false;
+  bool written = fwrite(data, 1, len, file) == len;
+  return fclose(file) == 0 && written;
+}
+
+/**
+ * @brief Runs trace_dump_serial with stdout going to a file.
+ */
+static bool dump_serial(const char *path) {
+  fflush(stdout);
+  int out = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  int saved = dup(STDOUT_FILENO);
+  if (out < 0 || saved < 0) return false;
+  dup2(out, STDOUT_FILENO);
+  close(out);
+  trace_dump_serial();
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+  return true;
+}
+
+/**
+ * @brief Reads the hex back out of trace_dump_serial's lines.
+ */
+static size_t from_serial(const char *path, uint8_t *bytes, size_t max) {
+  FILE *file = fopen(path, "r");
+  if (!file) return 0;
+  char line[256];
+  size_t len = 0;
+  bool inside = false;
+  while (fgets(line, sizeof(line), file)) {
+    if (strncmp(line, "TRACE BEGIN", 11) == 0) {
+      inside = true;
+    } else if (strncmp(line, "TRACE END", 9) == 0) {
+      inside = false;
+    } else if (inside && strncmp(line, "TRACE ", 6) == 0) {
+      unsigned int byte;
+      for (const char *p = line + 6; len < max && sscanf(p, "%2x", &byte) == 1; p += 2) bytes[len++] = byte;
+    }
+  }
+  fclose(file);
+  return len;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static dump_t quiet;
+
+static void check_ring(void) {
+  trace_init();
+  CHECK(tick_hooks[0] && tick_hooks[1], "trace_init did not hook every core's tick");
+  uint64_t before_gap[portNUM_PROCESSORS];
+  for (int i = 0; i < EVENTS; i++) {
+    if (i == GAP_AFTER) {
+      for (int core = 0; core < portNUM_PROCESSORS; core++) before_gap[core] = cycles_at(core, now_us);
+      idle(GAP_US);
+    }
+    now_us += 1000;
+    record(i % 2, i % TRACE_EVENT_COUNT, i, -i);
+  }
+  now_us += 2000;
+  int64_t dumped_us = BOOT_US + now_us;
+  uint32_t count = trace_dump(to_memory, &quiet);
+
+  const uint8_t *header = quiet.bytes;
+  CHECK(count == RING_EVENTS && quiet.len == TRACE_DUMP_HEADER_SIZE + RING_EVENTS * TRACE_EVENT_SIZE,
+        "dumped %u events in %zu bytes", count, quiet.len);
+  CHECK(get_le(header, 4) == TRACE_DUMP_MAGIC && get_le(header + 4, 2) == TRACE_DUMP_VERSION &&
+            get_le(header + 6, 2) == TRACE_EVENT_SIZE && get_le(header + 8, 4) == CPU_MHZ * 1000000,
+        "header starts %08llx %04llx %04llx %llu", (unsigned long long)get_le(header, 4),
+        (unsigned long long)get_le(header + 4, 2), (unsigned long long)get_le(header + 6, 2),
+        (unsigned long long)get_le(header + 8, 4));
+  CHECK(get_le(header + 12, 4) == EVENTS && get_le(header + 16, 4) == RING_EVENTS && get_le(header + 20, 4) == 2,
+        "header says %llu recorded, %llu dumped, %llu cores", (unsigned long long)get_le(header + 12, 4),
+        (unsigned long long)get_le(header + 16, 4), (unsigned long long)get_le(header + 20, 4));
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    uint64_t anchor_cycles = get_le(header + 24 + 8 * core, 8);
+    CHECK(anchor_cycles == (cycles_at(core, now_us) & CYCLES_40), "core %d anchored at %llu cycles", core,
+          (unsigned long long)anchor_cycles);
+    CHECK((int64_t)get_le(header + 40 + 8 * core, 8) == dumped_us, "core %d anchored at %lld us", core,
+          (long long)get_le(header + 40 + 8 * core, 8));
+  }
+
+  int on_time = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const trace_record_t *event = event_at(&quiet, i);
+    uint32_t seq = EVENTS - RING_EVENTS + i;
+    const recorded_t *was = &recorded[seq];
+    CHECK(event->seq == seq && event->id == was->id && event->core == was->core &&
+              memcmp(event->args, was->args, sizeof(event->args)) == 0,
+          "event %u: #%u id %u core %u", i, event->seq, event->id, event->core);
+    uint64_t cycles = event->cycles | (uint64_t)event->epoch << 32;
+    uint64_t expected = cycles_at(was->core, was->time_us - BOOT_US) & CYCLES_40;
+    CHECK(cycles == expected, "#%u at %llu cycles, recorded at %llu", seq, (unsigned long long)cycles,
+          (unsigned long long)expected);
+    int64_t time_us = time_of(&quiet, event);
+    CHECK(time_us == was->time_us, "#%u placed at %lld us, recorded at %lld us", seq, (long long)time_us,
+          (long long)was->time_us);
+    on_time += time_us == was->time_us;
+  }
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    uint64_t after_gap = cycles_at(core, now_us);
+    CHECK((after_gap >> 32) - (before_gap[core] >> 32) >= 1, "the gap did not wrap core %d's counter", core);
+  }
+  printf("ring: %d events into %d slots, the newest %u dumped, %d on time across a %d s gap\n", EVENTS, RING_EVENTS,
+         count, on_time, GAP_US / 1000000);
+}
+
+static void check_serial(void) {
+  static uint8_t bytes[sizeof(quiet.bytes)];
+  CHECK(write_file("trace.bin", quiet.bytes, quiet.len), "could not write trace.bin");
+  CHECK(dump_serial("trace.log"), "could not write trace.log");
+  size_t len = from_serial("trace.log", bytes, sizeof(bytes));
+  CHECK(len == quiet.len && memcmp(bytes, quiet.bytes, len) == 0, "serial dump of %zu bytes differs from %zu",
+        len, quiet.len);
+  printf("serial: %zu bytes, the same as the binary dump\n", len);
+}
+
+/**
+ * @brief Runs trace_decode on a file, and reads back the time it gave each
+ * event, by sequence number.
+ */
+static int decode(const char *decoder, const char *path, char *output, size_t max, int64_t *times_us) {
+  char command[512];
+  snprintf(command, sizeof(command), "%s %s", decoder, path);
+  FILE *pipe = popen(command, "r");
+  if (!pipe) return -1;
+  size_t len = fread(output, 1, max - 1, pipe);
+  output[len] = '\0';
+  if (pclose(pipe) != 0) return -1;
+  int events = 0;
+  for (char *line = strtok(output, "\n"); line; line = strtok(NULL, "\n")) {
+    double ms, delta_ms;
+    unsigned int seq, core;
+    if (sscanf(line, "%lf ms %lf ms #%u core %u", &ms, &delta_ms, &seq, &core) != 4 || seq >= 1024) continue;
+    times_us[seq] = (int64_t)(ms * 1000 + (ms < 0 ? -0.5 : 0.5));
+    events++;
+  }
+  return events;
+}
+
+static void check_decode(const char *decoder) {
+  static char from_bin[65536], from_log[65536];
+  static int64_t bin_us[1024], log_us[1024];
+  int events = decode(decoder, "trace.bin", from_bin, sizeof(from_bin), bin_us);
+  CHECK(events == RING_EVENTS, "%s decoded %d events from trace.bin", decoder, events);
+  CHECK(decode(decoder, "trace.log", from_log, sizeof(from_log), log_us) == events &&
+            memcmp(bin_us, log_us, sizeof(bin_us)) == 0,
+        "%s decoded trace.log and trace.bin differently", decoder);
+  int on_time = 0;
+  for (uint32_t seq = EVENTS - RING_EVENTS; seq < EVENTS; seq++) {
+    CHECK(bin_us[seq] == recorded[seq].time_us, "trace_decode placed #%u at %lld us, recorded at %lld us", seq,
+          (long long)bin_us[seq], (long long)recorded[seq].time_us);
+    on_time += bin_us[seq] == recorded[seq].time_us;
+  }
+  printf("decode: %d events from each file, %d on the microsecond\n", events, on_time);
+}
+
+static void check_lost(void) {
+  // the newest event is still being written, and 20 more come in while the header goes out
+  uint32_t end = head;
+  ring[(end - 1) & (RING_EVENTS - 1)].seq = SEQ_BUSY;
+  static dump_t busy = {.record_on_write = 20};
+  uint32_t count = trace_dump(to_memory, &busy);
+  CHECK(count == RING_EVENTS && get_le(busy.bytes + 12, 4) == end, "dumped %u events, %llu recorded", count,
+        (unsigned long long)get_le(busy.bytes + 12, 4));
+  int lost = 0, whole = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const trace_record_t *event = event_at(&busy, i);
+    uint32_t seq = end - RING_EVENTS + i;
+    bool overwritten = i < 20 || seq == end - 1;
+    CHECK(event->seq == seq, "event %u is #%u, not #%u", i, event->seq, seq);
+    if (overwritten) {
+      CHECK(event->id == ID_LOST && event->cycles == 0 && event->args[0] == 0, "#%u was not marked lost", seq);
+    } else {
+      CHECK(event->id == recorded[seq].id && memcmp(event->args, recorded[seq].args, sizeof(event->args)) == 0,
+            "#%u did not come out whole", seq);
+    }
+    lost += event->id == ID_LOST;
+    whole += event->id != ID_LOST;
+  }
+  CHECK(head == end + 20, "%u events recorded during the dump", head - end);
+  printf("lost: %d of %u marked lost (20 overwritten, 1 mid-write), %d whole\n", lost, count, whole);
+}
+
+static void bench(void) {
+  enum { SAMPLES = 10000000 };
+  struct timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < SAMPLES; i++) TRACE(TRACE_JOYSTICK, i, i, 0);
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  double ns = (stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec);
+  printf("ns per event: %.1f (host, -O2)\n", ns / SAMPLES);
+}
+
+int main(int argc, char **argv) {
+  check_ring();
+  check_serial();
+  check_decode(argc > 1 ? argv[1] : "./trace_decode");
+  check_lost();
+  bench();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -22,6 +22,20 @@
 #define CONFIG_PIN_JOYSTICK_VRX 6  // ANALOG 6, GPIO 34
 #define CONFIG_PIN_JOYSTICK_VRY 7  // ANALOG 7, GPIO 35
 #define CONFIG_PIN_JOYSTICK_SW -1
+// joystick ADC sampling, see adc_sampler.h
+#define CONFIG_ADC_SAMPLE_FREQ_HZ (20 * 1000)
+#define CONFIG_ADC_FRAME_CONVERSIONS 64
+#define CONFIG_ADC_OVERSAMPLE 1
+// joystick noise filtering, see axis_filter.h
+#define CONFIG_AXIS_FILTER_MEDIAN 3
+#define CONFIG_AXIS_FILTER_IIR_SHIFT 2
+#define CONFIG_AXIS_FILTER_HYSTERESIS 24
+// joystick calibration, see joystick_cal.h
+#define CONFIG_JOYSTICK_CAL_CENTRE_MS 200
+#define CONFIG_JOYSTICK_CAL_DEFAULT_SPAN_MV 1000
+// controller state reports, see report_scheduler.h
+#define CONFIG_REPORT_RATE_HZ 250
+#define CONFIG_REPORT_KEEPALIVE_MS 1000
 #define CONFIG_PIN_BUTTON_1 32
 #define CONFIG_PIN_TOUCHPAD 0  // TOUCHPAD 0, GPIO 4
 #define CONFIG_PIN_SWITCH_1 -1
@@ -10,6 +10,7 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include "mailbox.h"
 
 /* -------------------------------------------------------------------------- */
 /*                                    PINS                                    */
@@ -20,26 +21,23 @@
 // the switch is on pin 14––we can treat it as a button
 #define SWITCH_1_PIN CONFIG_PIN_SWITCH_1
 
-struct QueueDefinition;
-typedef struct QueueDefinition* QueueHandle_t;
+// set on the consumer whenever the button state changes
+#define CONTROLLER_BUTTONS_NOTIFY_BIT (1UL << 1)
 
 /* -------------------------------------------------------------------------- */
 /*                                  TEMPLATES                                 */
 /* -------------------------------------------------------------------------- */
 
-// the event handler for the controller buttons
-QueueHandle_t controller_buttons_init(void);
+// the state mailbox for the controller buttons
+mailbox_t *controller_buttons_init(void);
 
 /* -------------------------------------------------------------------------- */
 /*                                    TYPES                                   */
 /* -------------------------------------------------------------------------- */
 
-typedef struct {
-  uint8_t pin;
-} button_t;
-
 typedef struct {
   uint16_t state;
+  int64_t time_us;  // when the button change behind this state was sampled
 } controller_buttons_event_t;
 
 #endif /* __CONTROLLER_BUTTONS_H__ */
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include "mailbox.h"
 
 /* -------------------------------------------------------------------------- */
 /*                                    PINS                                    */
@@ -20,15 +21,21 @@
 #define JOYSTICK_Y_PIN CONFIG_PIN_JOYSTICK_VRY
 #define JOYSTICK_PRESS_PIN CONFIG_PIN_JOYSTICK_SW
 
-struct QueueDefinition;
-typedef struct QueueDefinition* QueueHandle_t;
+// set on the consumer whenever the joystick moves
+#define CONTROLLER_JOYSTICK_NOTIFY_BIT (1UL << 2)
+// set on the joystick task whenever the ADC has a new frame
+#define JOYSTICK_FRAME_NOTIFY_BIT (1UL << 0)
+
+// where each axis lands in the ADC sampler's frames
+#define JOYSTICK_X_SLOT 0
+#define JOYSTICK_Y_SLOT 1
 
 /* -------------------------------------------------------------------------- */
 /*                                  TEMPLATES                                 */
 /* -------------------------------------------------------------------------- */
 
-// the event handler for the controller joystick
-QueueHandle_t controller_joystick_init(void);
+// the state mailbox for the controller joystick
+mailbox_t *controller_joystick_init(void);
 
 /* -------------------------------------------------------------------------- */
 /*                                    TYPES                                   */
@@ -41,9 +48,19 @@ typedef struct {
 } joystick_t;
 
 typedef struct {
-  double xstate;
-  double ystate;
+  int16_t xstate;  // hundredths, -100..100
+  int16_t ystate;  // hundredths, -100..100
   bool pressed;
+  int64_t time_us;  // when the axes were sampled
 } controller_joystick_event_t;
 
+typedef struct {
+  uint32_t frames;      // ADC frames looked at
+  uint32_t reports;     // joystick events posted
+  uint32_t suppressed;  // frames only left unreported because of the axis filters
+} controller_joystick_stats_t;
+
+// copies out the joystick's report counters
+void controller_joystick_get_stats(controller_joystick_stats_t *stats);
+
 #endif /* __CONTROLLER_JOYSTICK_H__ */
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "esp_log.h"
 #include "driver/touch_pad.h"
 #include "stdbool.h"
+#include "mailbox.h"
 
 /* -------------------------------------------------------------------------- */
 /*                                    PINS                                    */
@@ -19,18 +20,33 @@
 
 // touchpad enters on GPIO pin 13
 #define TOUCHPAD_PIN CONFIG_PIN_TOUCHPAD
-// less than this value = touchpad pressed, higiher = touchpad unpressed
-#define TOUCHPAD_TOUCHED_THRESHOLD (500)
-
-struct QueueDefinition;
-typedef struct QueueDefinition* QueueHandle_t;
+// a touch is a reading this far below the untouched baseline, and a release a
+// climb back to within this far of it. the baseline follows slow drift, so
+// nothing here depends on the board or the weather.
+#define TOUCHPAD_TOUCH_DROP_PERCENT (33)
+#define TOUCHPAD_RELEASE_DROP_PERCENT (20)
+// how slowly the baseline follows the untouched reading: each filter period
+// moves it 1/2^shift of the way, so ~2.5 s at the 10 ms period
+#define TOUCHPAD_BASELINE_SHIFT (8)
+// software filter period, which is also how often a release can be seen
+#define TOUCHPAD_FILTER_PERIOD_MS (10)
+// filter periods in a row the raw reading must stay above the release
+// threshold before a touch ends, so one noisy read cannot end it
+#define TOUCHPAD_RELEASE_HOLD (3)
+// touch FSM timing, in 150 kHz RTC slow clock cycles between measurements
+// (~3.4 ms, down from the ~27 ms default) and 8 MHz cycles per measurement
+#define TOUCHPAD_SLEEP_CYCLES (0x200)
+#define TOUCHPAD_MEAS_CYCLES (0x7fff)
+
+// set on the consumer whenever the touchpad changes
+#define CONTROLLER_TOUCHPAD_NOTIFY_BIT (1UL << 3)
 
 /* -------------------------------------------------------------------------- */
 /*                                  TEMPLATES                                 */
 /* -------------------------------------------------------------------------- */
 
-// the event handler for the controller buttons
-QueueHandle_t controller_touchpad_init(void);
+// the state mailbox for the controller touchpad
+mailbox_t *controller_touchpad_init(void);
 
 /* -------------------------------------------------------------------------- */
 /*                                    TYPES                                   */
@@ -38,6 +54,7 @@ QueueHandle_t controller_touchpad_init(void);
 
 typedef struct {
   bool state;
+  int64_t time_us;  // when the touch change was sampled
 } controller_touchpad_event_t;
 
 #endif /* __CONTROLLER_BUTTONS_H__ */
\ No newline at end of file
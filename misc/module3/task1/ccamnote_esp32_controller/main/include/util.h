@@ -8,14 +8,34 @@
 #ifndef __UTIL_H__
 #define __UTIL_H__
 
-// rounds a function to the nearest tenth
-double nearest_tenth(double v) {
-  int c, r, m;
-  m = v * 100;
-  c = m % 10;
-  r = m / 10;
+#include <stdint.h>
+#include <stdlib.h>
+
+// joystick values are kept in fixed point, counting hundredths: 100 = 1.00.
+// the ESP32 FPU has no double precision, so this keeps soft-float off the
+// sampling path entirely.
+
+// rounds a value in hundredths to the nearest tenth (still in hundredths).
+// halves round up, and negative values truncate toward zero.
+static inline int32_t nearest_tenth(int32_t centi) {
+  int32_t c, r;
+  c = centi % 10;
+  r = centi / 10;
   if (c >= 5) r++;
-  return (double)r / 10;
+  return r * 10;
 }
 
+// turns a joystick_cal_apply position, in ten-thousandths, into the
+// hundredths the joystick reports: halved onto -0.50..0.50 truncating
+// toward zero, rounded to the nearest tenth, and doubled back, so the
+// report moves in steps of 0.20.
+static inline int32_t axis_to_centi(int32_t axis) {
+  return nearest_tenth(axis / 200) * 2;
+}
+
+// prints a value in hundredths the way "%.2f" would print it as a float:
+//   printf("x: " CENTI_FMT, CENTI_ARGS(x));
+#define CENTI_FMT "%s%d.%02d"
+#define CENTI_ARGS(v) ((v) < 0 ? "-" : ""), abs(v) / 100, abs(v) % 100
+
 #endif /* __UTIL_H__ */
\ No newline at end of file
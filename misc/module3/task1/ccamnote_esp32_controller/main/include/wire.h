@@ -0,0 +1,82 @@
+/*
+ * wire.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef __WIRE_H__
+#define __WIRE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   FORMAT                                   */
+/* -------------------------------------------------------------------------- */
+
+// the wire formats a controller can speak. JSON is what every server
+// understands; the binary ones are only used once the server has picked one
+// in reply to the controller's client_type message.
+#define WIRE_JSON (0)
+#define WIRE_BINARY_V1 (1)
+
+// the first byte of every binary frame: version in the high nibble, frame
+// kind in the low one. trace frames carry a stretch of a trace dump (see
+// trace.h) right after the header byte, and only go out when asked for
+#define WIRE_KIND_STATE (0x1)
+#define WIRE_KIND_TRACE (0x2)
+#define WIRE_HEADER(version, kind) ((uint8_t)(((version) << 4) | (kind)))
+
+// a WIRE_BINARY_V1 controller state frame, all fields little-endian:
+//
+//   offset  size  field
+//   0       1     header, WIRE_HEADER(1, WIRE_KIND_STATE) = 0x11
+//   1       1     flags, WIRE_FLAG_*
+//   2       2     sequence number, +1 per frame, wraps
+//   4       2     button bitmask
+//   6       2     joystick x, signed hundredths (-100..100)
+//   8       2     joystick y, signed hundredths (-100..100)
+//   10      4     low 32 bits of esp_timer_get_time() when the oldest input was sampled
+#define WIRE_STATE_V1_SIZE (14)
+
+#define WIRE_FLAG_JUST_PRESSED (1 << 0)       // button 1 went down in this frame
+#define WIRE_FLAG_TOUCHPAD (1 << 1)           // touchpad held
+#define WIRE_FLAG_TOUCHPAD_CHANGED (1 << 2)   // touchpad changed in this frame
+#define WIRE_FLAG_JOYSTICK_PRESSED (1 << 3)   // joystick pushed in
+
+// the same state as WIRE_JSON, which every server understands. its longest
+// possible form, and so the buffer a JSON state always fits in (NUL included):
+#define WIRE_STATE_JSON_MAX_SIZE \
+  (sizeof("{\"type\":\"controller_state\",\"t\":-9223372036854775808,\"data\":[-327.68, -327.68, 65535, false, 1, false]}"))
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  int16_t joystick_xstate;  // hundredths
+  int16_t joystick_ystate;  // hundredths
+  uint16_t buttons;
+  uint8_t flags;            // WIRE_FLAG_*
+  int64_t time_us;          // when the oldest input in this state was sampled
+} wire_state_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// encodes a WIRE_BINARY_V1 state frame into `buf`, returning its length (0 if it does not fit)
+size_t wire_encode_state(uint8_t *buf, size_t len, uint16_t seq, const wire_state_t *state);
+// encodes a WIRE_JSON state into `buf`, NUL-terminated, returning its length
+// without the NUL (0 if `len` is under WIRE_STATE_JSON_MAX_SIZE)
+size_t wire_encode_state_json(char *buf, size_t len, const wire_state_t *state);
+
+// wire_encode_state_json into a char array, failing the build if the array
+// could ever be too small
+#define WIRE_ENCODE_STATE_JSON(array, state) ({                                            \
+  _Static_assert(sizeof(array) >= WIRE_STATE_JSON_MAX_SIZE, "too small for a JSON state"); \
+  wire_encode_state_json((array), sizeof(array), (state));                                 \
+})
+
+#endif /* __WIRE_H__ */
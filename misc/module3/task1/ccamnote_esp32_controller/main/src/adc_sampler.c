@@ -0,0 +1,179 @@
+/*
+ * adc_sampler.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/adc.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "adc_sampler.h"
+
+// our tag for ESP Info logging
+static const char *TAG = "ADC Sampler";
+
+// bytes of DMA data per frame
+#define FRAME_BYTES (CONFIG_ADC_FRAME_CONVERSIONS * SOC_ADC_DIGI_RESULT_BYTES)
+// frames between two timing reports in the debug log
+#define STATS_LOG_FRAMES (1024)
+
+// where each ADC1 channel lands in adc_frame_t.raw, plus one. 0 = not sampled
+static uint8_t channel_slot[ADC1_CHANNEL_MAX];
+// the mailbox frames are posted to
+static mailbox_t *frames;
+// timing statistics, only written by the sampler task
+static adc_sampler_stats_t stats;
+
+/* ---------------------------- SAMPLER TASK ---------------------------- */
+
+/**
+ * @brief Folds one frame's arrival time into the timing statistics.
+ *
+ * @param now_us When the frame arrived.
+ */
+static void note_frame_time(int64_t now_us) {
+  static int64_t start_us = 0, last_us = 0;
+  if (last_us == 0) {
+    start_us = last_us = now_us;
+    return;
+  }
+  int32_t jitter = (int32_t)(now_us - last_us) - (int32_t)stats.period_us;
+  if (stats.frames == 2 || jitter < stats.jitter_min_us) stats.jitter_min_us = jitter;
+  if (stats.frames == 2 || jitter > stats.jitter_max_us) stats.jitter_max_us = jitter;
+  stats.rate_hz = (uint32_t)((uint64_t)stats.conversions * 1000000 / (now_us - start_us));
+  last_us = now_us;
+}
+
+/**
+ * @brief Turns DMA blocks into frames.
+ *
+ * Sleeps inside adc_digi_read_bytes until the DMA engine has a block ready, so
+ * the CPU never polls the ADC. Each block becomes one frame holding the mean
+ * (or, without CONFIG_ADC_OVERSAMPLE, the newest) reading of every channel.
+ *
+ * @param pvParameter Placeholder values to pass into the task function (unused)
+ */
+static void adc_sampler_task(void *pvParameter) {
+  static uint8_t block[FRAME_BYTES];
+  adc_frame_t frame = {0};
+  while (true) {
+    uint32_t length = 0;
+    esp_err_t err = adc_digi_read_bytes(block, sizeof(block), &length, ADC_MAX_DELAY);
+    int64_t now_us = esp_timer_get_time();
+    if (err == ESP_ERR_INVALID_STATE) {
+      // the pool overflowed because we fell behind, but the block is still good
+      stats.overruns++;
+    } else if (err != ESP_OK) {
+      continue;
+    }
+
+    uint32_t sum[ADC_SAMPLER_MAX_CHANNELS] = {0};
+    uint16_t readings[ADC_SAMPLER_MAX_CHANNELS] = {0};
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+      adc_digi_output_data_t *out = (adc_digi_output_data_t *)&block[i];
+      uint32_t channel = out->type1.channel;
+      if (channel < ADC1_CHANNEL_MAX && channel_slot[channel]) {
+        uint8_t slot = channel_slot[channel] - 1;
+        sum[slot] += out->type1.data;
+        readings[slot]++;
+        frame.raw[slot] = out->type1.data;
+      }
+      stats.conversions++;
+    }
+    // oversample: swap the newest reading for the rounded mean of the block
+    for (uint8_t slot = 0; CONFIG_ADC_OVERSAMPLE && slot < ADC_SAMPLER_MAX_CHANNELS; slot++) {
+      if (readings[slot]) frame.raw[slot] = (sum[slot] + readings[slot] / 2) / readings[slot];
+    }
+    frame.time_us = now_us;
+    frame.seq++;
+    stats.frames++;
+    note_frame_time(now_us);
+    mailbox_post(frames, &frame);
+
+    if (stats.frames % STATS_LOG_FRAMES == 0) {
+      ESP_LOGD(TAG, "%u Hz, jitter %d..%d us, %u overruns", stats.rate_hz, stats.jitter_min_us,
+               stats.jitter_max_us, stats.overruns);
+    }
+  }
+}
+
+/* ---------------------------- PUBLIC INTERFACE ---------------------------- */
+
+/**
+ * @brief Starts hardware-timed sampling of a set of ADC1 channels.
+ *
+ * ADC1 is configured once, for 12-bit readings at 11 dB attenuation, and then
+ * run in continuous mode: the digital controller steps through the channels
+ * at CONFIG_ADC_SAMPLE_FREQ_HZ and DMAs the results into memory on its own.
+ * ADC1 is used because ADC2 is shared with the Wi-Fi driver.
+ *
+ * @param channels The ADC1 channels to sample.
+ * @param count How many channels there are, at most ADC_SAMPLER_MAX_CHANNELS.
+ * @param notify_bits The task notification bits a new frame sets on its consumer.
+ * @return mailbox_t* - The mailbox frames are posted to, or NULL on failure.
+ */
+mailbox_t *adc_sampler_start(const adc1_channel_t *channels, size_t count, uint32_t notify_bits) {
+  if (frames != NULL) return frames;
+  if (count == 0 || count > ADC_SAMPLER_MAX_CHANNELS) return NULL;
+
+  // build the conversion pattern and the channel -> slot lookup
+  adc_digi_pattern_config_t pattern[ADC_SAMPLER_MAX_CHANNELS] = {0};
+  uint32_t channel_mask = 0;
+  for (size_t i = 0; i < count; i++) {
+    pattern[i].atten = ADC_ATTEN_DB_11;  // ADC_ATTEN_DB_11 = 0-3,6V
+    pattern[i].channel = channels[i];
+    pattern[i].unit = 0;  // ADC1
+    pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    channel_slot[channels[i]] = i + 1;
+    channel_mask |= (1 << channels[i]);
+  }
+
+  adc_digi_init_config_t init_config = {
+      .max_store_buf_size = FRAME_BYTES * 4,
+      .conv_num_each_intr = FRAME_BYTES,
+      .adc1_chan_mask = channel_mask,
+      .adc2_chan_mask = 0,
+  };
+  adc_digi_configuration_t digi_config = {
+      .conv_limit_en = 1,  // required on the ESP32
+      .conv_limit_num = 250,
+      .pattern_num = count,
+      .adc_pattern = pattern,
+      .sample_freq_hz = CONFIG_ADC_SAMPLE_FREQ_HZ,
+      .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+      .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+  };
+
+  esp_err_t err;
+  if ((err = adc_digi_initialize(&init_config)) != ESP_OK ||
+      (err = adc_digi_controller_configure(&digi_config)) != ESP_OK ||
+      (err = adc_digi_start()) != ESP_OK) {
+    ESP_LOGE(TAG, "failed to start continuous sampling: %s", esp_err_to_name(err));
+    adc_digi_deinitialize();
+    return NULL;
+  }
+  if ((frames = mailbox_create(sizeof(adc_frame_t), notify_bits)) == NULL) {
+    adc_digi_stop();
+    adc_digi_deinitialize();
+    return NULL;
+  }
+
+  stats.period_us = (uint64_t)CONFIG_ADC_FRAME_CONVERSIONS * 1000000 / CONFIG_ADC_SAMPLE_FREQ_HZ;
+  ESP_LOGI(TAG, "sampling %d channels at %d Hz, a frame every %u us", (int)count, CONFIG_ADC_SAMPLE_FREQ_HZ, stats.period_us);
+  xTaskCreate(adc_sampler_task, "adc_sampler_task", 2048, NULL, 5, NULL);
+  return frames;
+}
+
+/**
+ * @brief Copies out the sampler's rate and jitter measurements.
+ *
+ * @param out Where to copy the statistics.
+ */
+void adc_sampler_get_stats(adc_sampler_stats_t *out) {
+  *out = stats;
+}
@@ -0,0 +1,112 @@
+/*
+ * axis_filter.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <string.h>
+
+#include "axis_filter.h"
+
+/* ------------------------------ FILTER STAGES ----------------------------- */
+
+/**
+ * @brief Takes the median of the filter's window after adding a reading.
+ *
+ * Knocks out single-reading spikes that an average would smear across the
+ * following frames. Until the window has filled, the median is taken over
+ * the readings seen so far.
+ *
+ * @param filter The filter.
+ * @param raw The newest reading.
+ * @return uint16_t - The median reading.
+ */
+static uint16_t median_stage(axis_filter_t *filter, uint16_t raw) {
+  filter->window[filter->next] = raw;
+  filter->next = (filter->next + 1) % filter->config.median;
+  if (filter->filled < filter->config.median) filter->filled++;
+
+  // insertion sort a copy, the window is never more than a handful long
+  uint16_t sorted[AXIS_FILTER_MAX_MEDIAN];
+  for (uint8_t i = 0; i < filter->filled; i++) {
+    uint16_t value = filter->window[i];
+    uint8_t j = i;
+    for (; j > 0 && sorted[j - 1] > value; j--) sorted[j] = sorted[j - 1];
+    sorted[j] = value;
+  }
+  return sorted[filter->filled / 2];
+}
+
+/**
+ * @brief Runs a reading through the one-pole IIR low-pass.
+ *
+ * The state is kept scaled up by 2^iir_shift so that the fraction the shift
+ * would otherwise throw away keeps accumulating.
+ *
+ * @param filter The filter.
+ * @param value The reading coming out of the median.
+ * @return uint16_t - The smoothed reading.
+ */
+static uint16_t iir_stage(axis_filter_t *filter, uint16_t value) {
+  uint8_t shift = filter->config.iir_shift;
+  if (!filter->primed) {
+    filter->smooth = (int32_t)value << shift;
+  } else {
+    filter->smooth += value - ((filter->smooth + (1 << shift >> 1)) >> shift);
+  }
+  return (uint16_t)((filter->smooth + (1 << shift >> 1)) >> shift);
+}
+
+/* ---------------------------- PUBLIC INTERFACE ---------------------------- */
+
+/**
+ * @brief Resets an axis filter.
+ *
+ * An even median window is grown by one, and one longer than the filter can
+ * hold is cut down to AXIS_FILTER_MAX_MEDIAN.
+ *
+ * @param filter The filter to reset.
+ * @param config Its median, IIR and hysteresis settings.
+ */
+void axis_filter_init(axis_filter_t *filter, const axis_filter_config_t *config) {
+  memset(filter, 0, sizeof(*filter));
+  filter->config = *config;
+  if (filter->config.median == 0) filter->config.median = 1;
+  if (filter->config.median % 2 == 0) filter->config.median++;
+  if (filter->config.median > AXIS_FILTER_MAX_MEDIAN) filter->config.median = AXIS_FILTER_MAX_MEDIAN;
+  if (filter->config.iir_shift > 8) filter->config.iir_shift = 8;
+}
+
+/**
+ * @brief Feeds one reading through the median, IIR and hysteresis stages.
+ *
+ * The output only moves once the smoothed reading has drifted more than
+ * `hysteresis` counts away from it, so a stick at rest hands out the same
+ * value frame after frame. The ends of the range always come through, so
+ * full deflection is still reachable.
+ *
+ * @param filter The filter.
+ * @param raw The 12-bit reading.
+ * @return uint16_t - The filtered reading.
+ */
+uint16_t axis_filter_update(axis_filter_t *filter, uint16_t raw) {
+  uint16_t value = raw;
+  if (filter->config.median > 1) value = median_stage(filter, value);
+  if (filter->config.iir_shift > 0) value = iir_stage(filter, value);
+
+  filter->stats.readings++;
+  if (!filter->primed) {
+    filter->primed = true;
+    filter->output = value;
+    return value;
+  }
+  int32_t moved = (int32_t)value - filter->output;
+  if (moved > filter->config.hysteresis || -moved > filter->config.hysteresis ||
+      (moved != 0 && (value == 0 || value == AXIS_FILTER_MAX_READING))) {
+    filter->output = value;
+    filter->stats.changes++;
+  } else if (raw != filter->output) {
+    filter->stats.held++;
+  }
+  return filter->output;
+}
@@ -8,13 +8,12 @@
 #include <stdlib.h>
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
-#include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 
 #include "controller_buttons.h"
 #include "button.h"
+#include "trace.h"
 
 // our tag for ESP Info logging
 #define CONTROLLER_BUTTONS_TAG "CCAMNotary Buttons"
@@ -24,72 +23,51 @@
 // button maps for easy button reference
 #define BUTTON_SELECT (PIN_BIT(BUTTON_1_PIN) | PIN_BIT(SWITCH_1_PIN))
 
-static const button_t button_idx_map[] = {
-    [0] { BUTTON_1_PIN },
-    [1] { SWITCH_1_PIN }};
-static const size_t button_idx_map_length = sizeof(button_idx_map) / sizeof(button_t);
+// the bit each pin sets in the button state, resolved at compile time
+static const uint8_t button_bits[BUTTON_PIN_BITS_SIZE] = {
+    BUTTON_PIN_BIT_SLOT(BUTTON_1_PIN, 0),
+    BUTTON_PIN_BIT_SLOT(SWITCH_1_PIN, 1)};
 
 /* ------------------------------ BUTTON EVENTS ----------------------------- */
 
-// handle a global state for the button queue
-static QueueHandle_t queue;
+// handle a global state for the button mailbox
+static mailbox_t *mailbox;
 
 /**
- * @brief Sends a button event to the larger event queue.
+ * @brief Posts the button state to the controller mailbox.
+ *
+ * Called by the button scanner itself whenever the debounced state changes,
+ * so it must not block.
  *
  * @param state The state of all buttons, encoded as a binary number.
+ * @param time_us When the button change behind the state was sampled.
+ * @param arg Placeholder for the state callback argument (unused)
  */
-static void send_event(uint16_t state) {
+static void send_event(uint32_t state, int64_t time_us, void *arg) {
   controller_buttons_event_t event = {
-      .state = state};
-  xQueueSend(queue, &event, 1000 / portTICK_PERIOD_MS);
+      .state = state,
+      .time_us = time_us};
+  TRACE(TRACE_BUTTONS_STATE, event.state);
+  mailbox_post(mailbox, &event);
 }
 
 /**
- * @brief Polls for button events.
+ * @brief Creates the mailbox holding the controller button state
  *
- * Continually emits the total state of all buttons initialized in `controller_buttons.c`,
- * listening to button events from the button queue.
+ * The buttons publish their combined state straight into the mailbox, without
+ * a task of their own in between.
  *
- * @param pvParameter Placeholder values to pass into the task function (unused)
+ * @return mailbox_t* - The button state mailbox
  */
-static void controller_buttons_task(void *pvParameter) {
-  printf("button_idx_map_length: %d\n", button_idx_map_length);
-  button_event_t ev;
-  QueueHandle_t button_events = button_init(BUTTON_SELECT);
-  uint16_t button_state = 0;       // current buttons inputs
-  uint16_t last_button_state = 0;  // previous button inputs
-  while (true) {
-    // attempt to read an event from the button queue into ev
-    if (xQueueReceive(button_events, &ev, 1000 / portTICK_PERIOD_MS)) {
-      // if successful, search for the matching button pin
-      for (int i = 0; i < button_idx_map_length; i++) {
-        if (button_idx_map[i].pin == ev.pin) {
-          // log the button event, and update button state
-          ESP_LOGI(CONTROLLER_BUTTONS_TAG, "button pin: %d event: %d idx: %d", ev.pin, ev.event, i);
-          if (ev.event == BUTTON_UP) {
-            button_state &= ~(1 << i);
-          } else {
-            button_state |= (1 << i);
-          }
-        }
-      }
-      // emit the button event to the main queue if the button state has changed
-      if (button_state != last_button_state) {
-        send_event(button_state);
-        last_button_state = button_state;
-      }
-    }
+mailbox_t *controller_buttons_init(void) {
+  mailbox = mailbox_create(sizeof(controller_buttons_event_t), CONTROLLER_BUTTONS_NOTIFY_BIT);
+  button_group_config_t config = BUTTON_GROUP_CONFIG_DEFAULT();
+  config.pin_select = BUTTON_SELECT;
+  config.queue_size = 0;
+  config.pin_bits = button_bits;
+  config.on_state = send_event;
+  if (button_group_create(&config) == NULL) {
+    ESP_LOGE(CONTROLLER_BUTTONS_TAG, "failed to start the buttons");
   }
+  return mailbox;
 }
-
-/**
- * @brief Creates the queue for handling controller button inputs
- *
- * @return QueueHandle_t* - The handle of the queue
- */
-QueueHandle_t controller_buttons_init(void) {
-  queue = xQueueCreate(4, sizeof(controller_buttons_event_t));
-  xTaskCreate(controller_buttons_task, "button_task", 2048, NULL, 4, NULL);
-  return queue;
-}
\ No newline at end of file
@@ -8,106 +8,144 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <inttypes.h>
-#include <math.h>
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 #include "freertos/task.h"
-#include "driver/adc.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 
+#include "adc_sampler.h"
+#include "axis_filter.h"
 #include "controller_joystick.h"
+#include "joystick_cal.h"
+#include "trace.h"
 #include "util.h"
 
 // our tag for EPS Info logging
 #define CONTROLLER_JOYSTICK_TAG "CCAMNotary Joystick"
 
-// this is how much the joystick needs to change by to be registered as an event
-#define JOYSTICK_DEADZONE 0.05
+// this is how much the joystick needs to change by to be registered as an event, in hundredths
+#define JOYSTICK_DEADZONE 5
 
-// handle a global state for the joystick queue
-static QueueHandle_t queue;
+// handle a global state for the joystick mailbox
+static mailbox_t *mailbox;
+// the ADC frames the joystick axes are read from
+static mailbox_t *frames;
+// the calibration of each axis, only used by the joystick task after init
+static joystick_cal_t cal_x, cal_y;
+// report counters, only written by the joystick task
+static controller_joystick_stats_t stats;
+// frames between two report counter lines in the debug log
+#define STATS_LOG_FRAMES (1024)
 
 /**
- * @brief Sends a joystick event to the larger event queue.
+ * @brief Posts a joystick event to the controller mailbox.
  *
  * @param state The state of the joystick
  */
 static void send_event(controller_joystick_event_t event) {
-  xQueueSend(queue, &event, 1000 / portTICK_PERIOD_MS);
+  mailbox_post(mailbox, &event);
 }
 
 /**
- * @brief Reads analog joystick input from an ADC channel.
- *
- * The ESP32 integrates two 12-bit SAR (Successive Approximation Register) ADCs,
- * supporting a total of 18 measurement channels (analog enabled pins).
- *
- * The ADC driver API supports ADC1 (8 channels, attached to GPIOs 32 - 39), and
- * ADC2 (10 channels, attached to GPIOs 0, 2, 4, 12 - 15 and 25 - 27). However,
- * the usage of ADC2 has some restrictions for the application:
- *
- * 1. ADC2 is used by the Wi-Fi driver. Therefore the application can only use
- *      ADC2 when the Wi-Fi driver has not started.
- * 2. Some of the ADC2 pins are used as strapping pins (GPIO 0, 2, 15) thus
- *      cannot be used freely.
- *
- * @param channel The input ADC channel.
- * @return uint8_t - The analog input (0-255) to the channel.
- */
-static uint8_t readJoystickChannel(adc1_channel_t channel) {
-  adc1_config_width(ADC_WIDTH_BIT_10);                  // Range 0-1023
-  adc1_config_channel_atten(channel, ADC_ATTEN_DB_11);  // ADC_ATTEN_DB_11 = 0-3,6V
-  return (uint8_t)(adc1_get_raw(channel) >> 2);         // Read analog and shift to 0-255
-}
-
-/**
- * @brief Polls for joystick events.
+ * @brief Turns ADC frames into joystick events.
  *
  * Continually emits the state of the joystick initialized in `controller_joystick.c`,
- * producing an X value, Y value, and press value.
+ * producing an X value, Y value, and press value. Wakes once per frame from
+ * the ADC sampler, which reads both axes at 12 bits on a hardware timer.
+ *
+ * Each axis goes through an axis filter before the deadzone check, so ADC
+ * noise on a stick at rest does not turn into a stream of reports. Frames
+ * whose unfiltered readings would have been reported, but whose filtered
+ * ones were not, are counted as suppressed. The filtered readings also
+ * feed the axis calibration, which centres and scales them through a LUT.
  *
  * @param pvParameter Placeholder values to pass into the task function (unused)
  */
 static void controller_joystick_task(void *pvParameter) {
-  // keep track of joystick state and previous.
-  double js_x, js_y;
-  double last_js_x = 0, last_js_y = 0;
+  // keep track of joystick state and previous, in hundredths.
+  int32_t js_x, js_y;
+  int32_t last_js_x = 0, last_js_y = 0;
+  // and the filters that sit between the ADC and the deadzone
+  axis_filter_t filter_x, filter_y;
+  axis_filter_config_t filter_config = AXIS_FILTER_CONFIG_DEFAULT();
+  axis_filter_init(&filter_x, &filter_config);
+  axis_filter_init(&filter_y, &filter_config);
 
   controller_joystick_event_t ev;
+  adc_frame_t frame;
   while (true) {
-    // read in joystick axis input from the ESP32 ADC channels they're set to.
-    double steps = 0xFF;
-    js_x = nearest_tenth(readJoystickChannel(JOYSTICK_X_PIN) / steps - 0.5) * 2;
-    js_y = nearest_tenth(readJoystickChannel(JOYSTICK_Y_PIN) / steps - 0.5) * 2;
+    // wait for the sampler's next frame of joystick axis input
+    mailbox_wait(frames, &frame, portMAX_DELAY);
+    int64_t sampled_us = frame.time_us;
+    uint16_t raw_x = frame.raw[JOYSTICK_X_SLOT];
+    uint16_t raw_y = frame.raw[JOYSTICK_Y_SLOT];
+    uint16_t filtered_x = axis_filter_update(&filter_x, raw_x);
+    uint16_t filtered_y = axis_filter_update(&filter_y, raw_y);
+    joystick_cal_track(&cal_x, filtered_x, sampled_us);
+    joystick_cal_track(&cal_y, filtered_y, sampled_us);
+    js_x = axis_to_centi(joystick_cal_apply(&cal_x, filtered_x));
+    js_y = axis_to_centi(joystick_cal_apply(&cal_y, filtered_y));
+
+    if (++stats.frames % STATS_LOG_FRAMES == 0) {
+      ESP_LOGD(CONTROLLER_JOYSTICK_TAG, "%u reports, %u suppressed, held x: %u, y: %u", stats.reports,
+               stats.suppressed, filter_x.stats.held, filter_y.stats.held);
+    }
 
     // once joystick has changed significantly since last event
-    if (fabs(js_x - last_js_x) > JOYSTICK_DEADZONE || fabs(js_y - last_js_y) > JOYSTICK_DEADZONE) {
+    if (abs(js_x - last_js_x) > JOYSTICK_DEADZONE || abs(js_y - last_js_y) > JOYSTICK_DEADZONE) {
       // transmit the event object
       ev.xstate = js_x;
       ev.ystate = js_y;
       ev.pressed = false;
+      ev.time_us = sampled_us;
       send_event(ev);
+      stats.reports++;
       // and save the js_x and js_y into the previous values
       last_js_x = js_x;
       last_js_y = js_y;
-      // log the button event, and update button state
-      ESP_LOGI(CONTROLLER_JOYSTICK_TAG, "[joystick] x: %0.2f, y: %0.2f, pressed: %d", ev.xstate, ev.ystate, ev.pressed);
+      // trace the joystick event
+      TRACE(TRACE_JOYSTICK, ev.xstate, ev.ystate, ev.pressed);
+    } else {
+      // count the frames that only stayed quiet because of the filters
+      int32_t unfiltered_x = axis_to_centi(joystick_cal_apply(&cal_x, raw_x));
+      int32_t unfiltered_y = axis_to_centi(joystick_cal_apply(&cal_y, raw_y));
+      if (abs(unfiltered_x - last_js_x) > JOYSTICK_DEADZONE || abs(unfiltered_y - last_js_y) > JOYSTICK_DEADZONE) {
+        stats.suppressed++;
+      }
     }
-
-    // delay for 10ms so other things can use thread
-    vTaskDelay(10 / portTICK_PERIOD_MS);
   }
 }
 
 /**
- * @brief Initializes the controller input queue.
+ * @brief Initializes the joystick state mailbox and begins sampling.
+ *
+ * Needs NVS to be initialized, to load the axis calibrations.
  *
- * @return esp_err_t - An OK signal indicating the controller queue is now running.
+ * @return mailbox_t* - The joystick state mailbox
  */
-QueueHandle_t controller_joystick_init(void) {
-  queue = xQueueCreate(4, sizeof(controller_joystick_event_t));
+mailbox_t *controller_joystick_init(void) {
+  static const adc1_channel_t channels[] = {
+      [JOYSTICK_X_SLOT] = JOYSTICK_X_PIN,
+      [JOYSTICK_Y_SLOT] = JOYSTICK_Y_PIN};
+  mailbox = mailbox_create(sizeof(controller_joystick_event_t), CONTROLLER_JOYSTICK_NOTIFY_BIT);
+  // the sticks should be at rest now, while their centres are measured
+  joystick_cal_init(&cal_x, "x");
+  joystick_cal_init(&cal_y, "y");
+  frames = adc_sampler_start(channels, sizeof(channels) / sizeof(channels[0]), JOYSTICK_FRAME_NOTIFY_BIT);
+  if (frames == NULL) {
+    ESP_LOGE(CONTROLLER_JOYSTICK_TAG, "failed to start the joystick ADC");
+    return mailbox;
+  }
   xTaskCreate(controller_joystick_task, "joystick_task", 2048, NULL, 4, NULL);
-  return queue;
-}
\ No newline at end of file
+  return mailbox;
+}
+
+/**
+ * @brief Copies out how many frames were reported and how many the filters suppressed.
+ *
+ * @param out Where to copy the counters.
+ */
+void controller_joystick_get_stats(controller_joystick_stats_t *out) {
+  *out = stats;
+}
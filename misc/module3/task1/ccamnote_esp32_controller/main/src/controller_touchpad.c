@@ -8,72 +8,201 @@
 #include <stdlib.h>
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "controller_touchpad.h"
+#include "trace.h"
 
 #define TOUCH_THRESH_NO_USE (0)
 
+// set on the touchpad task by the touch ISR, and by the filter once the pad is let go
+#define TOUCH_PRESS_NOTIFY_BIT (1UL << 0)
+#define TOUCH_RELEASE_NOTIFY_BIT (1UL << 1)
+
 // our tag for ESP Info logging
 static const char* TAG = "CCAMNotary Touchpad";
 
 /* ------------------------------ BUTTON EVENTS ----------------------------- */
 
-// handle a global state for the touchpad queue
-static QueueHandle_t queue;
+// handle a global state for the touchpad mailbox
+static mailbox_t *mailbox;
+// the task touch edges are handed to
+static TaskHandle_t touchpad_task;
+
+// untouched reading, tracked by the filter, scaled up by 2^TOUCHPAD_BASELINE_SHIFT
+static uint32_t baseline;
+// the hardware touch threshold, and the reading the pad has to climb back over to release
+static uint16_t touch_thresh, release_thresh;
+// whether the pad is held, set by the ISR and cleared by the filter
+static volatile bool touched = false;
+// when the last press and release were seen
+static volatile int64_t press_us, release_us;
 
 /**
- * @brief Sends a button event to the larger event queue.
+ * @brief Posts a touchpad event to the controller mailbox.
  *
  * @param state The state of all buttons, encoded as a binary number.
+ * @param time_us When the touchpad was read.
  */
-static void send_event(bool state) {
+static void send_event(bool state, int64_t time_us) {
   controller_touchpad_event_t event = {
-      .state = state};
-  xQueueSend(queue, &event, 1000 / portTICK_PERIOD_MS);
+      .state = state,
+      .time_us = time_us};
+  TRACE(TRACE_TOUCHPAD, state);
+  mailbox_post(mailbox, &event);
+}
+
+/* -------------------------------- THRESHOLDS ------------------------------ */
+
+/**
+ * @brief Derives the touch and release thresholds from the baseline.
+ *
+ * A touch is a drop of TOUCHPAD_TOUCH_DROP_PERCENT below the untouched
+ * reading, and a release a climb back to within TOUCHPAD_RELEASE_DROP_PERCENT
+ * of it. The hardware threshold is only rewritten when it actually moves.
+ */
+static void set_thresholds(void) {
+  uint32_t untouched = baseline >> TOUCHPAD_BASELINE_SHIFT;
+  uint16_t thresh = untouched * (100 - TOUCHPAD_TOUCH_DROP_PERCENT) / 100;
+  release_thresh = untouched * (100 - TOUCHPAD_RELEASE_DROP_PERCENT) / 100;
+  if (thresh != touch_thresh) {
+    touch_thresh = thresh;
+    touch_pad_set_thresh(TOUCHPAD_PIN, thresh);
+  }
+}
+
+/**
+ * @brief Tracks the baseline and watches for the pad being let go.
+ *
+ * Called by the touch driver every time its software filter runs, from the
+ * filter's own timer, so neither keeps the touchpad task awake. While the pad
+ * is untouched, the filtered reading slowly pulls the baseline (and with it
+ * both thresholds) along as humidity and temperature drift. While it is
+ * touched, the baseline is frozen and the reading is watched for a release.
+ *
+ * The release is judged on the raw reading, held above the release threshold
+ * for TOUCHPAD_RELEASE_HOLD periods. The filtered one lags: right after the
+ * ISR fires it still reads untouched, and right after a release it still
+ * reads low. For the same reason the baseline only moves while both readings
+ * are above the release threshold, so neither the start nor the end of a
+ * touch drags it down.
+ *
+ * @param raw The raw reading of every pad.
+ * @param filtered The filtered reading of every pad.
+ */
+static void touchpad_filter_cb(uint16_t *raw, uint16_t *filtered) {
+  static uint8_t release_hold = 0;
+  static int64_t above_us;
+  uint16_t value = filtered[TOUCHPAD_PIN];
+  if (touched) {
+    if (raw[TOUCHPAD_PIN] <= release_thresh) {
+      release_hold = 0;
+    } else if (release_hold++ == 0) {
+      // stamp the release with the first read above, not the last
+      above_us = esp_timer_get_time();
+    }
+    if (release_hold >= TOUCHPAD_RELEASE_HOLD) {
+      release_hold = 0;
+      touched = false;
+      release_us = above_us;
+      xTaskNotify(touchpad_task, TOUCH_RELEASE_NOTIFY_BIT, eSetBits);
+      // ready for the next press
+      touch_pad_clear_status();
+      touch_pad_intr_enable();
+    }
+  } else if (value > release_thresh && raw[TOUCHPAD_PIN] > release_thresh) {
+    baseline += (int32_t)value - (int32_t)((baseline + (1 << TOUCHPAD_BASELINE_SHIFT >> 1)) >> TOUCHPAD_BASELINE_SHIFT);
+    set_thresholds();
+  }
+}
+
+/**
+ * @brief Catches the start of a touch.
+ *
+ * The touch FSM compares every measurement against the threshold in
+ * hardware, and keeps interrupting for as long as the pad reads below it, so
+ * the interrupt is switched off until the filter sees the pad let go.
+ *
+ * @param arg Placeholder for the ISR argument (unused)
+ */
+static void touchpad_isr(void* arg) {
+  uint32_t status = touch_pad_get_status();
+  touch_pad_clear_status();
+  if (!(status & (1 << TOUCHPAD_PIN))) return;
+  touch_pad_intr_disable();
+  touched = true;
+  press_us = esp_timer_get_time();
+  BaseType_t woken = pdFALSE;
+  xTaskNotifyFromISR(touchpad_task, TOUCH_PRESS_NOTIFY_BIT, eSetBits, &woken);
+  if (woken) portYIELD_FROM_ISR();
 }
 
+/* ------------------------------ TOUCHPAD TASK ----------------------------- */
+
 /**
- * @brief Polls for touchpad events.
+ * @brief Publishes touch edges as they arrive.
+ *
+ * Sleeps until the ISR or the filter hands it an edge, so an idle touchpad
+ * never wakes it.
  *
  * @param pvParameter Placeholder values to pass into the task function (unused)
  */
 static void controller_touchpad_task(void* pvParameter) {
-  uint16_t touch_filter_value;
   bool touch_pad_state = false;
+  uint32_t edges;
 
   while (true) {
-    // read the value from the touchpad
-    touch_pad_read_filtered(TOUCHPAD_PIN, &touch_filter_value);
-    if ((touch_filter_value < TOUCHPAD_TOUCHED_THRESHOLD) != touch_pad_state) {
-      touch_pad_state = !touch_pad_state;
-      send_event(touch_pad_state);
+    xTaskNotifyWait(0, TOUCH_PRESS_NOTIFY_BIT | TOUCH_RELEASE_NOTIFY_BIT, &edges, portMAX_DELAY);
+    // a tap shorter than a filter period shows up as both edges at once
+    if ((edges & TOUCH_PRESS_NOTIFY_BIT) && !touch_pad_state) {
+      touch_pad_state = true;
+      send_event(true, press_us);
+    }
+    if ((edges & TOUCH_RELEASE_NOTIFY_BIT) && touch_pad_state) {
+      touch_pad_state = false;
+      send_event(false, release_us);
     }
-    // delay the task 20ms to free up resources
-    vTaskDelay(20 / portTICK_PERIOD_MS);
   }
 }
 
 /**
- * @brief Creates the queue for handling controller button inputs
+ * @brief Creates the mailbox holding the touchpad state
  *
- * @return QueueHandle_t* - The handle of the queue
+ * Measures the untouched pad once to seed the baseline, so this must run
+ * while nobody is touching it.
+ *
+ * @return mailbox_t* - The touchpad state mailbox
  */
-QueueHandle_t controller_touchpad_init(void) {
-  // initialize the touch pad
+mailbox_t *controller_touchpad_init(void) {
+  // create the touchpad state mailbox, and the task touches are handed to
+  mailbox = mailbox_create(sizeof(controller_touchpad_event_t), CONTROLLER_TOUCHPAD_NOTIFY_BIT);
+  xTaskCreate(controller_touchpad_task, "touchpad_task", 2048, NULL, 4, &touchpad_task);
+
+  // initialize the touch pad, measuring in the background on the FSM timer
   ESP_ERROR_CHECK(touch_pad_init());
+  touch_pad_set_fsm_mode(TOUCH_FSM_MODE_TIMER);
+  touch_pad_set_meas_time(TOUCHPAD_SLEEP_CYCLES, TOUCHPAD_MEAS_CYCLES);
   // set reference voltage for charging / discharging
   touch_pad_set_voltage(TOUCH_HVOLT_2V7, TOUCH_LVOLT_0V5, TOUCH_HVOLT_ATTEN_1V);
   // configure the pins with the touchpad
   touch_pad_config(TOUCHPAD_PIN, TOUCH_THRESH_NO_USE);
-  // start the touchpad filter
-  touch_pad_filter_start(10);
-
-  // create the touchpad task queue
-  queue = xQueueCreate(4, sizeof(controller_touchpad_event_t));
-  xTaskCreate(controller_touchpad_task, "touchpad_task", 2048, NULL, 4, NULL);
-  return queue;
-}
\ No newline at end of file
+  // start the touchpad filter, and seed the baseline once it has settled
+  touch_pad_filter_start(TOUCHPAD_FILTER_PERIOD_MS);
+  vTaskDelay(TOUCHPAD_FILTER_PERIOD_MS * 5 / portTICK_PERIOD_MS);
+  uint16_t untouched;
+  touch_pad_read_filtered(TOUCHPAD_PIN, &untouched);
+  baseline = (uint32_t)untouched << TOUCHPAD_BASELINE_SHIFT;
+  set_thresholds();
+  ESP_LOGI(TAG, "untouched at %u, touch below %u, release above %u", untouched, touch_thresh, release_thresh);
+
+  // from here on, touches come in through the ISR and releases through the filter
+  touch_pad_set_filter_read_cb(touchpad_filter_cb);
+  touch_pad_set_trigger_mode(TOUCH_TRIGGER_BELOW);
+  touch_pad_isr_register(touchpad_isr, NULL);
+  touch_pad_clear_status();
+  touch_pad_intr_enable();
+  return mailbox;
+}
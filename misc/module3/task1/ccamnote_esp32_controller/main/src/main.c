@@ -6,7 +6,6 @@
  */
 #include <inttypes.h>
 #include <stdio.h>
-#include <math.h>
 #include <string.h>
 
 #include "driver/adc.h"
@@ -14,6 +13,7 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "esp_now.h"
 #include "freertos/FreeRTOS.h"
@@ -26,46 +26,75 @@
 #include "controller_buttons.h"
 #include "controller_joystick.h"
 #include "controller_touchpad.h"
+#include "report_scheduler.h"
+#include "trace.h"
+#include "util.h"
 #include "wifi_connect.h"
 #include "wifi_ws_client.h"
+#include "wire.h"
 
 #define TAG "CCAMNotary Controller"
-
-#define JOYSTICK_DEADZONE 0.05
+// set on the controller task at every report tick
+#define REPORT_TICK_NOTIFY_BIT (1UL << 4)
 
 typedef struct {
-  double joystick_xstate;
-  double joystick_ystate;
+  int16_t joystick_xstate;
+  int16_t joystick_ystate;
   uint16_t button_state;
 } controller_state_t;
 
 /* -------------------------- MAIN CONTROLLER LOOP -------------------------- */
 
 /**
- * @brief Polls for button and joystick input events.
+ * @brief Waits for button and joystick input events.
  *
- * Uses tiny checksums to detect state changes, only emitting packets when said
- * state change is detected. We send all events over websockets. However, it is
- * assumed that every even numbered button press uploads a picture, and every
- * odd numbered button press solidifies placement of a just-uploaded picture.
+ * Sleeps on the notify bits of every input mailbox and the report scheduler
+ * at once. Inputs only update the controller state as they come in; the
+ * state goes out on the scheduler's next tick, at a fixed rate, if it
+ * changed since the last report (or as a keepalive if nothing has been sent
+ * in a while), so the send rate no longer depends on how the inputs happen
+ * to be timed. We send all events over websockets. However, it is assumed
+ * that every even numbered button press uploads a picture, and every odd
+ * numbered button press solidifies placement of a just-uploaded picture.
  *
  * @param pvParameter A placeholder for provided variables (unused).
  */
 static void read_controller_task(void *pvParameter) {
-  // begin & listen to the joystick & button event queue
-  char message[128];
+  // begin & listen to the joystick & button state mailboxes
+  char message[WIRE_STATE_JSON_MAX_SIZE];
+  uint8_t frame[WIRE_STATE_V1_SIZE];
+  uint16_t seq = 0;
+  // whether each input changed since the last report went out
   bool received_joystick = false, received_button = false, received_touchpad = false;
+  // the websocket connection the last report went out on
+  uint32_t reported_connection = 0;
   controller_joystick_event_t ev_joystick;
   ev_joystick.xstate = 0;
   ev_joystick.ystate = 0;
   ev_joystick.pressed = false;
+  ev_joystick.time_us = 0;
   controller_buttons_event_t ev_buttons;
   ev_buttons.state = 0;
+  ev_buttons.time_us = 0;
   controller_touchpad_event_t ev_touchpad;
   ev_touchpad.state = 0;
-  QueueHandle_t controller_buttons_events = controller_buttons_init();
-  QueueHandle_t controller_touchpad_events = controller_touchpad_init();
-  // QueueHandle_t controller_joystick_events = controller_joystick_init();
+  ev_touchpad.time_us = 0;
+  mailbox_t *controller_buttons_state = controller_buttons_init();
+  mailbox_t *controller_touchpad_state = controller_touchpad_init();
+  // mailbox_t *controller_joystick_state = controller_joystick_init();
+  // every input wakes this task through its own notify bit
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  mailbox_set_consumer(controller_buttons_state, self);
+  mailbox_set_consumer(controller_touchpad_state, self);
+  // mailbox_set_consumer(controller_joystick_state, self);
+  const uint32_t input_bits = CONTROLLER_BUTTONS_NOTIFY_BIT | CONTROLLER_TOUCHPAD_NOTIFY_BIT;
+  // and the report scheduler paces what goes out
+  report_scheduler_config_t report_config = REPORT_SCHEDULER_CONFIG_DEFAULT();
+  report_scheduler_t *reports = report_scheduler_start(&report_config, REPORT_TICK_NOTIFY_BIT);
+  if (reports == NULL) {
+    ESP_LOGE(TAG, "failed to start the report scheduler");
+    vTaskDelete(NULL);
+  }
 
   // // peer address
   // uint8_t *peerAddress = CONFIG_RECEIVER_MAC_ADDRESS;
@@ -74,23 +103,51 @@ static void read_controller_task(void *pvParameter) {
 
   // continually loop to retrieve input from the controller
   while (true) {
-    // events emitted are guaranteed to be state changes. so on any event,
-    // we want to send the entire state of the joystick to the websocket.
-    //  - we wait up to 300 ms for the buttons, and then 300 ms for joystick
-    received_button = xQueueReceive(controller_buttons_events, &ev_buttons, 20 / portTICK_PERIOD_MS);
-    received_touchpad = xQueueReceive(controller_touchpad_events, &ev_touchpad, 20 / portTICK_PERIOD_MS);
-    // received_button = xQueueReceive(controller_joystick_events, &ev_joystick, 20 / portTICK_PERIOD_MS);
-    if (received_joystick || received_button || received_touchpad) {
-      // if we got either a joystick or button update, send an update to the websocket
-      sprintf(message, "{\"type\":\"controller_state\",\"data\":[%.2f, %.2f, %d, %s, %d, %s]}",
-              ev_joystick.xstate,
-              ev_joystick.ystate,
-              ev_buttons.state,
-              ((ev_buttons.state & 1) && received_button) ? "true" : "false",
-              ev_touchpad.state,
-              received_touchpad ? "true" : "false");
-      websocket_client_send(message, strlen(message));
+    // sleep until any input posts or a report is due. reading after waking
+    // also picks up whatever was posted before we became the consumer
+    uint32_t bits = mailbox_wait_any(input_bits | REPORT_TICK_NOTIFY_BIT, portMAX_DELAY);
+    // mailboxes only ever hold the newest state, so every one is checked on
+    // each pass, whichever one woke us. a change stays pending until the
+    // next report carries it.
+    if (mailbox_read(controller_buttons_state, &ev_buttons)) received_button = true;
+    if (mailbox_read(controller_touchpad_state, &ev_touchpad)) received_touchpad = true;
+    // if (mailbox_read(controller_joystick_state, &ev_joystick)) received_joystick = true;
+    if (!(bits & REPORT_TICK_NOTIFY_BIT)) continue;
+
+    // on any change, we want to send the entire state of the controller to the
+    // websocket. so too after a reconnect, as the server may have lost or
+    // dropped what we sent before; the sender puts the handshake ahead of it
+    uint32_t connection = websocket_client_connection();
+    bool resync = connection != reported_connection;
+    if (!report_scheduler_tick(reports, resync || received_joystick || received_button || received_touchpad)) continue;
+    reported_connection = connection;
+    // stamp the message with the oldest input it carries, so the receiver
+    // sees the full edge-to-wire delay. a keepalive carries none, so it is
+    // stamped with when it was sent
+    int64_t sampled_us = INT64_MAX;
+    if (received_joystick && ev_joystick.time_us < sampled_us) sampled_us = ev_joystick.time_us;
+    if (received_button && ev_buttons.time_us < sampled_us) sampled_us = ev_buttons.time_us;
+    if (received_touchpad && ev_touchpad.time_us < sampled_us) sampled_us = ev_touchpad.time_us;
+    if (sampled_us == INT64_MAX) sampled_us = esp_timer_get_time();
+    // hand an update to the websocket sender, as a binary frame if the server
+    // asked for one, and as JSON otherwise. never waits on the network
+    wire_state_t state = {
+        .joystick_xstate = ev_joystick.xstate,
+        .joystick_ystate = ev_joystick.ystate,
+        .buttons = ev_buttons.state,
+        .flags = (((ev_buttons.state & 1) && received_button) ? WIRE_FLAG_JUST_PRESSED : 0) |
+                 (ev_touchpad.state ? WIRE_FLAG_TOUCHPAD : 0) |
+                 (received_touchpad ? WIRE_FLAG_TOUCHPAD_CHANGED : 0) |
+                 (ev_joystick.pressed ? WIRE_FLAG_JOYSTICK_PRESSED : 0),
+        .time_us = sampled_us};
+    uint8_t wire = websocket_client_wire();
+    if (wire == WIRE_BINARY_V1) {
+      websocket_client_send_state(frame, wire_encode_state(frame, sizeof(frame), seq++, &state), true);
+    } else {
+      websocket_client_send_state(message, WIRE_ENCODE_STATE_JSON(message, &state), false);
     }
+    TRACE(TRACE_REPORT, wire, state.buttons, state.flags, esp_timer_get_time() - sampled_us);
+    received_joystick = received_button = received_touchpad = false;
   }
 }
 
@@ -110,6 +167,7 @@ static esp_err_t read_controller_init(void) {
 
 void app_main() {
   esp_err_t ret;
+  trace_init();
 
   // 1. initialize non-volatile storage. if we're out of memory or there's a new
   // version, attempt to erase the current NVS and re-initialize it.
@@ -0,0 +1,164 @@
+/*
+ * report_scheduler.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "report_scheduler.h"
+
+// our tag for ESP Info logging
+static const char *TAG = "Report Scheduler";
+
+// seconds between two rate reports in the debug log
+#define STATS_LOG_SECONDS (10)
+
+struct report_scheduler {
+  esp_timer_handle_t timer;
+  TaskHandle_t consumer;       // task the ticks are sent to
+  uint32_t notify_bits;        // set on the consumer at every tick
+  int64_t period_us;
+  int64_t keepalive_us;        // 0 = no keepalives
+  int64_t start_us;            // tick n is due at start_us + n * period_us
+  int64_t next_tick;           // the first tick not handled yet
+  int64_t last_report_us;      // when the last report of either kind went out
+  uint64_t jitter_sum_us;      // lateness of every handled tick, added up
+  report_scheduler_stats_t stats;
+};
+
+/* ---------------------------------- TIMER --------------------------------- */
+
+/**
+ * @brief Wakes the consumer at every tick.
+ *
+ * Runs in the esp_timer task, so it only sets the consumer's notify bits. A
+ * tick that comes in while the last one is still being handled merges with
+ * it, and report_scheduler_tick counts it as missed.
+ *
+ * @param arg The scheduler.
+ */
+static void report_scheduler_timer_cb(void *arg) {
+  report_scheduler_t *scheduler = arg;
+  xTaskNotify(scheduler->consumer, scheduler->notify_bits, eSetBits);
+}
+
+/* ---------------------------- PUBLIC INTERFACE ---------------------------- */
+
+/**
+ * @brief Starts pacing reports for the calling task.
+ *
+ * A periodic esp_timer sets `notify_bits` on the calling task every
+ * 1/rate_hz seconds, independent of the FreeRTOS tick. The task can wait for
+ * them alongside its other inputs (mailbox_wait_any does this), and calls
+ * report_scheduler_tick whenever they are set to find out whether to send.
+ *
+ * @param config The rate and keepalive, clamped to what the scheduler supports.
+ * @param notify_bits The task notification bits every tick sets on the calling task.
+ * @return report_scheduler_t* - The scheduler, or NULL on failure.
+ */
+report_scheduler_t *report_scheduler_start(const report_scheduler_config_t *config, uint32_t notify_bits) {
+  uint32_t rate_hz = config->rate_hz;
+  if (rate_hz < 1) rate_hz = 1;
+  if (rate_hz > REPORT_SCHEDULER_MAX_RATE_HZ) rate_hz = REPORT_SCHEDULER_MAX_RATE_HZ;
+
+  report_scheduler_t *scheduler = calloc(1, sizeof(report_scheduler_t));
+  if (scheduler == NULL) return NULL;
+  scheduler->consumer = xTaskGetCurrentTaskHandle();
+  scheduler->notify_bits = notify_bits;
+  scheduler->period_us = 1000000 / rate_hz;
+  scheduler->keepalive_us = (int64_t)config->keepalive_ms * 1000;
+  scheduler->stats.period_us = scheduler->period_us;
+
+  esp_timer_create_args_t timer_args = {
+      .callback = report_scheduler_timer_cb,
+      .arg = scheduler,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "report_scheduler",
+  };
+  esp_err_t err;
+  if ((err = esp_timer_create(&timer_args, &scheduler->timer)) != ESP_OK) {
+    ESP_LOGE(TAG, "failed to create the timer: %s", esp_err_to_name(err));
+    free(scheduler);
+    return NULL;
+  }
+  scheduler->start_us = esp_timer_get_time();
+  scheduler->next_tick = 1;
+  if ((err = esp_timer_start_periodic(scheduler->timer, scheduler->period_us)) != ESP_OK) {
+    ESP_LOGE(TAG, "failed to start the timer: %s", esp_err_to_name(err));
+    esp_timer_delete(scheduler->timer);
+    free(scheduler);
+    return NULL;
+  }
+
+  ESP_LOGI(TAG, "reporting at %u Hz, keepalive every %u ms", rate_hz, config->keepalive_ms);
+  return scheduler;
+}
+
+/**
+ * @brief Handles a tick, and decides whether it sends a report.
+ *
+ * A tick sends when the state changed since the last report, or when no
+ * report has gone out for keepalive_ms. Also measures how late the tick was
+ * handled against the timer's ideal schedule, and how many went by unhandled.
+ * Only ever called by the consumer, so the statistics need no lock.
+ *
+ * @param scheduler The scheduler.
+ * @param changed Whether the state differs from what the last report sent.
+ * @return bool - Whether to send a report now.
+ */
+bool report_scheduler_tick(report_scheduler_t *scheduler, bool changed) {
+  report_scheduler_stats_t *stats = &scheduler->stats;
+  int64_t now_us = esp_timer_get_time();
+
+  // the newest tick that is due, and how late we are for it
+  int64_t due = (now_us - scheduler->start_us) / scheduler->period_us;
+  if (due < scheduler->next_tick) due = scheduler->next_tick;
+  if (due > scheduler->next_tick) stats->missed += due - scheduler->next_tick;
+  scheduler->next_tick = due + 1;
+  int64_t late_us = now_us - (scheduler->start_us + due * scheduler->period_us);
+  if (late_us < 0) late_us = 0;
+  stats->ticks++;
+  scheduler->jitter_sum_us += late_us;
+  stats->jitter_mean_us = scheduler->jitter_sum_us / stats->ticks;
+  if (late_us > stats->jitter_max_us) stats->jitter_max_us = late_us;
+
+  // send on change, or to keep the link alive
+  bool send = true;
+  if (changed) {
+    stats->reports++;
+  } else if (scheduler->keepalive_us && now_us - scheduler->last_report_us >= scheduler->keepalive_us) {
+    stats->keepalives++;
+  } else {
+    send = false;
+  }
+  if (send) scheduler->last_report_us = now_us;
+
+  int64_t elapsed_us = now_us - scheduler->start_us;
+  stats->tick_rate_hz = (uint64_t)stats->ticks * 1000000 / elapsed_us;
+  stats->report_rate_hz = (uint64_t)(stats->reports + stats->keepalives) * 1000000 / elapsed_us;
+  if (stats->ticks % (STATS_LOG_SECONDS * 1000000 / scheduler->period_us) == 0) {
+    // the consumer's stack high-water mark rides along, as it is the consumer calling this
+    ESP_LOGD(TAG, "%u Hz ticks, %u Hz reports (%u keepalives), jitter %u us mean %u us max, %u missed, %u bytes of stack never used",
+             stats->tick_rate_hz, stats->report_rate_hz, stats->keepalives, stats->jitter_mean_us,
+             stats->jitter_max_us, stats->missed, uxTaskGetStackHighWaterMark(NULL));
+  }
+  return send;
+}
+
+/**
+ * @brief Copies out the scheduler's rate and jitter measurements.
+ *
+ * Only meaningful on the consumer's own task, which is the one updating them.
+ *
+ * @param scheduler The scheduler.
+ * @param out Where to copy the statistics.
+ */
+void report_scheduler_get_stats(report_scheduler_t *scheduler, report_scheduler_stats_t *out) {
+  *out = scheduler->stats;
+}
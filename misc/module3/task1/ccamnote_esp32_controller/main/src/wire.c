@@ -0,0 +1,181 @@
+/*
+ * wire.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#include <string.h>
+
+#include "wire.h"
+
+/* --------------------------------- BINARY --------------------------------- */
+
+/**
+ * @brief Writes a 16-bit value little-endian.
+ *
+ * @param buf Where to write it.
+ * @param value The value.
+ */
+static inline void put_u16(uint8_t *buf, uint16_t value) {
+  buf[0] = value;
+  buf[1] = value >> 8;
+}
+
+/**
+ * @brief Writes a 32-bit value little-endian.
+ *
+ * @param buf Where to write it.
+ * @param value The value.
+ */
+static inline void put_u32(uint8_t *buf, uint32_t value) {
+  put_u16(buf, value);
+  put_u16(buf + 2, value >> 16);
+}
+
+/**
+ * @brief Encodes a controller state as a WIRE_BINARY_V1 frame.
+ *
+ * Byte by byte, so the frame is the same whatever the compiler does to
+ * struct layout. See wire.h for the layout.
+ *
+ * @param buf Where to write the frame.
+ * @param len How much room there is in buf.
+ * @param seq The frame's sequence number.
+ * @param state The state to encode.
+ * @return size_t - The length of the frame, or 0 if buf is too small.
+ */
+size_t wire_encode_state(uint8_t *buf, size_t len, uint16_t seq, const wire_state_t *state) {
+  if (len < WIRE_STATE_V1_SIZE) return 0;
+  buf[0] = WIRE_HEADER(WIRE_BINARY_V1, WIRE_KIND_STATE);
+  buf[1] = state->flags;
+  put_u16(buf + 2, seq);
+  put_u16(buf + 4, state->buttons);
+  put_u16(buf + 6, (uint16_t)state->joystick_xstate);
+  put_u16(buf + 8, (uint16_t)state->joystick_ystate);
+  put_u32(buf + 10, (uint32_t)state->time_us);
+  return WIRE_STATE_V1_SIZE;
+}
+
+/* ---------------------------------- JSON ---------------------------------- */
+
+// copies a string literal in, without its NUL
+#define PRINT_LITERAL(p, literal) (memcpy((p), (literal), sizeof(literal) - 1), (p) + sizeof(literal) - 1)
+
+/**
+ * @brief Writes an unsigned integer in decimal.
+ *
+ * Digits come out of the bottom first, so they go into a scratch buffer and
+ * are copied over in the right order. Only 32-bit divisions, which the ESP32
+ * does in hardware.
+ *
+ * @param p Where to write it.
+ * @param value The value.
+ * @return char* - Just past the last digit.
+ */
+static char *print_u32(char *p, uint32_t value) {
+  char digits[10];
+  int n = 0;
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (n) *p++ = digits[--n];
+  return p;
+}
+
+/**
+ * @brief Writes an unsigned 64-bit integer in decimal.
+ *
+ * Anything past 32 bits is split into 9-digit groups first, so the 64-bit
+ * division (done in software) only runs for values that need it.
+ *
+ * @param p Where to write it.
+ * @param value The value.
+ * @return char* - Just past the last digit.
+ */
+static char *print_u64(char *p, uint64_t value) {
+  if (value <= UINT32_MAX) return print_u32(p, value);
+  p = print_u64(p, value / 1000000000);
+  uint32_t low = value % 1000000000;
+  for (uint32_t place = 100000000; place; place /= 10) {
+    *p++ = '0' + low / place % 10;
+  }
+  return p;
+}
+
+/**
+ * @brief Writes a signed 64-bit integer in decimal.
+ *
+ * @param p Where to write it.
+ * @param value The value.
+ * @return char* - Just past the last digit.
+ */
+static char *print_i64(char *p, int64_t value) {
+  if (value >= 0) return print_u64(p, value);
+  *p++ = '-';
+  return print_u64(p, -(uint64_t)value);
+}
+
+/**
+ * @brief Writes a value in hundredths the way "%.2f" would print it as a float.
+ *
+ * @param p Where to write it.
+ * @param centi The value, in hundredths.
+ * @return char* - Just past the last digit.
+ */
+static char *print_centi(char *p, int16_t centi) {
+  uint32_t magnitude = centi < 0 ? -(int32_t)centi : centi;
+  if (centi < 0) *p++ = '-';
+  p = print_u32(p, magnitude / 100);
+  *p++ = '.';
+  *p++ = '0' + magnitude / 10 % 10;
+  *p++ = '0' + magnitude % 10;
+  return p;
+}
+
+/**
+ * @brief Writes a JSON boolean.
+ *
+ * @param p Where to write it.
+ * @param value The value.
+ * @return char* - Just past the last letter.
+ */
+static char *print_bool(char *p, bool value) {
+  return value ? PRINT_LITERAL(p, "true") : PRINT_LITERAL(p, "false");
+}
+
+/**
+ * @brief Encodes a controller state as a WIRE_JSON controller_state message.
+ *
+ * Integer formatting only, straight into the caller's buffer: no newlib
+ * printf machinery, no floats and nothing allocated, so it costs the calling
+ * task a few dozen bytes of stack. The buffer is checked against the longest
+ * possible message once up front, rather than per field; use
+ * WIRE_ENCODE_STATE_JSON to have that checked at compile time instead.
+ *
+ * @param buf Where to write the message.
+ * @param len How much room there is in buf.
+ * @param state The state to encode.
+ * @return size_t - The length of the message without its NUL, or 0 if buf is too small.
+ */
+size_t wire_encode_state_json(char *buf, size_t len, const wire_state_t *state) {
+  if (len < WIRE_STATE_JSON_MAX_SIZE) return 0;
+  char *p = buf;
+  p = PRINT_LITERAL(p, "{\"type\":\"controller_state\",\"t\":");
+  p = print_i64(p, state->time_us);
+  p = PRINT_LITERAL(p, ",\"data\":[");
+  p = print_centi(p, state->joystick_xstate);
+  p = PRINT_LITERAL(p, ", ");
+  p = print_centi(p, state->joystick_ystate);
+  p = PRINT_LITERAL(p, ", ");
+  p = print_u32(p, state->buttons);
+  p = PRINT_LITERAL(p, ", ");
+  p = print_bool(p, state->flags & WIRE_FLAG_JUST_PRESSED);
+  p = PRINT_LITERAL(p, ", ");
+  *p++ = state->flags & WIRE_FLAG_TOUCHPAD ? '1' : '0';
+  p = PRINT_LITERAL(p, ", ");
+  p = print_bool(p, state->flags & WIRE_FLAG_TOUCHPAD_CHANGED);
+  p = PRINT_LITERAL(p, "]}");
+  *p = '\0';
+  return p - buf;
+}
@@ -0,0 +1,159 @@
+/*
+ * axis_filter_sim.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Feeds axis_filter.c simulated ADC frames of a noisy stick at rest, and
+ * counts how often the space controller's HID axis would change with and
+ * without it. Then checks the filter still lets full deflection through,
+ * and how many frames it adds to a large step.
+ *
+ *   cc -std=gnu11 -O2 -Wall -I../main/include -o axis_filter_sim axis_filter_sim.c -lm
+ *   ./axis_filter_sim [frames] [noise counts] [seed]
+ *
+ * Each reading is the rest position plus Gaussian noise (30 counts by
+ * default). A frame is either one reading, or the rounded mean of the 32
+ * readings an axis gets in a frame with CONFIG_ADC_OVERSAMPLE at the
+ * config.h defaults. The HID axis is the space controller's hid_axis, the
+ * top 8 bits of the reading, and the stick rests on one of its steps, the
+ * worst case. The space controller builds the same axis_filter.c.
+ *
+ * The ccamnote joystick is not counted: its calibration centres the stick
+ * where it rests, and 30 counts of noise is nowhere near its 0.10 rounding
+ * boundary, so it stays quiet with or without the filter.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../main/src/axis_filter.c"
+
+// where the stick rests: 2048 >> 4 is a HID step boundary
+#define REST (2048)
+// readings averaged into a frame with CONFIG_ADC_OVERSAMPLE, per axis
+#define OVERSAMPLED (CONFIG_ADC_FRAME_CONVERSIONS / 2)
+// one frame's worth of conversions at CONFIG_ADC_SAMPLE_FREQ_HZ, in ms
+#define FRAME_MS (1000.0 * CONFIG_ADC_FRAME_CONVERSIONS / CONFIG_ADC_SAMPLE_FREQ_HZ)
+
+/* -------------------------------------------------------------------------- */
+/*                                  READINGS                                  */
+/* -------------------------------------------------------------------------- */
+
+static double gauss(void) {
+  // Box-Muller, one of the pair is enough
+  double u = (rand() + 1.0) / (RAND_MAX + 2.0), v = (rand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static uint16_t reading(double noise) {
+  long raw = lround(REST + noise * gauss());
+  return raw < 0 ? 0 : raw > AXIS_FILTER_MAX_READING ? AXIS_FILTER_MAX_READING : raw;
+}
+
+// a frame as adc_sampler hands it over
+static uint16_t frame(double noise, int readings) {
+  uint32_t sum = 0;
+  for (int i = 0; i < readings; i++) sum += reading(noise);
+  return (sum + readings / 2) / readings;
+}
+
+static uint8_t hid_axis(uint16_t raw) {
+  return raw >> 4;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  AT REST                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Counts the frames a stick at rest changes the HID axis on,
+ * unfiltered and filtered, off the same frames.
+ */
+static void at_rest(int frames, double noise, int readings, int *raw, int *filtered) {
+  axis_filter_t filter;
+  axis_filter_config_t config = AXIS_FILTER_CONFIG_DEFAULT();
+  axis_filter_init(&filter, &config);
+  uint8_t raw_hid = hid_axis(REST), filtered_hid = hid_axis(REST);
+  for (int i = 0; i < frames; i++) {
+    uint16_t value = frame(noise, readings);
+    uint16_t out = axis_filter_update(&filter, value);
+    *raw += hid_axis(value) != raw_hid;
+    *filtered += hid_axis(out) != filtered_hid;
+    raw_hid = hid_axis(value);
+    filtered_hid = hid_axis(out);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   MOVING                                   */
+/* -------------------------------------------------------------------------- */
+
+// frames of a held reading it takes the filter to hand that reading out
+static int settle(axis_filter_t *filter, uint16_t to) {
+  for (int frames = 1; frames <= 100; frames++) {
+    if (axis_filter_update(filter, to) == to) return frames;
+  }
+  return -1;
+}
+
+// frames it takes a filter settled on one reading to come within its hysteresis of
+// another, which is as close as it has to get
+static int step(uint16_t from, uint16_t to) {
+  axis_filter_t filter;
+  axis_filter_config_t config = AXIS_FILTER_CONFIG_DEFAULT();
+  axis_filter_init(&filter, &config);
+  settle(&filter, from);
+  for (int frames = 1; frames <= 100; frames++) {
+    if (abs(axis_filter_update(&filter, to) - to) <= config.hysteresis) return frames;
+  }
+  return -1;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    CHECK                                   */
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 100000;
+  double noise = argc > 2 ? atof(argv[2]) : 30;
+  srand(argc > 3 ? atoi(argv[3]) : 1);
+  int failures = 0;
+
+  printf("%d frames at rest on %d, noise %.0f counts\n", frames, REST, noise);
+  int single_raw = 0, single_filtered = 0, mean_raw = 0, mean_filtered = 0;
+  at_rest(frames, noise, 1, &single_raw, &single_filtered);
+  at_rest(frames, noise, OVERSAMPLED, &mean_raw, &mean_filtered);
+  printf("  one reading a frame: HID axis changed on %6d frames unfiltered, %6d filtered\n", single_raw,
+         single_filtered);
+  printf("  mean of %d a frame:  HID axis changed on %6d frames unfiltered, %6d filtered\n", OVERSAMPLED, mean_raw,
+         mean_filtered);
+  // the config.h defaults must keep a stick at rest all but quiet
+  if (mean_filtered > frames / 1000) {
+    printf("  a stick at rest still changes the HID axis - FAILED\n");
+    failures++;
+  }
+
+  // from rest to each end and back, and a quarter of the range
+  int to_full = step(REST, AXIS_FILTER_MAX_READING), to_none = step(REST, 0);
+  int quarter = step(REST, REST + 1024);
+  axis_filter_t filter;
+  axis_filter_config_t config = AXIS_FILTER_CONFIG_DEFAULT();
+  axis_filter_init(&filter, &config);
+  settle(&filter, REST);
+  int full = settle(&filter, AXIS_FILTER_MAX_READING), none = settle(&filter, 0);
+  printf("a step from rest settles in %d frames to full, %d to zero, %d a quarter over (%.1f ms a frame)\n",
+         to_full, to_none, quarter, FRAME_MS);
+  printf("the ends come out exactly after %d frames at full, %d at zero\n", full, none);
+  if (full < 0 || none < 0 || to_full < 0 || to_none < 0 || quarter < 0) {
+    printf("the filter holds back a large step - FAILED\n");
+    failures++;
+  }
+
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
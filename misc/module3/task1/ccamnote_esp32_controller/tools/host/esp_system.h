@@ -0,0 +1,9 @@
+#ifndef __HOST_ESP_SYSTEM_H__
+#define __HOST_ESP_SYSTEM_H__
+
+#include <stdint.h>
+
+// a seeded generator, so every run draws the same numbers
+uint32_t esp_random(void);
+
+#endif /* __HOST_ESP_SYSTEM_H__ */
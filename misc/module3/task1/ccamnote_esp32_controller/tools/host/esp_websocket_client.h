@@ -0,0 +1,43 @@
+#ifndef __HOST_ESP_WEBSOCKET_CLIENT_H__
+#define __HOST_ESP_WEBSOCKET_CLIENT_H__
+
+#include <stdbool.h>
+
+#include "esp_event.h"
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_websocket *esp_websocket_client_handle_t;
+
+typedef enum {
+  WEBSOCKET_EVENT_ANY = -1,
+  WEBSOCKET_EVENT_ERROR = 0,
+  WEBSOCKET_EVENT_CONNECTED,
+  WEBSOCKET_EVENT_DISCONNECTED,
+  WEBSOCKET_EVENT_DATA,
+} esp_websocket_event_id_t;
+
+typedef struct {
+  const char *uri;
+  bool disable_auto_reconnect;
+} esp_websocket_client_config_t;
+
+typedef struct {
+  const char *data_ptr;
+  int data_len;
+  uint8_t op_code;
+  int payload_len;
+  int payload_offset;
+} esp_websocket_event_data_t;
+
+// one client, faked: see the websocket controls in host.h
+esp_websocket_client_handle_t esp_websocket_client_init(const esp_websocket_client_config_t *config);
+esp_err_t esp_websocket_register_events(esp_websocket_client_handle_t client, esp_websocket_event_id_t event,
+                                        esp_event_handler_t handler, void *arg);
+esp_err_t esp_websocket_client_start(esp_websocket_client_handle_t client);
+esp_err_t esp_websocket_client_stop(esp_websocket_client_handle_t client);
+esp_err_t esp_websocket_client_destroy(esp_websocket_client_handle_t client);
+bool esp_websocket_client_is_connected(esp_websocket_client_handle_t client);
+int esp_websocket_client_send_text(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout);
+int esp_websocket_client_send_bin(esp_websocket_client_handle_t client, const char *data, int len, TickType_t timeout);
+
+#endif /* __HOST_ESP_WEBSOCKET_CLIENT_H__ */
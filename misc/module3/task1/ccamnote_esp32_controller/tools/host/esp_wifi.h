@@ -0,0 +1,6 @@
+#ifndef __HOST_ESP_WIFI_H__
+#define __HOST_ESP_WIFI_H__
+
+#include "esp_err.h"
+
+#endif /* __HOST_ESP_WIFI_H__ */
@@ -0,0 +1,6 @@
+#ifndef __HOST_SEMPHR_H__
+#define __HOST_SEMPHR_H__
+
+#include "freertos/queue.h"
+
+#endif /* __HOST_SEMPHR_H__ */
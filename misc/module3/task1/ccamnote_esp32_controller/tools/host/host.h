@@ -0,0 +1,84 @@
+/*
+ * host.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Just enough of ESP-IDF and FreeRTOS to run the controller's modules on a
+ * desktop, on a simulated clock. Timers fire from the calling thread, in
+ * time order, as the test moves the clock forward. The test's own code is
+ * one task, and never blocks; tasks made with xTaskCreate each get a stack
+ * of their own, and run one at a time, from the test, until they block on a
+ * notification, a delay or a websocket send. NVS is a handful of blobs in
+ * memory, the ADC characterization a fixed curve shaped like an 11 dB one,
+ * and the websocket client a fake the test connects, drops and reads back.
+ */
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// the simulated esp_timer_get_time()
+extern int64_t host_now_us;
+// the notify bits set on the test's task, and not yet taken
+extern uint32_t host_notified;
+
+// blobs committed to NVS, and whether the next write fails
+extern uint32_t host_nvs_commits;
+extern bool host_nvs_fail;
+
+// moves the clock forward, firing every timer due by then at its own time
+void host_advance(int64_t until_us);
+// when the next timer is due, or INT64_MAX if none is running
+int64_t host_next_timer_us(void);
+
+// runs every task that can, each until it blocks, without moving the clock
+void host_run_tasks(void);
+// moves the clock forward like host_advance, running the tasks whenever a
+// timer, a delay or a send wakes one
+void host_run_until(int64_t until_us);
+
+// the voltage esp_adc_cal_raw_to_voltage gives a 12-bit reading
+uint32_t host_mv(uint32_t raw);
+// reads a blob straight out of the simulated NVS, false if there is none
+bool host_nvs_get(const char *key, void *out, size_t length);
+// empties the simulated NVS
+void host_nvs_erase(void);
+
+// restarts esp_random's sequence
+void host_seed(uint32_t seed);
+
+// frames the fake websocket keeps, and how much of each
+#define HOST_WS_FRAMES (512)
+#define HOST_WS_FRAME_SIZE (1024)
+
+typedef struct {
+  uint8_t op_code;
+  int len;
+  int64_t at_us;  // when the send finished
+  char data[HOST_WS_FRAME_SIZE];
+} host_frame_t;
+
+// whether the fake websocket is up, how long a send holds the sending task
+// (one longer than its timeout fails at the timeout), and whether sends fail
+extern bool host_ws_connected;
+extern int64_t host_ws_send_us;
+extern bool host_ws_fail;
+// esp_websocket_client_start and _stop calls so far, and when the last start was
+extern uint32_t host_ws_starts;
+extern uint32_t host_ws_stops;
+extern int64_t host_ws_started_us;
+// the frames that went out, oldest first, and how many there were in all
+extern host_frame_t host_ws_sent[HOST_WS_FRAMES];
+extern uint32_t host_ws_sent_count;
+
+// brings the fake websocket up, and raises WEBSOCKET_EVENT_CONNECTED
+void host_ws_connect(void);
+// takes it down, or fails a connection attempt, and raises WEBSOCKET_EVENT_DISCONNECTED
+void host_ws_drop(void);
+// raises WEBSOCKET_EVENT_DATA with a text frame from the server
+void host_ws_receive(const char *text);
+
+#endif /* __HOST_H__ */
@@ -0,0 +1,130 @@
+/*
+ * input_latency_model.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Models how long a button or touchpad change waits in main.c's
+ * read_controller_task before a report carries it, in the loop as it is now
+ * and as it was before it blocked on mailbox_wait_any.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o input_latency_model input_latency_model.c host/host.c
+ *   ./input_latency_model [changes] [seed]
+ *
+ * Changes come one at a time, at random, far enough apart that none share
+ * a report, on an otherwise idle controller.
+ *
+ * - before: the loop waited up to 20 ms on the buttons, then up to 20 ms on
+ *   the touchpad. A change on the other mailbox sat until the wait timed
+ *   out. That loop is gone, so this half is only a model of its waits, and
+ *   leaves out the up to one more FreeRTOS tick each timeout could add.
+ * - now: the loop wakes on the change, and sends it on the next report
+ *   tick. This half runs report_scheduler.c on the host clock, at
+ *   CONFIG_REPORT_RATE_HZ, with every tick handled the moment it fires.
+ *
+ * Neither counts the context switches, the websocket sender task, or the
+ * network. On hardware, every TRACE_REPORT event carries its report's input
+ * to send time; those have not been measured for these numbers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "../main/src/report_scheduler.c"
+
+// the old loop's wait on each mailbox
+#define OLD_WAIT_US (20000)
+
+/* -------------------------------------------------------------------------- */
+/*                                   RESULTS                                  */
+/* -------------------------------------------------------------------------- */
+
+static int compare(const void *a, const void *b) {
+  int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void print(const char *name, int64_t *latencies_us, int n) {
+  qsort(latencies_us, n, sizeof(latencies_us[0]), compare);
+  double sum = 0;
+  for (int i = 0; i < n; i++) sum += latencies_us[i];
+  printf("  %-20s mean %5.2f ms  p99 %5.2f ms  max %5.2f ms\n", name, sum / n / 1000,
+         latencies_us[n * 99 / 100] / 1000.0, latencies_us[n - 1] / 1000.0);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    LOOPS                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief How long a change at `at_us` waited in the old loop, which spent
+ * the first 20 ms of every 40 on the buttons and the rest on the touchpad.
+ */
+static int64_t before(bool button, int64_t at_us) {
+  int64_t phase = at_us % (2 * OLD_WAIT_US);
+  if (button) return phase < OLD_WAIT_US ? 0 : 2 * OLD_WAIT_US - phase;
+  return phase >= OLD_WAIT_US ? 0 : OLD_WAIT_US - phase;
+}
+
+/**
+ * @brief Runs the report ticks up to a time, none of them with anything to send.
+ */
+static void idle_until(report_scheduler_t *reports, int64_t until_us) {
+  while (host_next_timer_us() <= until_us) {
+    host_advance(host_next_timer_us());
+    host_notified = 0;
+    report_scheduler_tick(reports, false);
+  }
+  host_advance(until_us);
+}
+
+/**
+ * @brief How long a change now waits for the tick that sends it.
+ */
+static int64_t now(report_scheduler_t *reports, int64_t at_us) {
+  idle_until(reports, at_us);
+  while (true) {
+    host_advance(host_next_timer_us());
+    host_notified = 0;
+    if (report_scheduler_tick(reports, true)) return host_now_us - at_us;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    MODEL                                   */
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char **argv) {
+  int changes = argc > 1 ? atoi(argv[1]) : 200000;
+  srand(argc > 2 ? atoi(argv[2]) : 1);
+  int64_t *button = malloc(changes * sizeof(int64_t)), *touchpad = malloc(changes * sizeof(int64_t));
+  int64_t *current = malloc(changes * sizeof(int64_t));
+  if (button == NULL || touchpad == NULL || current == NULL) return 1;
+
+  report_scheduler_config_t config = REPORT_SCHEDULER_CONFIG_DEFAULT();
+  report_scheduler_t *reports = report_scheduler_start(&config, 1);
+  if (reports == NULL) return 1;
+  int64_t at_us = 0;
+  for (int i = 0; i < changes; i++) {
+    // 20 to 100 ms apart, to the microsecond
+    at_us = host_now_us + 20000 + rand() % 80000;
+    button[i] = before(true, at_us);
+    touchpad[i] = before(false, at_us);
+    current[i] = now(reports, at_us);
+  }
+
+  printf("%d changes, one at a time\n", changes);
+  printf("before, a 20 ms wait on each mailbox in turn:\n");
+  print("button", button, changes);
+  print("touchpad", touchpad, changes);
+  printf("now, woken by either and sent on the next tick at %u Hz:\n", config.rate_hz);
+  print("button or touchpad", current, changes);
+
+  // a change must never wait longer than one tick now
+  if (current[changes - 1] > 1000000 / config.rate_hz) {
+    printf("a change waited longer than one report tick\nFAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
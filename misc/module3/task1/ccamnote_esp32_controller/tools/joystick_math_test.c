@@ -0,0 +1,185 @@
+/*
+ * joystick_math_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Checks util.h's nearest_tenth and axis_to_centi, which turn joystick_cal_apply
+ * positions into the hundredths the joystick reports, against the double
+ * code they replaced, and times both.
+ *
+ *   cc -std=gnu11 -O2 -Wall -I../main/include -o joystick_math_test joystick_math_test.c -lm
+ *   ./joystick_math_test
+ *
+ * Equivalence is on what leaves the controller: the text the old "%0.2f"
+ * printed against what CENTI_FMT prints, and which pairs of positions count
+ * as a change under controller_joystick.c's deadzone. The only differences
+ * allowed are where the old double truncated a hair below the value it
+ * stood for; anything else fails the run.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "util.h"
+
+// full deflection, as joystick_cal.h has it
+#define FULL_SCALE (10000)
+// controller_joystick.c's JOYSTICK_DEADZONE, in hundredths
+#define DEADZONE_CENTI (5)
+
+/* -------------------------------------------------------------------------- */
+/*                                  OLD CODE                                  */
+/* -------------------------------------------------------------------------- */
+
+// util.h's nearest_tenth before it moved to hundredths
+static double nearest_tenth_double(double v) {
+  int c, r, m;
+  m = v * 100;
+  c = m % 10;
+  r = m / 10;
+  if (c >= 5) r++;
+  return (double)r / 10;
+}
+
+// the centring it was fed, on a position instead of a raw reading
+static double axis_double(int32_t axis) {
+  return nearest_tenth_double(axis / (2.0 * FULL_SCALE)) * 2;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+// whether the old double truncated a position below the hundredth it stood for
+static bool double_artifact(int32_t axis) {
+  return (int)(axis / (2.0 * FULL_SCALE) * 100) != axis / 200;
+}
+
+static int check_nearest_tenth(void) {
+  // every value in hundredths over well beyond full scale. the old code took
+  // a double, so it is fed the nearest one; these are the rounding cases
+  // where the double was not exactly the decimal it stood for
+  int differ = 0, failures = 0;
+  for (int32_t c = -10000; c <= 10000; c++) {
+    char old[32], new[32];
+    snprintf(old, sizeof(old), "%0.2f", nearest_tenth_double(c / 100.0));
+    snprintf(new, sizeof(new), CENTI_FMT, CENTI_ARGS(nearest_tenth(c)));
+    if (strcmp(old, new) == 0) continue;
+    differ++;
+    // the old code truncated v * 100 to an int, so x.xx that is a hair under
+    // in binary drops a hundredth before rounding. only those may differ
+    double m = (c / 100.0) * 100;
+    if ((int)m == c) {
+      if (failures++ < 5) printf("nearest_tenth(%d): old %s, new %s\n", c, old, new);
+    }
+  }
+  printf("nearest_tenth: %d values, %d differ, all where the old double truncated below the value%s\n", 20001,
+         differ, failures ? " - FAILED" : "");
+  return failures;
+}
+
+static int check_axis(void) {
+  int failures = 0, known = 0;
+  for (int32_t axis = -FULL_SCALE; axis <= FULL_SCALE; axis++) {
+    char old[32], new[32];
+    snprintf(old, sizeof(old), "%0.2f", axis_double(axis));
+    snprintf(new, sizeof(new), CENTI_FMT, CENTI_ARGS(axis_to_centi(axis)));
+    if (strcmp(old, new) == 0) continue;
+    if (double_artifact(axis)) {
+      known++;
+    } else if (failures++ < 5) {
+      printf("axis: position %d, old %s, new %s\n", axis, old, new);
+    }
+  }
+  printf("axis: %d positions, %d differ, %d of them where the old double truncated below%s\n", 2 * FULL_SCALE + 1,
+         failures + known, known, failures ? " - FAILED" : "");
+  return failures;
+}
+
+static int check_deadzone(void) {
+  // every seventh position as the last one reported, against every position
+  long pairs = 0, failures = 0, known = 0;
+  for (int32_t a = -FULL_SCALE; a <= FULL_SCALE; a += 7) {
+    double old_a = axis_double(a);
+    int32_t new_a = axis_to_centi(a);
+    for (int32_t b = -FULL_SCALE; b <= FULL_SCALE; b++) {
+      bool old_moved = fabs(axis_double(b) - old_a) > 0.05;
+      bool new_moved = abs(axis_to_centi(b) - new_a) > DEADZONE_CENTI;
+      pairs++;
+      if (old_moved == new_moved) continue;
+      if (double_artifact(a) || double_artifact(b)) {
+        known++;
+      } else if (failures++ < 5) {
+        printf("deadzone: positions %d and %d, old %d, new %d\n", a, b, old_moved, new_moved);
+      }
+    }
+  }
+  printf("deadzone: %ld pairs, %ld differ, %ld of them where the old double truncated below%s\n", pairs,
+         failures + known, known, failures ? " - FAILED" : "");
+  return failures;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  BENCHMARK                                 */
+/* -------------------------------------------------------------------------- */
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// one sample's worth: both axes, and the deadzone test against the last
+static void bench(void) {
+  enum { SAMPLES = 1 << 24 };
+  static int32_t positions[4096];
+  uint32_t seed = 1;
+  for (int i = 0; i < 4096; i++) {
+    seed = seed * 1103515245 + 12345;
+    positions[i] = (int32_t)((seed >> 8) % (2 * FULL_SCALE + 1)) - FULL_SCALE;
+  }
+
+  volatile int sink = 0;
+  double last_x = 0, last_y = 0;
+  double start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) {
+    double x = axis_double(positions[i & 4095]);
+    double y = axis_double(positions[(i + 1) & 4095]);
+    if (fabs(x - last_x) > 0.05 || fabs(y - last_y) > 0.05) {
+      last_x = x;
+      last_y = y;
+      sink++;
+    }
+  }
+  double old_ns = (now_ns() - start) / SAMPLES;
+
+  int32_t last_cx = 0, last_cy = 0;
+  start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) {
+    int32_t x = axis_to_centi(positions[i & 4095]);
+    int32_t y = axis_to_centi(positions[(i + 1) & 4095]);
+    if (abs(x - last_cx) > DEADZONE_CENTI || abs(y - last_cy) > DEADZONE_CENTI) {
+      last_cx = x;
+      last_cy = y;
+      sink++;
+    }
+  }
+  double new_ns = (now_ns() - start) / SAMPLES;
+
+  printf("\nns per sample (two axes and the deadzone test): double %.2f, fixed point %.2f\n", old_ns, new_ns);
+  printf("this host has hardware doubles; the ESP32 runs every double op above through soft-float\n");
+}
+
+int main(void) {
+  int failures = check_nearest_tenth() + check_axis() + check_deadzone();
+  bench();
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ * report_scheduler_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Runs report_scheduler.c on a simulated clock, with a consumer that handles
+ * each tick as the test says, and checks what it sends and what it measures.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Ihost -I../main/include -o report_scheduler_test report_scheduler_test.c host/host.c
+ *   ./report_scheduler_test
+ *
+ * - rate: every rate from 1 Hz to the 1 kHz cap ticks exactly that often,
+ *   and rates past either end are clamped to it.
+ * - jitter: ticks handled late by a known amount come out with that mean
+ *   and maximum. A consumer that stalls across several ticks gets one
+ *   merged tick, late against the newest of them, with the rest counted as
+ *   missed, and is back on schedule after.
+ * - keepalive: an idle consumer sends once every keepalive_ms, a change
+ *   pushes the next keepalive back, and keepalive_ms 0 never sends one.
+ *
+ * The nobot and space controllers build the same report_scheduler.c, bar
+ * the config header it includes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "../main/src/report_scheduler.c"
+
+#define NOTIFY_BIT (1UL << 4)
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                  CONSUMER                                  */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  int64_t (*late_us)(int tick);  // how long after a tick fires it is handled
+  bool (*changed)(int tick);     // whether the state changed before it
+  int sent;                      // reports of either kind that went out
+  int64_t last_sent_us;          // when the last one did
+  int64_t longest_gap_us;        // the longest time between two
+} consumer_t;
+
+static int64_t on_time(int tick) {
+  return 0;
+}
+
+static bool never(int tick) {
+  return false;
+}
+
+/**
+ * @brief Handles ticks the way a consumer task would, for a while: sleeps
+ * until the notify bit is set, maybe some time longer, then takes the bit
+ * and calls report_scheduler_tick.
+ */
+static void run(report_scheduler_t *reports, consumer_t *consumer, int64_t for_us) {
+  int64_t until_us = host_now_us + for_us;
+  for (int tick = 0; host_next_timer_us() <= until_us; tick++) {
+    host_advance(host_next_timer_us());
+    if (!(host_notified & NOTIFY_BIT)) continue;
+    host_advance(host_now_us + consumer->late_us(tick));
+    host_notified = 0;
+    if (report_scheduler_tick(reports, consumer->changed(tick))) {
+      if (consumer->sent++ && host_now_us - consumer->last_sent_us > consumer->longest_gap_us) {
+        consumer->longest_gap_us = host_now_us - consumer->last_sent_us;
+      }
+      consumer->last_sent_us = host_now_us;
+    }
+  }
+  host_advance(until_us);
+}
+
+static report_scheduler_t *start(uint32_t rate_hz, uint32_t keepalive_ms) {
+  report_scheduler_config_t config = {.rate_hz = rate_hz, .keepalive_ms = keepalive_ms};
+  host_notified = 0;
+  return report_scheduler_start(&config, NOTIFY_BIT);
+}
+
+static void stop(report_scheduler_t *reports) {
+  esp_timer_stop(reports->timer);
+  esp_timer_delete(reports->timer);
+  free(reports);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    RATE                                    */
+/* -------------------------------------------------------------------------- */
+
+static void check_rate(void) {
+  const uint32_t rates[] = {1, 7, 60, 125, 250, 333, 500, 999, 1000};
+  for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    report_scheduler_t *reports = start(rates[i], 0);
+    consumer_t consumer = {.late_us = on_time, .changed = never};
+    run(reports, &consumer, 10000000);
+    report_scheduler_stats_t stats;
+    report_scheduler_get_stats(reports, &stats);
+    // 1000000 / rate is whole microseconds, so a rate it does not divide runs a hair fast
+    uint32_t period_us = 1000000 / rates[i];
+    CHECK(stats.period_us == period_us, "%u Hz asked for a %u us period", rates[i], stats.period_us);
+    CHECK(stats.ticks == 10000000 / period_us, "%u Hz: %u ticks in 10 s", rates[i], stats.ticks);
+    CHECK(stats.tick_rate_hz == 1000000 / period_us, "%u Hz measured at %u Hz", rates[i], stats.tick_rate_hz);
+    CHECK(stats.missed == 0 && stats.jitter_max_us == 0, "%u Hz: %u missed, %u us late on time", rates[i],
+          stats.missed, stats.jitter_max_us);
+    stop(reports);
+  }
+
+  // past either end: clamped
+  report_scheduler_t *reports = start(5000, 0);
+  consumer_t consumer = {.late_us = on_time, .changed = never};
+  run(reports, &consumer, 1000000);
+  report_scheduler_stats_t stats;
+  report_scheduler_get_stats(reports, &stats);
+  CHECK(stats.period_us == 1000000 / REPORT_SCHEDULER_MAX_RATE_HZ && stats.ticks == REPORT_SCHEDULER_MAX_RATE_HZ,
+        "5 kHz ran with a %u us period, %u ticks in 1 s", stats.period_us, stats.ticks);
+  stop(reports);
+  reports = start(0, 0);
+  run(reports, &consumer, 10000000);
+  report_scheduler_get_stats(reports, &stats);
+  CHECK(stats.period_us == 1000000 && stats.ticks == 10, "0 Hz ran with a %u us period, %u ticks in 10 s",
+        stats.period_us, stats.ticks);
+  stop(reports);
+  printf("rate: 1 Hz to 1 kHz on the tick, 5 kHz capped to %u Hz, 0 Hz raised to 1 Hz\n",
+         REPORT_SCHEDULER_MAX_RATE_HZ);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   JITTER                                   */
+/* -------------------------------------------------------------------------- */
+
+// 0 to 399 us late, spread over every tick
+static int64_t a_little_late(int tick) {
+  return (tick * 37) % 400;
+}
+
+// on time, except for one tick held up for three and a half periods of 4 ms
+static int64_t stalled(int tick) {
+  return tick == 100 ? 14000 : 0;
+}
+
+static void check_jitter(void) {
+  report_scheduler_t *reports = start(250, 0);
+  consumer_t consumer = {.late_us = a_little_late, .changed = never};
+  run(reports, &consumer, 10000000);
+  report_scheduler_stats_t stats;
+  report_scheduler_get_stats(reports, &stats);
+  uint64_t sum_us = 0;
+  uint32_t max_us = 0;
+  for (uint32_t tick = 0; tick < stats.ticks; tick++) {
+    sum_us += a_little_late(tick);
+    if (a_little_late(tick) > max_us) max_us = a_little_late(tick);
+  }
+  CHECK(stats.ticks == 2500 && stats.missed == 0, "%u ticks, %u missed", stats.ticks, stats.missed);
+  CHECK(stats.jitter_mean_us == sum_us / stats.ticks, "jitter mean %u us, ticks were %llu us late on average",
+        stats.jitter_mean_us, (unsigned long long)(sum_us / stats.ticks));
+  CHECK(stats.jitter_max_us == max_us, "jitter max %u us, the latest tick was %u us", stats.jitter_max_us, max_us);
+  printf("jitter: handled 0-399 us late, measured %u us mean, %u us max\n", stats.jitter_mean_us,
+         stats.jitter_max_us);
+  stop(reports);
+
+  // a stall: the ticks it covers merge into one, and the rest are missed
+  reports = start(250, 0);
+  consumer = (consumer_t){.late_us = stalled, .changed = never};
+  run(reports, &consumer, 10000000);
+  report_scheduler_get_stats(reports, &stats);
+  CHECK(stats.missed == 3, "%u missed across a 14 ms stall", stats.missed);
+  CHECK(stats.ticks + stats.missed == 2500, "%u ticks and %u missed in 10 s", stats.ticks, stats.missed);
+  // lateness is against the newest tick due: 3 periods on from the stalled one, 2 ms ago
+  CHECK(stats.jitter_max_us == 2000, "jitter max %u us across a 14 ms stall", stats.jitter_max_us);
+  printf("jitter: a 14 ms stall at 250 Hz, %u ticks missed, %u handled in 10 s\n", stats.missed, stats.ticks);
+  stop(reports);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  KEEPALIVE                                 */
+/* -------------------------------------------------------------------------- */
+
+// a change every 300 ms, for the first 3 s
+static bool now_and_then(int tick) {
+  return tick < 750 && tick % 75 == 0;
+}
+
+static void check_keepalive(void) {
+  // idle: a keepalive every second, on the tick
+  report_scheduler_t *reports = start(250, 1000);
+  consumer_t consumer = {.late_us = on_time, .changed = never};
+  run(reports, &consumer, 10000000);
+  report_scheduler_stats_t stats;
+  report_scheduler_get_stats(reports, &stats);
+  CHECK(stats.keepalives == 10 && stats.reports == 0, "%u keepalives and %u reports idle for 10 s", stats.keepalives,
+        stats.reports);
+  CHECK(consumer.longest_gap_us == 1000000, "%lld us between two keepalives", (long long)consumer.longest_gap_us);
+  stop(reports);
+
+  // changes push the keepalive back: none while they keep coming
+  reports = start(250, 1000);
+  consumer = (consumer_t){.late_us = a_little_late, .changed = now_and_then};
+  run(reports, &consumer, 10000000);
+  report_scheduler_get_stats(reports, &stats);
+  CHECK(stats.reports == 10, "%u reports for 10 changes", stats.reports);
+  // 3 s of changes, then 7 s idle: the first keepalive comes 1 s after the last change
+  CHECK(stats.keepalives == 6 || stats.keepalives == 7, "%u keepalives in 7 idle seconds", stats.keepalives);
+  CHECK(consumer.longest_gap_us <= 1000000 + 4000 + 400, "%lld us between two reports",
+        (long long)consumer.longest_gap_us);
+  CHECK(stats.report_rate_hz == (stats.reports + stats.keepalives) / 10, "%u Hz reports measured for %u in 10 s",
+        stats.report_rate_hz, stats.reports + stats.keepalives);
+  printf("keepalive: %u in 10 s idle, %u in the 7 s after 10 changes, %lld ms the longest gap\n", 10,
+         stats.keepalives, (long long)consumer.longest_gap_us / 1000);
+  stop(reports);
+
+  // off
+  reports = start(250, 0);
+  consumer = (consumer_t){.late_us = on_time, .changed = never};
+  run(reports, &consumer, 10000000);
+  report_scheduler_get_stats(reports, &stats);
+  CHECK(stats.keepalives == 0 && consumer.sent == 0, "%u keepalives with keepalive_ms 0", stats.keepalives);
+  stop(reports);
+}
+
+int main(void) {
+  check_rate();
+  check_jitter();
+  check_keepalive();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * wire_decode.cpp
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Decodes binary controller state frames, one frame in hex per line, into
+ * one line per state.
+ *
+ *   c++ -std=c++17 -O2 -Wall -Wextra -I../main/include -o wire_decode wire_decode.cpp
+ *   echo 110103ff05000600ecff78563412 | ./wire_decode
+ *   ./wire_decode frames.txt
+ *
+ * Anything on a line that is not hex (a log prefix, spaces) is skipped up to
+ * the first run of hex digits. Reads stdin when no file is given.
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "wire_decode.h"
+
+namespace {
+
+/**
+ * Picks the longest run of hex digit pairs out of a line.
+ */
+std::vector<uint8_t> from_hex(const std::string &line) {
+  std::vector<uint8_t> best, run;
+  for (size_t i = 0; i <= line.size(); i++) {
+    if (i + 1 < line.size() && isxdigit(line[i]) && isxdigit(line[i + 1])) {
+      run.push_back(std::stoi(line.substr(i, 2), nullptr, 16));
+      i++;
+      continue;
+    }
+    if (run.size() > best.size()) best = run;
+    run.clear();
+  }
+  return best;
+}
+
+void print(const wire::State &state, bool have_last, uint16_t last_seq) {
+  std::printf("v%u #%-5u %10u us  x %+5.2f  y %+5.2f  buttons %04x", state.version, state.seq, state.time_us,
+              state.x / 100.0, state.y / 100.0, state.buttons);
+  if (state.just_pressed()) std::printf("  just-pressed");
+  if (state.touchpad()) std::printf("  touchpad");
+  if (state.touchpad_changed()) std::printf("  touchpad-changed");
+  if (state.joystick_pressed()) std::printf("  joystick-pressed");
+  uint8_t unknown = state.flags & ~(WIRE_FLAG_JUST_PRESSED | WIRE_FLAG_TOUCHPAD | WIRE_FLAG_TOUCHPAD_CHANGED |
+                                    WIRE_FLAG_JOYSTICK_PRESSED);
+  if (unknown) std::printf("  flags %02x", unknown);
+  if (have_last && wire::frames_lost(last_seq, state.seq)) {
+    std::printf("  (%u lost)", wire::frames_lost(last_seq, state.seq));
+  }
+  std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::ifstream file;
+  if (argc > 1) {
+    file.open(argv[1]);
+    if (!file) {
+      std::cerr << "cannot open " << argv[1] << "\n";
+      return 1;
+    }
+  }
+  std::istream &input = argc > 1 ? file : std::cin;
+
+  std::string line;
+  bool have_last = false;
+  uint16_t last_seq = 0;
+  while (std::getline(input, line)) {
+    std::vector<uint8_t> frame = from_hex(line);
+    if (frame.empty()) continue;
+    auto state = wire::decode_state(frame.data(), frame.size());
+    if (!state) {
+      std::printf("not a state frame this decoder reads (%zu bytes, header %02x)\n", frame.size(), frame[0]);
+      continue;
+    }
+    print(*state, have_last, last_seq);
+    have_last = true;
+    last_seq = state->seq;
+  }
+  return 0;
+}
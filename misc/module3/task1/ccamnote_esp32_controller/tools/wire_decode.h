@@ -0,0 +1,96 @@
+/*
+ * wire_decode.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * A host-side decoder for the binary controller state frames in wire.h,
+ * shared by wire_decode.cpp and wire_test.cpp.
+ */
+
+#ifndef __WIRE_DECODE_H__
+#define __WIRE_DECODE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+extern "C" {
+#include "wire.h"
+}
+
+namespace wire {
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+struct State {
+  uint8_t version;
+  uint16_t seq;
+  uint8_t flags;     // WIRE_FLAG_*
+  uint16_t buttons;
+  int16_t x;         // hundredths
+  int16_t y;         // hundredths
+  uint32_t time_us;  // low 32 bits of the controller's esp_timer_get_time()
+
+  bool just_pressed() const { return flags & WIRE_FLAG_JUST_PRESSED; }
+  bool touchpad() const { return flags & WIRE_FLAG_TOUCHPAD; }
+  bool touchpad_changed() const { return flags & WIRE_FLAG_TOUCHPAD_CHANGED; }
+  bool joystick_pressed() const { return flags & WIRE_FLAG_JOYSTICK_PRESSED; }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  DECODING                                  */
+/* -------------------------------------------------------------------------- */
+
+inline uint32_t get_le(const uint8_t *p, size_t size) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < size; i++) value |= uint32_t(p[i]) << (8 * i);
+  return value;
+}
+
+/**
+ * Decodes a binary controller state frame, or nothing if it is short, not a
+ * state frame, or a version this decoder does not know. Bytes past the end
+ * of a known version are ignored, so later versions can only grow.
+ */
+inline std::optional<State> decode_state(const uint8_t *frame, size_t len) {
+  if (len < 1 || (frame[0] & 0xf) != WIRE_KIND_STATE) return std::nullopt;
+  State state{};
+  state.version = frame[0] >> 4;
+  switch (state.version) {
+    case WIRE_BINARY_V1:
+      if (len < WIRE_STATE_V1_SIZE) return std::nullopt;
+      state.flags = frame[1];
+      state.seq = uint16_t(get_le(frame + 2, 2));
+      state.buttons = uint16_t(get_le(frame + 4, 2));
+      state.x = int16_t(uint16_t(get_le(frame + 6, 2)));
+      state.y = int16_t(uint16_t(get_le(frame + 8, 2)));
+      state.time_us = get_le(frame + 10, 4);
+      return state;
+    default:
+      return std::nullopt;
+  }
+}
+
+/**
+ * How many frames were lost between two that came in one after the other,
+ * across the sequence number wrapping. A repeat or a frame from before
+ * `last` comes out as close to 65535, which a reader should treat as a
+ * reset rather than a loss.
+ */
+inline uint16_t frames_lost(uint16_t last, uint16_t seq) {
+  return uint16_t(seq - last - 1);
+}
+
+/**
+ * Puts a frame's 32-bit timestamp back on the controller's 64-bit clock,
+ * given any full timestamp from within ~35 minutes of it.
+ */
+inline int64_t unwrap_time(uint32_t time_us, int64_t near_us) {
+  return near_us + int32_t(time_us - uint32_t(near_us));
+}
+
+}  // namespace wire
+
+#endif /* __WIRE_DECODE_H__ */
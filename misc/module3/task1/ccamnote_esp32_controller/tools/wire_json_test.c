@@ -0,0 +1,182 @@
+/*
+ * wire_json_test.c
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Checks wire.c's wire_encode_state_json writes byte for byte what the
+ * sprintf it replaced in main.c wrote, and times both.
+ *
+ *   cc -std=gnu11 -O2 -Wall -I../main/include -o wire_json_test wire_json_test.c
+ *   ./wire_json_test [random states] [seed]
+ *
+ * The states are every flag byte, the int16 extremes on each axis, every
+ * button bit, timestamps around 0, 2^32, each power of ten and both int64
+ * ends, and then random states (1M by default) with timestamps of every
+ * magnitude. Exits non-zero on the first few mismatches.
+ *
+ * These are host numbers. The on-device stack high-water mark and cycle
+ * counts have not been measured; report_scheduler's debug line prints the
+ * controller task's high-water mark on a running board.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "util.h"
+#include "../main/src/wire.c"
+
+static int failures = 0;
+static int checks = 0;
+static int compared = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    checks++;                                \
+    if (!(cond) && failures++ < 10) {        \
+      printf("%s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                   \
+      printf("\n");                          \
+    }                                        \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+/*                                  OLD CODE                                  */
+/* -------------------------------------------------------------------------- */
+
+// main.c's read_controller_task, before wire_encode_state_json
+static int old_json(char *message, size_t len, const wire_state_t *state) {
+  return snprintf(message, len, "{\"type\":\"controller_state\",\"t\":%" PRId64 ",\"data\":[" CENTI_FMT ", " CENTI_FMT ", %d, %s, %d, %s]}",
+                  state->time_us,
+                  CENTI_ARGS(state->joystick_xstate),
+                  CENTI_ARGS(state->joystick_ystate),
+                  state->buttons,
+                  (state->flags & WIRE_FLAG_JUST_PRESSED) ? "true" : "false",
+                  (state->flags & WIRE_FLAG_TOUCHPAD) ? 1 : 0,
+                  (state->flags & WIRE_FLAG_TOUCHPAD_CHANGED) ? "true" : "false");
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   CHECKS                                   */
+/* -------------------------------------------------------------------------- */
+
+static void check(const wire_state_t *state) {
+  char old[256], new[WIRE_STATE_JSON_MAX_SIZE];
+  compared++;
+  int old_len = old_json(old, sizeof(old), state);
+  size_t new_len = WIRE_ENCODE_STATE_JSON(new, state);
+  CHECK(new_len == (size_t)old_len && strcmp(old, new) == 0, "old %s\n  new %s", old, new);
+  CHECK(new_len < WIRE_STATE_JSON_MAX_SIZE, "%zu bytes for a %zu-byte bound", new_len,
+        (size_t)WIRE_STATE_JSON_MAX_SIZE);
+}
+
+static uint64_t next(uint64_t *seed) {
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return *seed;
+}
+
+static void random_state(uint64_t *seed, wire_state_t *state) {
+  uint64_t bits = next(seed);
+  state->joystick_xstate = bits;
+  state->joystick_ystate = bits >> 16;
+  state->buttons = bits >> 32;
+  state->flags = bits >> 48;
+  // every magnitude, not just the huge ones uniform bits give
+  int shift = next(seed) % 64;
+  state->time_us = (int64_t)(next(seed) >> shift) * ((bits >> 56) & 1 ? -1 : 1);
+}
+
+static void check_edges(void) {
+  for (int flags = 0; flags <= 0xff; flags++) check(&(wire_state_t){.flags = flags});
+  const int16_t axes[] = {INT16_MIN, INT16_MIN + 1, -10000, -100, -99, -1, 0, 1, 99, 100, 10000, INT16_MAX};
+  for (size_t x = 0; x < sizeof(axes) / sizeof(axes[0]); x++) {
+    for (size_t y = 0; y < sizeof(axes) / sizeof(axes[0]); y++) {
+      check(&(wire_state_t){.joystick_xstate = axes[x], .joystick_ystate = axes[y]});
+    }
+  }
+  for (int bit = 0; bit < 16; bit++) check(&(wire_state_t){.buttons = 1 << bit});
+  check(&(wire_state_t){.buttons = 0xffff});
+  const int64_t times[] = {0, 1, -1, INT32_MAX, (int64_t)UINT32_MAX, (int64_t)UINT32_MAX + 1, -(int64_t)UINT32_MAX - 1,
+                           999999999, 1000000000, 999999999999999999, 1000000000000000000, INT64_MAX, INT64_MIN,
+                           INT64_MIN + 1};
+  for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+    check(&(wire_state_t){.time_us = times[i]});
+  }
+  int64_t power = 1;
+  for (int digits = 1; digits <= 18; digits++, power *= 10) {
+    for (int64_t t = power - 2; t <= power + 1; t++) {
+      check(&(wire_state_t){.time_us = t});
+      check(&(wire_state_t){.time_us = -t});
+    }
+  }
+  // and the longest possible message
+  check(&(wire_state_t){.joystick_xstate = INT16_MIN, .joystick_ystate = INT16_MIN, .buttons = 0xffff,
+                        .flags = WIRE_FLAG_TOUCHPAD, .time_us = INT64_MIN});
+}
+
+static void check_rejects(void) {
+  char buf[WIRE_STATE_JSON_MAX_SIZE];
+  wire_state_t state = {0};
+  CHECK(wire_encode_state_json(buf, sizeof(buf) - 1, &state) == 0, "encoded into a short buffer");
+  CHECK(wire_encode_state_json(buf, 0, &state) == 0, "encoded into no buffer");
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  BENCHMARK                                 */
+/* -------------------------------------------------------------------------- */
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(void) {
+  enum { SAMPLES = 1 << 22 };
+  static wire_state_t states[4096];
+  uint64_t seed = 7;
+  for (int i = 0; i < 4096; i++) {
+    random_state(&seed, &states[i]);
+    // what a running board sends: a positive timestamp, hours in
+    states[i].time_us = 3600000000LL + (int64_t)(next(&seed) % 3600000000LL);
+  }
+
+  char message[256];
+  volatile size_t sink = 0;
+  double start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) sink += old_json(message, sizeof(message), &states[i & 4095]);
+  double old_ns = (now_ns() - start) / SAMPLES;
+
+  start = now_ns();
+  for (int i = 0; i < SAMPLES; i++) sink += WIRE_ENCODE_STATE_JSON(message, &states[i & 4095]);
+  double new_ns = (now_ns() - start) / SAMPLES;
+
+  printf("ns per message: snprintf %.1f, wire_encode_state_json %.1f (host, -O2)\n", old_ns, new_ns);
+}
+
+int main(int argc, char **argv) {
+  int randoms = argc > 1 ? atoi(argv[1]) : 1000000;
+  uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : 1;
+  if (seed == 0) seed = 1;
+
+  check_edges();
+  int edges = compared;
+  wire_state_t state;
+  for (int i = 0; i < randoms; i++) {
+    random_state(&seed, &state);
+    check(&state);
+  }
+  check_rejects();
+  printf("%d edge states and %d random states against snprintf\n", edges, randoms);
+  bench();
+  printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    printf("FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * wire_test.cpp
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ *
+ * Encodes controller states with the firmware's wire.c and decodes them
+ * again with wire_decode.h, checking every field comes back as it went in.
+ *
+ *   cc -std=gnu11 -O2 -Wall -Wextra -I../main/include -c -o wire.o ../main/src/wire.c
+ *   c++ -std=c++17 -O2 -Wall -Wextra -I../main/include -o wire_test wire_test.cpp wire.o
+ *   ./wire_test
+ *
+ * Covers every flag bit and every combination of the known ones, the full
+ * joystick range and both int16 extremes, every button bit, the sequence
+ * number wrapping, and the timestamp wrapping at 32 bits. The JSON encoder
+ * is checked against known messages here; wire_json_test.c checks it
+ * against the sprintf it replaced. Exits non-zero on the first few
+ * mismatches.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "wire_decode.h"
+
+namespace {
+
+int failures = 0;
+int checks = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    checks++;                                     \
+    if (!(cond) && failures++ < 10) {             \
+      std::printf("%s:%d: ", __FILE__, __LINE__); \
+      std::printf(__VA_ARGS__);                   \
+      std::printf("\n");                          \
+    }                                             \
+  } while (0)
+
+/**
+ * Encodes a state, decodes it, and checks it made the trip intact.
+ */
+std::optional<wire::State> round_trip(uint16_t seq, const wire_state_t &in) {
+  uint8_t frame[WIRE_STATE_V1_SIZE];
+  size_t len = wire_encode_state(frame, sizeof(frame), seq, &in);
+  CHECK(len == WIRE_STATE_V1_SIZE, "encoded %zu bytes", len);
+  auto out = wire::decode_state(frame, len);
+  CHECK(out.has_value(), "seq %u did not decode", seq);
+  if (!out) return out;
+  CHECK(out->version == WIRE_BINARY_V1, "version %u", out->version);
+  CHECK(out->seq == seq, "seq %u came back %u", seq, out->seq);
+  CHECK(out->flags == in.flags, "flags %02x came back %02x", in.flags, out->flags);
+  CHECK(out->buttons == in.buttons, "buttons %04x came back %04x", in.buttons, out->buttons);
+  CHECK(out->x == in.joystick_xstate, "x %d came back %d", in.joystick_xstate, out->x);
+  CHECK(out->y == in.joystick_ystate, "y %d came back %d", in.joystick_ystate, out->y);
+  CHECK(out->time_us == uint32_t(in.time_us), "time %lld came back %u", (long long)in.time_us, out->time_us);
+  return out;
+}
+
+void check_flags() {
+  constexpr uint8_t KNOWN =
+      WIRE_FLAG_JUST_PRESSED | WIRE_FLAG_TOUCHPAD | WIRE_FLAG_TOUCHPAD_CHANGED | WIRE_FLAG_JOYSTICK_PRESSED;
+  // the whole byte, so bits nobody has defined yet still survive the trip
+  for (int flags = 0; flags <= 0xff; flags++) {
+    wire_state_t in{};
+    in.flags = flags;
+    auto out = round_trip(flags, in);
+    if (!out) continue;
+    CHECK(out->just_pressed() == bool(flags & WIRE_FLAG_JUST_PRESSED), "just_pressed for %02x", flags);
+    CHECK(out->touchpad() == bool(flags & WIRE_FLAG_TOUCHPAD), "touchpad for %02x", flags);
+    CHECK(out->touchpad_changed() == bool(flags & WIRE_FLAG_TOUCHPAD_CHANGED), "touchpad_changed for %02x", flags);
+    CHECK(out->joystick_pressed() == bool(flags & WIRE_FLAG_JOYSTICK_PRESSED), "joystick_pressed for %02x", flags);
+  }
+  // and each known flag is its own bit
+  for (int bit = 0; bit < 8; bit++) {
+    uint8_t flag = 1 << bit;
+    int named = 0;
+    for (uint8_t known : {WIRE_FLAG_JUST_PRESSED, WIRE_FLAG_TOUCHPAD, WIRE_FLAG_TOUCHPAD_CHANGED,
+                          WIRE_FLAG_JOYSTICK_PRESSED}) {
+      named += known == flag;
+    }
+    CHECK(named == bool(KNOWN & flag), "bit %d is named %d times", bit, named);
+  }
+}
+
+void check_axes() {
+  for (int x = -100; x <= 100; x++) {
+    wire_state_t in{};
+    in.joystick_xstate = x;
+    in.joystick_ystate = -x;
+    round_trip(0, in);
+  }
+  for (int extreme : {INT16_MIN, INT16_MIN + 1, -1, 0, INT16_MAX}) {
+    wire_state_t in{};
+    in.joystick_xstate = extreme;
+    in.joystick_ystate = extreme;
+    round_trip(0, in);
+  }
+}
+
+void check_buttons() {
+  for (int bit = 0; bit < 16; bit++) {
+    wire_state_t in{};
+    in.buttons = 1 << bit;
+    round_trip(0, in);
+  }
+  wire_state_t in{};
+  in.buttons = 0xffff;
+  round_trip(0, in);
+}
+
+void check_seq() {
+  // through the wrap one at a time: nothing lost
+  uint16_t last = 0;
+  for (uint32_t i = 0; i < 20; i++) {
+    uint16_t seq = uint16_t(0xfff6 + i);
+    auto out = round_trip(seq, wire_state_t{});
+    if (!out) continue;
+    if (i) CHECK(wire::frames_lost(last, out->seq) == 0, "%u after %u counted as a loss", out->seq, last);
+    last = out->seq;
+  }
+  // and across it with frames missing
+  CHECK(wire::frames_lost(0xfffd, 0x0002) == 4, "lost %u across the wrap", wire::frames_lost(0xfffd, 0x0002));
+  CHECK(wire::frames_lost(0xffff, 0x0000) == 0, "0 after 0xffff counted as a loss");
+  CHECK(wire::frames_lost(5, 5) == 0xffff, "a repeat is not near 65535");
+}
+
+void check_time() {
+  // the frame keeps the low 32 bits; unwrap_time puts them back from a
+  // nearby full timestamp on either side of the 32-bit wrap
+  const int64_t wrap = int64_t(1) << 32;
+  for (int64_t t : {int64_t(0), int64_t(1), wrap - 1, wrap, wrap + 1, 3 * wrap - 5, int64_t(1) << 40,
+                    int64_t(1) << 62}) {
+    wire_state_t in{};
+    in.time_us = t;
+    auto out = round_trip(0, in);
+    if (!out) continue;
+    for (int64_t skew : {int64_t(-2000000000), int64_t(-1), int64_t(0), int64_t(1), int64_t(2000000000)}) {
+      int64_t near_us = t + skew;
+      if (near_us < 0) continue;
+      int64_t back = wire::unwrap_time(out->time_us, near_us);
+      CHECK(back == t, "time %lld unwrapped near %lld to %lld", (long long)t, (long long)near_us, (long long)back);
+    }
+  }
+}
+
+void check_rejects() {
+  uint8_t frame[WIRE_STATE_V1_SIZE + 1];
+  wire_state_t in{};
+  CHECK(wire_encode_state(frame, WIRE_STATE_V1_SIZE - 1, 0, &in) == 0, "encoded into a short buffer");
+  wire_encode_state(frame, sizeof(frame), 0, &in);
+  for (size_t len = 0; len < WIRE_STATE_V1_SIZE; len++) {
+    CHECK(!wire::decode_state(frame, len), "a %zu-byte frame decoded", len);
+  }
+  CHECK(wire::decode_state(frame, sizeof(frame)).has_value(), "a longer frame did not decode");
+  frame[0] = WIRE_HEADER(WIRE_BINARY_V1, WIRE_KIND_TRACE);
+  CHECK(!wire::decode_state(frame, WIRE_STATE_V1_SIZE), "a trace frame decoded as a state");
+  frame[0] = WIRE_HEADER(WIRE_BINARY_V1 + 1, WIRE_KIND_STATE);
+  CHECK(!wire::decode_state(frame, WIRE_STATE_V1_SIZE), "an unknown version decoded");
+}
+
+/**
+ * Encodes a state as JSON and checks it comes out as `expected`.
+ */
+void json(const wire_state_t &in, const char *expected) {
+  char message[WIRE_STATE_JSON_MAX_SIZE];
+  size_t len = wire_encode_state_json(message, sizeof(message), &in);
+  CHECK(len == std::strlen(expected) && std::strcmp(message, expected) == 0, "JSON %s\n  expected %s", message,
+        expected);
+}
+
+void check_json() {
+  json(wire_state_t{}, R"({"type":"controller_state","t":0,"data":[0.00, 0.00, 0, false, 0, false]})");
+  wire_state_t in{};
+  in.joystick_xstate = -5;
+  in.joystick_ystate = 100;
+  in.buttons = 3;
+  in.flags = WIRE_FLAG_JUST_PRESSED | WIRE_FLAG_TOUCHPAD;
+  in.time_us = 4294967296;
+  json(in, R"({"type":"controller_state","t":4294967296,"data":[-0.05, 1.00, 3, true, 1, false]})");
+  // flags JSON has no field for stay out of it
+  in.flags = WIRE_FLAG_TOUCHPAD_CHANGED | WIRE_FLAG_JOYSTICK_PRESSED;
+  json(in, R"({"type":"controller_state","t":4294967296,"data":[-0.05, 1.00, 3, false, 0, true]})");
+  // the longest message there is, which has to fit exactly
+  in.joystick_xstate = in.joystick_ystate = INT16_MIN;
+  in.buttons = 0xffff;
+  in.flags = WIRE_FLAG_TOUCHPAD;
+  in.time_us = INT64_MIN;
+  const char *longest =
+      R"({"type":"controller_state","t":-9223372036854775808,"data":[-327.68, -327.68, 65535, false, 1, false]})";
+  json(in, longest);
+  CHECK(std::strlen(longest) + 1 == WIRE_STATE_JSON_MAX_SIZE, "the longest message is %zu bytes, the bound %zu",
+        std::strlen(longest) + 1, size_t(WIRE_STATE_JSON_MAX_SIZE));
+  in.joystick_xstate = in.joystick_ystate = INT16_MAX;
+  in.flags = 0xff;
+  in.time_us = INT64_MAX;
+  json(in, R"({"type":"controller_state","t":9223372036854775807,"data":[327.67, 327.67, 65535, true, 1, true]})");
+  // a buffer that could not hold the longest message is refused outright
+  char message[WIRE_STATE_JSON_MAX_SIZE];
+  CHECK(wire_encode_state_json(message, sizeof(message) - 1, &in) == 0, "JSON encoded into a short buffer");
+}
+
+}  // namespace
+
+int main() {
+  check_flags();
+  check_axes();
+  check_buttons();
+  check_seq();
+  check_time();
+  check_rejects();
+  check_json();
+  std::printf("%d checks, %d failed\n", checks, failures);
+  if (failures) {
+    std::printf("FAILED\n");
+    return 1;
+  }
+  std::printf("ok\n");
+  return 0;
+}
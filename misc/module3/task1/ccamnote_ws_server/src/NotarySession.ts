@@ -4,8 +4,25 @@
  * created on Sun Oct 30 2022
  * 2022 the nobot space,
  */
+import fs from "fs";
+import path from "path";
 import short from "short-uuid";
 import type { WebSocket } from "ws";
+import {
+  decodeControllerState,
+  encodeImageAck,
+  IMAGE_MAX_SIZE,
+  ImageAssembler,
+  isImageChunk,
+  isTraceFrame,
+  TraceAssembler,
+  WIRE_VERSIONS,
+} from "./wire";
+
+// where controllers' trace dumps are saved, as trace_<uid>.bin
+const TRACE_DIR = path.join(__dirname, "..", "public");
+// where a camera's pictures are saved, the same file the HTTP upload writes
+const IMAGE_PATH = path.join(__dirname, "..", "public", "image.jpg");
 
 /* -------------------------------------------------------------------------- */
 /*                                   TYPINGS                                  */
@@ -33,6 +50,9 @@ enum MessageType {
   ClientType = "client_type",
   ControllerState = "controller_state",
   ConnectToController = "connect_to_controller",
+  Wire = "wire",
+  Trace = "trace",
+  CameraUpload = "camera_upload",
 }
 
 /* -------------------------------------------------------------------------- */
@@ -49,6 +69,10 @@ export default class NotarySession {
   camerasMAC: string[] = []; // these are MAC addresses instead
   // keep track of which consumers are connected to which controllers
   controller_consumers: { [key: string]: string[] } = {};
+  // trace dumps coming in from controllers, piece by piece
+  traces: Record<string, TraceAssembler> = {};
+  // pictures coming in from cameras over the websocket, chunk by chunk
+  images: Record<string, ImageAssembler> = {};
 
   constructor() {
     this.sockets = {};
@@ -56,6 +80,8 @@ export default class NotarySession {
     this.controllers = [];
     this.camerasMAC = [];
     this.controller_consumers = {};
+    this.traces = {};
+    this.images = {};
   }
 
   /* -------------------------------------------------------------------------- */
@@ -71,13 +97,29 @@ export default class NotarySession {
     );
 
     // attach the server data listener
-    ws.on("message", (data) => {
+    ws.on("message", (data, isBinary) => {
+      // binary messages are controller states in the negotiated wire format,
+      // trace dumps a controller was asked for, or pictures from a camera
+      if (isBinary) {
+        if (isTraceFrame(data as Buffer)) {
+          this.receiveTrace(uid, data as Buffer);
+          return;
+        }
+        if (isImageChunk(data as Buffer)) {
+          this.receiveImageChunk(uid, data as Buffer);
+          return;
+        }
+        const state = decodeControllerState(data as Buffer);
+        if (state) this.broadcastControllerState(uid, state.data);
+        return;
+      }
       const packet = JSON.parse(data.toString());
       switch (packet.type as MessageType) {
         case MessageType.ClientType:
           switch (packet.data) {
             case "controller":
               this.addController(uid);
+              this.negotiateWire(uid, packet.wire);
               break;
             case "camera":
               this.addCamera(uid);
@@ -96,6 +138,12 @@ export default class NotarySession {
         case MessageType.ConnectToController:
           this.connectToController(uid, packet.data);
           break;
+        case MessageType.Trace:
+          this.requestTrace(packet.data, packet.to);
+          break;
+        case MessageType.CameraUpload:
+          this.setCameraUpload(packet.data);
+          break;
       }
     });
 
@@ -125,6 +173,20 @@ export default class NotarySession {
     });
   }
 
+  /**
+   * Picks the newest binary wire format both sides speak. Controllers that
+   * offer none, or none we know, keep sending JSON.
+   * @param uid
+   * @param offered The wire versions the controller listed, if any
+   */
+  negotiateWire(uid: string, offered?: number[]) {
+    if (!Array.isArray(offered)) return;
+    const version = Math.max(0, ...offered.filter((v) => WIRE_VERSIONS.includes(v)));
+    if (!version) return;
+    console.log(`[${uid}] speaking binary wire format v${version}.`);
+    this.sockets[uid].send(JSON.stringify({ type: MessageType.Wire, data: version }));
+  }
+
   /**
    * Adds a consumer to the current websocket session.
    * @param uid
@@ -206,6 +268,84 @@ export default class NotarySession {
     if (curr_index === -1) this.controller_consumers[cid].push(uid);
   }
 
+  /* -------------------------------------------------------------------------- */
+  /*                                EVENT: trace                                */
+  /* -------------------------------------------------------------------------- */
+
+  /**
+   * Asks a controller for a dump of its trace ring.
+   * @param cid The controller
+   * @param to "serial" to have it printed on the controller's console
+   * instead of sent back here
+   */
+  requestTrace(cid: string, to?: string) {
+    if (!this.controllers.includes(cid)) return;
+    console.log(`[${cid}] asked for a trace${to === "serial" ? " on serial" : ""}.`);
+    this.sockets[cid].send(
+      JSON.stringify(to === "serial" ? { type: MessageType.Trace, to } : { type: MessageType.Trace })
+    );
+  }
+
+  /**
+   * Collects a controller's trace dump, and saves it once it is all in.
+   * @param uid
+   * @param frame A trace frame
+   */
+  receiveTrace(uid: string, frame: Buffer) {
+    // only controllers are asked for traces; anyone else's frames are not taken on
+    if (!this.controllers.includes(uid)) return;
+    if (!this.traces[uid]) this.traces[uid] = new TraceAssembler();
+    const dump = this.traces[uid].add(frame);
+    if (!dump) return;
+    const filePath = path.join(TRACE_DIR, `trace_${uid}.bin`);
+    fs.writeFile(filePath, dump, () => {
+      console.log(`[${uid}] trace of ${dump.byteLength} bytes written to ${filePath}`);
+    });
+  }
+
+  /* -------------------------------------------------------------------------- */
+  /*                            EVENT: camera_upload                            */
+  /* -------------------------------------------------------------------------- */
+
+  /**
+   * Switches how every camera uploads its pictures, to compare the two.
+   * @param transport "http" or "websocket"
+   */
+  setCameraUpload(transport: string) {
+    if (transport !== "http" && transport !== "websocket") return;
+    console.log(`- Cameras now uploading over ${transport}.`);
+    this.camerasMAC.forEach((camera) => {
+      this.sockets[camera].send(`upload_${transport}`);
+    });
+  }
+
+  /**
+   * Collects a picture a camera sends over the websocket, acknowledging
+   * every chunk so the camera can send more, and saves it once it is all in.
+   * @param uid
+   * @param frame An image chunk
+   */
+  receiveImageChunk(uid: string, frame: Buffer) {
+    // only cameras send pictures; anyone else's chunks are not taken on
+    if (!this.camerasMAC.includes(uid)) return;
+    if (!this.images[uid]) this.images[uid] = new ImageAssembler();
+    const assembler = this.images[uid];
+    const chunk = assembler.add(frame);
+    if (!chunk) {
+      if (frame.readUInt32LE(4) === 0) {
+        console.log(`[${uid}] dropped an image of ${frame.readUInt32LE(8)} bytes (at most ${IMAGE_MAX_SIZE}).`);
+      }
+      return;
+    }
+    const { id, received, image } = chunk;
+    this.sockets[uid].send(encodeImageAck(id, received));
+    if (!image) return;
+    console.log(`[${uid}] image ${id} of ${image.byteLength} bytes in ${Date.now() - assembler.started} ms over websocket.`);
+    fs.writeFile(IMAGE_PATH, image, () => {
+      console.log(`Image written to ${IMAGE_PATH}`);
+    });
+  }
+
   /* -------------------------------------------------------------------------- */
   /*                              DISCONNECT EVENT                              */
   /* -------------------------------------------------------------------------- */
@@ -239,11 +379,13 @@ export default class NotarySession {
       if (controller_i !== -1) {
         this.controllers.splice(controller_i, 1);
         delete this.controller_consumers[uid];
+        delete this.traces[uid];
       }
       // if it was a camera, remove it from the camera
       const camera_i = this.camerasMAC.indexOf(uid);
       if (camera_i !== -1) {
         this.camerasMAC.splice(camera_i, 1);
+        delete this.images[uid];
       }
       console.log(
         `- Cameras: (${this.camerasMAC.length}), Controllers: (${this.controllers.length}), Consumers: (${this.consumers.length})`
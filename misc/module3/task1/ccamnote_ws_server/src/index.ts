@@ -19,11 +19,14 @@ app.use(express.static(path.join(ROOT, "public")));
 // listen for image POST uploads at /image
 app.post("/image", (req, res) => {
   console.log("Image posted...");
-  let data = Buffer.from([]);
-  req.on("data", function (chunk) {
-    data = Buffer.concat([data, chunk]);
+  // the camera streams the image in chunks; keep them and join them once,
+  // rather than copying everything so far on every chunk
+  const chunks: Buffer[] = [];
+  req.on("data", function (chunk: Buffer) {
+    chunks.push(chunk);
   });
   req.on("end", function () {
+    const data = Buffer.concat(chunks);
     const filePath = path.join(ROOT, "public", "image.jpg");
     console.log(data.byteLength);
     fs.writeFile(filePath, data, () => {
@@ -34,6 +37,10 @@ app.post("/image", (req, res) => {
 });
 
 const server = app.listen(PORT, () => console.log(`Listening on ${PORT}`));
+// the camera keeps its upload connection open between pictures; node's
+// default of 5 s would close it between most of them
+server.keepAliveTimeout = 65 * 1000;
+server.headersTimeout = 66 * 1000;
 
 /* ------------------------------- WEB SOCKET ------------------------------- */
 
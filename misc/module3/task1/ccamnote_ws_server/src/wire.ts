@@ -0,0 +1,210 @@
+/*
+ * wire.ts
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+/* -------------------------------------------------------------------------- */
+/*                                   FORMAT                                   */
+/* -------------------------------------------------------------------------- */
+
+// mirrors wire.h in the controller. all fields are little-endian:
+//
+//   offset  size  field
+//   0       1     header, version << 4 | kind
+//   1       1     flags, WireFlag
+//   2       2     sequence number, +1 per frame, wraps
+//   4       2     button bitmask
+//   6       2     joystick x, signed hundredths (-100..100)
+//   8       2     joystick y, signed hundredths (-100..100)
+//   10      4     low 32 bits of the controller's microsecond clock at sampling
+
+// the binary wire versions this server can decode, offered back to
+// controllers that list them in their client_type message
+export const WIRE_VERSIONS = [1];
+
+const WIRE_KIND_STATE = 0x1;
+const WIRE_KIND_TRACE = 0x2;
+const WIRE_KIND_IMAGE = 0x3;
+const WIRE_STATE_V1_SIZE = 14;
+
+// an image chunk from a camera, as laid out in wifi_ws_client.h in the
+// camera: image id at offset 2, where the chunk goes at 4, the image's size
+// at 8, and the camera's clock when it was taken at 12, then the chunk
+const IMAGE_CHUNK_HEADER_SIZE = 16;
+// the largest image taken on. a UXGA JPEG from the camera is a few hundred
+// KB at most, so anything past this is not a picture, and is not allocated
+export const IMAGE_MAX_SIZE = 4 * 1024 * 1024;
+// the camera's opcode for acknowledging image bytes, see camera_commands.h
+const CAMERA_COMMAND_IMAGE_ACK = 0x06;
+
+// a trace dump's header, as laid out in trace.h in the controller: "TRC1"
+// at offset 0, how long one event is at offset 6, and how many events follow
+// at offset 16
+const TRACE_DUMP_HEADER_SIZE = 56;
+const TRACE_DUMP_MAGIC = 0x31435254;
+// the largest dump taken on. the ring is in the controller's DRAM at 28 bytes
+// an event, so a real dump is tens of KB, and anything past this is not one
+export const TRACE_DUMP_MAX_SIZE = 1024 * 1024;
+
+export enum WireFlag {
+  JustPressed = 1 << 0,
+  Touchpad = 1 << 1,
+  TouchpadChanged = 1 << 2,
+  JoystickPressed = 1 << 3,
+}
+
+export type WireState = {
+  seq: number;
+  t: number;
+  // same order as the JSON controller_state data array
+  data: [number, number, number, boolean, number, boolean];
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  DECODING                                  */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Whether a binary frame carries a piece of a trace dump.
+ * @param frame The binary websocket message
+ */
+export function isTraceFrame(frame: Buffer): boolean {
+  return frame.length >= 1 && (frame[0] & 0xf) === WIRE_KIND_TRACE;
+}
+
+/**
+ * Joins up the pieces of a trace dump, which come one per trace frame.
+ * The dump is passed on whole to tools/trace_decode in the controller's
+ * trace component, so nothing past its header is looked at here. A dump
+ * without the magic, or of more than TRACE_DUMP_MAX_SIZE, is dropped whole.
+ */
+export class TraceAssembler {
+  private chunks: Buffer[] = [];
+  private length = 0;
+
+  /**
+   * Adds the next trace frame.
+   * @param frame The binary websocket message
+   * @returns The whole dump once its last piece is in, null until then
+   */
+  add(frame: Buffer): Buffer | null {
+    this.chunks.push(frame.subarray(1));
+    this.length += frame.length - 1;
+    if (this.length < 4) return null;
+    const dump = Buffer.concat(this.chunks);
+    if (dump.readUInt32LE(0) !== TRACE_DUMP_MAGIC) return this.drop();
+    if (this.length < TRACE_DUMP_HEADER_SIZE) return null;
+    const size = TRACE_DUMP_HEADER_SIZE + dump.readUInt16LE(6) * dump.readUInt32LE(16);
+    if (size > TRACE_DUMP_MAX_SIZE) return this.drop();
+    if (dump.length < size) return null;
+    this.chunks = [];
+    this.length = 0;
+    return dump.subarray(0, size);
+  }
+
+  private drop(): null {
+    this.chunks = [];
+    this.length = 0;
+    return null;
+  }
+}
+
+/**
+ * Whether a binary frame carries a chunk of a camera's image.
+ * @param frame The binary websocket message
+ */
+export function isImageChunk(frame: Buffer): boolean {
+  return frame.length >= IMAGE_CHUNK_HEADER_SIZE && (frame[0] & 0xf) === WIRE_KIND_IMAGE;
+}
+
+/**
+ * Builds the camera's acknowledgement of an image's bytes.
+ * @param id The image
+ * @param received How many of its bytes are in, from the start
+ */
+export function encodeImageAck(id: number, received: number): Buffer {
+  const ack = Buffer.alloc(7);
+  ack[0] = CAMERA_COMMAND_IMAGE_ACK;
+  ack.writeUInt16LE(id, 1);
+  ack.writeUInt32LE(received, 3);
+  return ack;
+}
+
+/**
+ * Puts a camera's image back together from its chunks, which come in
+ * order. A chunk of a new image drops whatever was left of the one before.
+ * An image of no bytes, or of more than IMAGE_MAX_SIZE, is dropped whole.
+ */
+export class ImageAssembler {
+  private id = -1;
+  private image = Buffer.alloc(0);
+  private received = 0;
+  // when the image's first chunk came in, for how long it took
+  started = 0;
+
+  /**
+   * Adds the next image chunk.
+   * @param frame The binary websocket message
+   * @returns The image id and how many of its bytes are in, with the image
+   * itself once it is whole, or null if the image is being dropped
+   */
+  add(frame: Buffer): { id: number; received: number; image?: Buffer } | null {
+    const id = frame.readUInt16LE(2);
+    const offset = frame.readUInt32LE(4);
+    const size = frame.readUInt32LE(8);
+    if (id !== this.id || offset === 0) {
+      if (size === 0 || size > IMAGE_MAX_SIZE) {
+        this.id = -1;
+        this.image = Buffer.alloc(0);
+        this.received = 0;
+        return null;
+      }
+      this.id = id;
+      this.image = Buffer.alloc(size);
+      this.received = 0;
+      this.started = Date.now();
+    }
+    const chunk = frame.subarray(IMAGE_CHUNK_HEADER_SIZE);
+    // out of order, or past the end: keep what is in, and let the camera time out
+    if (offset !== this.received || offset + chunk.length > this.image.length) {
+      return { id, received: this.received };
+    }
+    chunk.copy(this.image, offset);
+    this.received += chunk.length;
+    if (this.received < this.image.length) return { id, received: this.received };
+    return { id, received: this.received, image: this.image };
+  }
+}
+
+/**
+ * Decodes a binary controller state frame.
+ * @param frame The binary websocket message
+ * @returns The state, or null if the frame is not a state frame this server understands
+ */
+export function decodeControllerState(frame: Buffer): WireState | null {
+  if (frame.length < 1) return null;
+  const version = frame[0] >> 4;
+  const kind = frame[0] & 0xf;
+  if (kind !== WIRE_KIND_STATE) return null;
+  switch (version) {
+    case 1: {
+      if (frame.length < WIRE_STATE_V1_SIZE) return null;
+      const flags = frame[1];
+      return {
+        seq: frame.readUInt16LE(2),
+        t: frame.readUInt32LE(10),
+        data: [
+          frame.readInt16LE(6) / 100,
+          frame.readInt16LE(8) / 100,
+          frame.readUInt16LE(4),
+          (flags & WireFlag.JustPressed) !== 0,
+          flags & WireFlag.Touchpad ? 1 : 0,
+          (flags & WireFlag.TouchpadChanged) !== 0,
+        ],
+      };
+    }
+    default:
+      return null;
+  }
+}
@@ -0,0 +1,73 @@
+/*
+ * adc_sampler.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "driver/adc.h"
+#include "config.h"
+#include "mailbox.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   CONFIG                                   */
+/* -------------------------------------------------------------------------- */
+
+// conversions per second across all channels. the ESP32 runs continuous mode
+// between 20 kHz and 2 MHz.
+#ifndef CONFIG_ADC_SAMPLE_FREQ_HZ
+#define CONFIG_ADC_SAMPLE_FREQ_HZ (20 * 1000)
+#endif
+
+// conversions per DMA block. one block becomes one frame, so at 20 kHz a
+// block of 64 conversions gives a new frame every 3.2 ms.
+#ifndef CONFIG_ADC_FRAME_CONVERSIONS
+#define CONFIG_ADC_FRAME_CONVERSIONS (64)
+#endif
+
+// 1 = each frame holds the mean of every reading of a channel in its DMA
+// block, 0 = only the newest one. at the defaults that averages 32 readings
+// per axis, which takes most of the SAR noise out before any filtering.
+#ifndef CONFIG_ADC_OVERSAMPLE
+#define CONFIG_ADC_OVERSAMPLE (1)
+#endif
+
+// the most channels a single sampler can scan
+#define ADC_SAMPLER_MAX_CHANNELS (8)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint16_t raw[ADC_SAMPLER_MAX_CHANNELS];  // 12-bit reading, in channel order, see CONFIG_ADC_OVERSAMPLE
+  int64_t time_us;                         // when the DMA block behind this frame completed
+  uint32_t seq;                            // frame number, counting from 1
+} adc_frame_t;
+
+typedef struct {
+  uint32_t frames;         // frames handed out
+  uint32_t conversions;    // conversions read back from DMA
+  uint32_t overruns;       // times the DMA pool filled up before it was read
+  uint32_t rate_hz;        // measured conversions per second since start
+  uint32_t period_us;      // frame period the hardware was asked for
+  int32_t jitter_min_us;   // shortest frame interval, minus period_us
+  int32_t jitter_max_us;   // longest frame interval, minus period_us
+} adc_sampler_stats_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// configures ADC1 once and starts sampling `channels` in continuous DMA mode.
+// returns the mailbox that frames are posted to, or NULL on failure.
+mailbox_t *adc_sampler_start(const adc1_channel_t *channels, size_t count, uint32_t notify_bits);
+// copies out the sampler's timing statistics
+void adc_sampler_get_stats(adc_sampler_stats_t *stats);
+
+#endif /* ADC_SAMPLER_H */
@@ -0,0 +1,83 @@
+/*
+ * axis_filter.h
+ * created on Sat Oct 17 2026
+ * 2026 the nobot space,
+ */
+
+#ifndef AXIS_FILTER_H
+#define AXIS_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+
+/* -------------------------------------------------------------------------- */
+/*                                   CONFIG                                   */
+/* -------------------------------------------------------------------------- */
+
+// readings the median is taken over, odd. 1 turns the median off.
+#ifndef CONFIG_AXIS_FILTER_MEDIAN
+#define CONFIG_AXIS_FILTER_MEDIAN (3)
+#endif
+
+// one-pole IIR strength: each reading moves the output 1/2^shift of the way
+// toward it. 0 turns the IIR off.
+#ifndef CONFIG_AXIS_FILTER_IIR_SHIFT
+#define CONFIG_AXIS_FILTER_IIR_SHIFT (2)
+#endif
+
+// how far, in 12-bit counts, the filtered reading has to move away from the
+// last output before the output follows it. 0 turns hysteresis off.
+#ifndef CONFIG_AXIS_FILTER_HYSTERESIS
+#define CONFIG_AXIS_FILTER_HYSTERESIS (24)
+#endif
+
+// the longest median window a filter can keep
+#define AXIS_FILTER_MAX_MEDIAN (7)
+// the largest reading an axis can produce
+#define AXIS_FILTER_MAX_READING (4095)
+
+/* -------------------------------------------------------------------------- */
+/*                                    TYPES                                   */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  uint8_t median;       // readings per median, odd, 1 = off
+  uint8_t iir_shift;    // IIR strength, 0 = off
+  uint16_t hysteresis;  // counts the output holds still for, 0 = off
+} axis_filter_config_t;
+
+#define AXIS_FILTER_CONFIG_DEFAULT() {               \
+    .median = CONFIG_AXIS_FILTER_MEDIAN,             \
+    .iir_shift = CONFIG_AXIS_FILTER_IIR_SHIFT,       \
+    .hysteresis = CONFIG_AXIS_FILTER_HYSTERESIS,     \
+}
+
+typedef struct {
+  uint32_t readings;  // readings fed in
+  uint32_t changes;   // readings that moved the output
+  uint32_t held;      // readings that differed from the output but did not move it
+} axis_filter_stats_t;
+
+typedef struct {
+  axis_filter_config_t config;
+  uint16_t window[AXIS_FILTER_MAX_MEDIAN];  // the last `median` readings, oldest overwritten first
+  uint8_t next;                             // where the next reading goes in window
+  uint8_t filled;                           // readings in window so far
+  int32_t smooth;                           // IIR state, scaled up by 2^iir_shift
+  uint16_t output;                          // the last value handed out
+  bool primed;                              // whether any reading has been seen yet
+  axis_filter_stats_t stats;
+} axis_filter_t;
+
+/* -------------------------------------------------------------------------- */
+/*                                  TEMPLATES                                 */
+/* -------------------------------------------------------------------------- */
+
+// resets a filter, clamping the config to what it supports
+void axis_filter_init(axis_filter_t *filter, const axis_filter_config_t *config);
+// feeds one 12-bit reading through the filter, returning the filtered reading
+uint16_t axis_filter_update(axis_filter_t *filter, uint16_t raw);
+
+#endif /* AXIS_FILTER_H */
@@ -15,6 +15,18 @@
 #define CONFIG_PIN_JOYSTICK_2_VRX ADC1_CHANNEL_4 // GPIO32, using ADC1_4
 #define CONFIG_PIN_JOYSTICK_2_VRY ADC1_CHANNEL_5 // GPIO33, using ADC1_5
 #define CONFIG_PIN_JOYSTICK_2_SW 0               // Unset
+// Joystick ADC sampling, see adc_sampler.h
+#define CONFIG_ADC_SAMPLE_FREQ_HZ (20 * 1000)
+#define CONFIG_ADC_FRAME_CONVERSIONS 64
+#define CONFIG_ADC_OVERSAMPLE 1
+// Joystick noise filtering, see axis_filter.h
+#define CONFIG_AXIS_FILTER_MEDIAN 3
+#define CONFIG_AXIS_FILTER_IIR_SHIFT 2
+#define CONFIG_AXIS_FILTER_HYSTERESIS 24
+// HID reports, see report_scheduler.h. BLE connection intervals are 7.5 ms at
+// the shortest, so faster than 125 Hz only queues reports up in the stack
+#define CONFIG_REPORT_RATE_HZ 125
+#define CONFIG_REPORT_KEEPALIVE_MS 1000
 
 // Standard gamepad button mapping
 /** Right arrow pad (Down, Right, Left, Up) */
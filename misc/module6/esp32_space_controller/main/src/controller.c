@@ -10,7 +10,13 @@
 #include "freertos/FreeRTOS.h"
 #include "button.h"
 #include "bt_helper.h"
+#include "mailbox.h"
+#include "adc_sampler.h"
+#include "axis_filter.h"
+#include "report_scheduler.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <inttypes.h>
 
 // tag for ESP logging
 static const char *TAG = "controller.c";
@@ -20,8 +26,9 @@ static const char *TAG = "controller.c";
 /* -------------------------------------------------------------------------- */
 
 typedef struct {
-  uint8_t pin;
-} button_t;
+  uint16_t state;
+  int64_t time_us;  // when the button change behind this state was sampled
+} buttons_state_t;
 
 // button maps for easy button reference
 #define BUTTON_SELECT (             \
@@ -41,138 +48,198 @@ typedef struct {
     PIN_BIT(CONFIG_PIN_BUTTON_13) | \
     PIN_BIT(CONFIG_PIN_BUTTON_14) | \
     PIN_BIT(CONFIG_PIN_BUTTON_15))
-static const button_t button_idx_map[] = {
-    [0] { CONFIG_PIN_BUTTON_0 },
-    [1] { CONFIG_PIN_BUTTON_1 },
-    [2] { CONFIG_PIN_BUTTON_2 },
-    [3] { CONFIG_PIN_BUTTON_3 },
-    [4] { CONFIG_PIN_BUTTON_4 },
-    [5] { CONFIG_PIN_BUTTON_5 },
-    [6] { CONFIG_PIN_BUTTON_6 },
-    [7] { CONFIG_PIN_BUTTON_7 },
-    [8] { CONFIG_PIN_BUTTON_8 },
-    [9] { CONFIG_PIN_BUTTON_9 },
-    [10] { CONFIG_PIN_BUTTON_10 },
-    [11] { CONFIG_PIN_BUTTON_11 },
-    [12] { CONFIG_PIN_BUTTON_12 },
-    [13] { CONFIG_PIN_BUTTON_13 },
-    [14] { CONFIG_PIN_BUTTON_14 },
-    [15] { CONFIG_PIN_BUTTON_15 },
+// the HID button bit each pin drives, resolved at compile time
+static const uint8_t button_bits[BUTTON_PIN_BITS_SIZE] = {
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_0, 0),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_1, 1),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_2, 2),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_3, 3),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_4, 4),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_5, 5),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_6, 6),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_7, 7),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_8, 8),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_9, 9),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_10, 10),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_11, 11),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_12, 12),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_13, 13),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_14, 14),
+    BUTTON_PIN_BIT_SLOT(CONFIG_PIN_BUTTON_15, 15),
 };
-static const size_t button_idx_map_length = sizeof(button_idx_map) / sizeof(button_t);
 
-// queue into which button events are placed
-static QueueHandle_t button_queue;
+// mailbox holding the newest button state, and the bit its posts set on the controller task
+static mailbox_t *button_state;
+#define BUTTONS_NOTIFY_BIT (1UL << 0)
 
 /**
- * @brief Manages button states across the controller
+ * @brief Publishes button states across the controller
  *
- * When the button press state changes, emits a binary representation of the
- * press state across all of the buttons.
+ * Called by the button scanner whenever the press state changes, with a
+ * binary representation of the press state across all of the buttons. Runs
+ * in the scanner's context; posting to the mailbox never waits.
  *
- * @param pvParameter Placeholder parameter for xTaskCreate
+ * @param state The press state of every button, one bit per button
+ * @param time_us When the change behind the state was sampled
+ * @param arg Placeholder for the state callback argument (unused)
  */
-static void read_buttons_task(void *pvParameter) {
-  // begin esp32-button reading task
-  button_event_t ev;
-  uint16_t button_state = 0;       // current buttons inputs
-  uint16_t last_button_state = 0;  // previous button inputs
-
-  // start button reading queue
-  QueueHandle_t button_events = button_init(BUTTON_SELECT);
-  while (true) {
-    // attempt to read an event from the button queue into ev
-    if (xQueueReceive(button_events, &ev, 20 / portTICK_PERIOD_MS)) {
-      // if successul, search for the matching button pin
-      for (int i = 0; i < button_idx_map_length; i++) {
-        if (button_idx_map[i].pin == ev.pin) {
-          // log the button event, and update button state
-          ESP_LOGD(TAG, "button pin: %d event: %d idx: %d", ev.pin, ev.event, i);
-          if (ev.event == BUTTON_UP) {
-            button_state &= ~(1 << i);
-          } else {
-            button_state |= (1 << i);
-          }
-        }
-      }
-      // emit the button event to the main queue if the button state has changed
-      if (button_state != last_button_state) {
-        xQueueSend(button_queue, &button_state, 20 / portTICK_PERIOD_MS);
-        last_button_state = button_state;
-      }
-    }
-  }
+static void publish_buttons(uint32_t state, int64_t time_us, void *arg) {
+  buttons_state_t emitted = {
+      .state = state,
+      .time_us = time_us,
+  };
+  ESP_LOGD(TAG, "buttons changed: %d", emitted.state);
+  mailbox_post(button_state, &emitted);
 }
 
 /* -------------------------------------------------------------------------- */
 /*                                  JOYSTICKS                                 */
 /* -------------------------------------------------------------------------- */
 
+// where each joystick axis lands in the ADC sampler's frames
+enum { JS1_X_SLOT, JS1_Y_SLOT, JS2_X_SLOT, JS2_Y_SLOT };
+static const adc1_channel_t joystick_channels[] = {
+    [JS1_X_SLOT] = CONFIG_PIN_JOYSTICK_1_VRX,
+    [JS1_Y_SLOT] = CONFIG_PIN_JOYSTICK_1_VRY,
+    [JS2_X_SLOT] = CONFIG_PIN_JOYSTICK_2_VRX,
+    [JS2_Y_SLOT] = CONFIG_PIN_JOYSTICK_2_VRY,
+};
+// set on the controller task whenever the ADC has a new frame
+#define JOYSTICKS_NOTIFY_BIT (1UL << 1)
+// one noise filter per axis, between the ADC and change detection
+static axis_filter_t joystick_filters[sizeof(joystick_channels) / sizeof(joystick_channels[0])];
+// frames between two report counter lines in the debug log
+#define STATS_LOG_FRAMES (1024)
+
 /**
- * @brief Reads analog joystick input from an ADC channel.
+ * @brief Scales a 12-bit ADC reading down to a HID axis (0-255).
  *
- * The ESP32 integrates two 12-bit SAR (Successive Approximation Register) ADCs,
- * supporting a total of 18 measurement channels (analog enabled pins).
+ * Sampling keeps the full 12 bits; only the HID report is limited to 8.
  *
- * The ADC driver API supports ADC1 (8 channels, attached to GPIOs 32 - 39), and
- * ADC2 (10 channels, attached to GPIOs 0, 2, 4, 12 - 15 and 25 - 27). However,
- * the usage of ADC2 has some restrictions for the application:
+ * @param raw The 12-bit reading.
+ * @return uint8_t - The axis value.
+ */
+static inline uint8_t hid_axis(uint16_t raw) {
+  return (uint8_t)(raw >> 4);
+}
+
+/**
+ * @brief Packs the four HID axes of a set of readings into one word.
  *
- * 1. ADC2 is used by the Wi-Fi driver. Therefore the application can only use
- *      ADC2 when the Wi-Fi driver has not started.
- * 2. Some of the ADC2 pins are used as strapping pins (GPIO 0, 2, 15) thus
- *      cannot be used freely.
+ * The sticks are rotated 90º counterclockwise on the way.
  *
- * @param channel The input ADC channel.
- * @return uint8_t - The analog input (0-255) to the channel.
+ * @param raw The 12-bit readings, indexed by joystick slot.
+ * @return uint32_t - JS2 X, JS2 Y, JS1 X, JS1 Y, from the top byte down.
  */
-static uint8_t read_joystick_channel(adc1_channel_t channel) {
-  adc1_config_width(ADC_WIDTH_BIT_10);                  // Range 0-1023
-  adc1_config_channel_atten(channel, ADC_ATTEN_DB_11);  // ADC_ATTEN_DB_11 = 0-3,6V
-  return (uint8_t)(adc1_get_raw(channel) >> 2);         // Read analog and shift to 0-255
+static uint32_t pack_joysticks(const uint16_t *raw) {
+  uint8_t js1_x = 0xFF - hid_axis(raw[JS1_Y_SLOT]);
+  uint8_t js1_y = hid_axis(raw[JS1_X_SLOT]);
+  uint8_t js2_x = 0xFF - hid_axis(raw[JS2_Y_SLOT]);
+  uint8_t js2_y = hid_axis(raw[JS2_X_SLOT]);
+  return (js2_x << 24) + (js2_y << 16) + (js1_x << 8) + js1_y;
 }
 
 /* -------------------------------------------------------------------------- */
 /*                                 CONTROLLER                                 */
 /* -------------------------------------------------------------------------- */
 
+// set on the controller task at every report tick
+#define REPORT_TICK_NOTIFY_BIT (1UL << 2)
+
 /**
  * @brief The task for reading / emitting events from the controller.
  *
+ * Sleeps on both input mailboxes and the report scheduler at once. Every
+ * joystick frame goes through the axis filters as it arrives, and buttons
+ * are picked up as they change, but a HID report only goes out on the
+ * scheduler's ticks: when the state changed since the last report, or as a
+ * keepalive when none has been sent in a while.
+ *
  * @param pvParameter A placeholder parameter to pass to the task.
  */
 static void read_controller_task(void *pvParameter) {
   // begin button monitoring
-  button_queue = xQueueCreate(4, sizeof(uint16_t));
-  xTaskCreate(read_buttons_task, "button_task", 2048, NULL, 2, NULL);
+  button_state = mailbox_create(sizeof(buttons_state_t), BUTTONS_NOTIFY_BIT);
+  mailbox_set_consumer(button_state, xTaskGetCurrentTaskHandle());
+  button_group_config_t buttons = BUTTON_GROUP_CONFIG_DEFAULT();
+  buttons.pin_select = BUTTON_SELECT;
+  buttons.queue_size = 0;
+  buttons.pin_bits = button_bits;
+  buttons.on_state = publish_buttons;
+  if (button_group_create(&buttons) == NULL) ESP_LOGE(TAG, "failed to start the buttons");
+
+  // begin joystick sampling, all four axes on one hardware-timed scan
+  mailbox_t *joystick_frames = adc_sampler_start(joystick_channels, sizeof(joystick_channels) / sizeof(joystick_channels[0]), JOYSTICKS_NOTIFY_BIT);
+  if (joystick_frames == NULL) {
+    ESP_LOGE(TAG, "failed to start the joysticks");
+    vTaskDelete(NULL);
+  }
+  mailbox_set_consumer(joystick_frames, xTaskGetCurrentTaskHandle());
+  adc_frame_t frame = {0};
+  axis_filter_config_t filter_config = AXIS_FILTER_CONFIG_DEFAULT();
+  for (size_t i = 0; i < sizeof(joystick_filters) / sizeof(joystick_filters[0]); i++) {
+    axis_filter_init(&joystick_filters[i], &filter_config);
+  }
+  uint16_t filtered[sizeof(joystick_filters) / sizeof(joystick_filters[0])];
+
+  // begin pacing the HID reports
+  report_scheduler_config_t report_config = REPORT_SCHEDULER_CONFIG_DEFAULT();
+  report_scheduler_t *scheduler = report_scheduler_start(&report_config, REPORT_TICK_NOTIFY_BIT);
+  if (scheduler == NULL) {
+    ESP_LOGE(TAG, "failed to start the report scheduler");
+    vTaskDelete(NULL);
+  }
 
   // maintain state of controller buttons
   uint8_t js1_x, js1_y;
   uint8_t js2_x, js2_y;
-  uint16_t s_buttons = 0;
+  buttons_state_t s_buttons = {0};
   uint16_t s_buttons_last = 0;
   uint32_t s_joysticks = 0;
   uint32_t s_joysticks_last = 0;
+  // frames filtered, reports sent, and frames that only the axis filters kept from changing a report
+  uint32_t frames = 0, reports = 0, suppressed = 0;
 
   // continually loop to get input
   while (true) {
-    // spend 20ms to receive any button events
-    if (xQueueReceive(button_queue, &s_buttons, 20 / portTICK_PERIOD_MS))
-      ESP_LOGD(TAG, "buttons changed: %d", s_buttons);
-    // read in joystick values, rotated 90º counterclockwise
-    js1_x = 0xFF - read_joystick_channel(CONFIG_PIN_JOYSTICK_1_VRY);
-    js1_y = read_joystick_channel(CONFIG_PIN_JOYSTICK_1_VRX);
-    js2_x = 0xFF - read_joystick_channel(CONFIG_PIN_JOYSTICK_2_VRY);
-    js2_y = read_joystick_channel(CONFIG_PIN_JOYSTICK_2_VRX);
-    // convert to checksum
-    s_joysticks = (js2_x << 24) + (js2_y << 16) + (js1_x << 8) + js1_y;
-    // if something changed, transmit across bluetooth
-    if (s_joysticks != s_joysticks_last || s_buttons != s_buttons_last) {
-      ESP_LOGD(TAG, "emitted event: BUTTONS: (%d) JS1: (%d,%d) JS2: (%d,%d)", s_buttons, js1_x, js1_y, js2_x, js2_y);
-      hidd_send_joystick_value(s_buttons, js1_x, js1_y, js2_x, js2_y);
+    // wait for whichever comes first, a joystick frame, a button change or a report tick
+    uint32_t bits = mailbox_wait_any(JOYSTICKS_NOTIFY_BIT | BUTTONS_NOTIFY_BIT | REPORT_TICK_NOTIFY_BIT, portMAX_DELAY);
+    mailbox_read(button_state, &s_buttons);
+    bool new_frame = mailbox_read(joystick_frames, &frame);
+    if (new_frame) {
+      // filter the joystick values, then convert to checksum
+      for (size_t i = 0; i < sizeof(filtered) / sizeof(filtered[0]); i++) {
+        filtered[i] = axis_filter_update(&joystick_filters[i], frame.raw[i]);
+      }
+      s_joysticks = pack_joysticks(filtered);
+      if (s_joysticks == s_joysticks_last && pack_joysticks(frame.raw) != s_joysticks_last) {
+        // the unfiltered axes would have made the next report differ
+        suppressed++;
+      }
+      if (++frames % STATS_LOG_FRAMES == 0) {
+        ESP_LOGD(TAG, "%u reports, %u frames held back by the joystick filters", reports, suppressed);
+      }
+    }
+    if (!(bits & REPORT_TICK_NOTIFY_BIT)) continue;
+    // if something changed (or nothing has gone out in a while), transmit across bluetooth
+    bool changed = s_joysticks != s_joysticks_last || s_buttons.state != s_buttons_last;
+    if (report_scheduler_tick(scheduler, changed)) {
+      js1_y = s_joysticks;
+      js1_x = s_joysticks >> 8;
+      js2_y = s_joysticks >> 16;
+      js2_x = s_joysticks >> 24;
+      // the HID report has no room for a timestamp, so the latency of the
+      // oldest input in it is only logged
+      int64_t sampled_us = esp_timer_get_time();
+      if (s_joysticks != s_joysticks_last) sampled_us = frame.time_us;
+      if (s_buttons.state != s_buttons_last && s_buttons.time_us < sampled_us) sampled_us = s_buttons.time_us;
+      ESP_LOGD(TAG, "emitted event: BUTTONS: (%d) JS1: (%d,%d) JS2: (%d,%d)", s_buttons.state, js1_x, js1_y, js2_x, js2_y);
+      hidd_send_joystick_value(s_buttons.state, js1_x, js1_y, js2_x, js2_y);
+      ESP_LOGD(TAG, "input to wire: %" PRId64 " us", esp_timer_get_time() - sampled_us);
       // current values are now previous ones
-      s_buttons_last = s_buttons;
+      s_buttons_last = s_buttons.state;
       s_joysticks_last = s_joysticks;
+      reports++;
     }
   }
 }
@@ -1,8 +1,12 @@
 #ifndef ESP32_BUTTON_H
 #define ESP32_BUTTON_H
 
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "driver/gpio.h"
+#include "esp_err.h"
 
 #ifndef CONFIG_ESP32_BUTTON_LONG_PRESS_DURATION_MS
 #define CONFIG_ESP32_BUTTON_LONG_PRESS_DURATION_MS (2000)
@@ -12,6 +16,14 @@
 #define CONFIG_ESP32_BUTTON_LONG_PRESS_REPEAT_MS (50)
 #endif
 
+#ifndef CONFIG_ESP32_BUTTON_DOUBLE_CLICK_MS
+#define CONFIG_ESP32_BUTTON_DOUBLE_CLICK_MS (300)
+#endif
+
+#ifndef CONFIG_ESP32_BUTTON_CHORD_WINDOW_MS
+#define CONFIG_ESP32_BUTTON_CHORD_WINDOW_MS (50)
+#endif
+
 #ifndef CONFIG_ESP32_BUTTON_QUEUE_SIZE
 #define CONFIG_ESP32_BUTTON_QUEUE_SIZE (4)
 #endif
@@ -20,6 +32,18 @@
 #define CONFIG_ESP32_BUTTON_TASK_STACK_SIZE 3072
 #endif
 
+#ifndef CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS
+#define CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS (10)
+#endif
+
+#ifndef CONFIG_ESP32_BUTTON_ISR_DEBOUNCE
+#define CONFIG_ESP32_BUTTON_ISR_DEBOUNCE (0)
+#endif
+
+#ifndef CONFIG_ESP32_BUTTON_DEBOUNCE_MS
+#define CONFIG_ESP32_BUTTON_DEBOUNCE_MS (20)
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,12 +53,89 @@ extern "C" {
 #define BUTTON_DOWN (1)
 #define BUTTON_UP (2)
 #define BUTTON_HELD (3)
+#define BUTTON_LONG_PRESS (4)
+#define BUTTON_DOUBLE_CLICK (5)
+#define BUTTON_CHORD (6)
+#define BUTTON_STATE (7)
+
+// gestures a group can detect, see button_group_config_t.gestures
+#define BUTTON_GESTURE_LONG_PRESS (1 << 0)    // BUTTON_LONG_PRESS, then BUTTON_HELD repeats
+#define BUTTON_GESTURE_DOUBLE_CLICK (1 << 1)  // BUTTON_DOUBLE_CLICK
+#define BUTTON_GESTURE_CHORD (1 << 2)         // BUTTON_CHORD
 
 typedef struct {
   uint8_t pin;
-    uint8_t event;
+  uint8_t event;
+  unsigned long long mask;  // BUTTON_CHORD: pins of the chord, BUTTON_STATE: pins held down
+  int64_t time_us;          // esp_timer_get_time() when the input behind the event was sampled
 } button_event_t;
 
+// what a group does with events its consumer has not made room for
+typedef enum {
+  BUTTON_OVERFLOW_DROP_OLDEST,  // overwrite the oldest unread event
+  BUTTON_OVERFLOW_COALESCE,     // stop queueing, report one BUTTON_STATE snapshot once drained
+} button_overflow_t;
+
+typedef struct {
+  uint32_t dropped;     // events lost to BUTTON_OVERFLOW_DROP_OLDEST
+  uint32_t coalesced;   // events folded into a BUTTON_STATE snapshot
+  uint32_t high_water;  // most events ever waiting at once
+  uint32_t pending;     // events waiting right now
+} button_group_stats_t;
+
+typedef struct button_group *button_group_handle_t;
+
+#define BUTTON_NOTIFY_BIT (1UL << 0)
+
+// pin -> state bit table for button_group_config_t.pin_bits, filled in at compile time with
+// BUTTON_PIN_BIT_SLOT(). Slots hold the bit + 1, so pins left out of the table map to nothing.
+#define BUTTON_PIN_BITS_SIZE (GPIO_NUM_MAX + 32)
+// unset pins (0) get a spare slot past GPIO_NUM_MAX each, instead of all landing on GPIO 0
+#define BUTTON_PIN_BIT_SLOT(pin, bit) [(pin) > 0 ? (pin) : GPIO_NUM_MAX + (bit)] = (bit) + 1
+
+// called with the full state bitmask whenever a pin in pin_bits changes; runs in the scanner
+// (or esp_timer) task, so it must not block
+typedef void (*button_state_cb_t)(uint32_t state, int64_t time_us, void *arg);
+
+typedef struct {
+  unsigned long long pin_select;  // PIN_BIT() mask of the pins in this group
+  gpio_pull_mode_t pull_mode;
+  bool inverted;                  // pins read low while pressed
+  bool isr_debounce;              // use edge interrupts instead of the shared scanner
+  uint32_t scan_period_ms;        // 0 = only scanned through button_group_scan
+  uint32_t queue_size;            // 0 = no per-event delivery, on_state only
+  uint32_t gestures;              // BUTTON_GESTURE_* flags
+  button_overflow_t overflow;
+  uint32_t notify_bits;           // task notification bits set on the consumer per event
+  bool use_queue;                 // deliver on a FreeRTOS queue instead of the ring
+  const uint8_t *pin_bits;        // BUTTON_PIN_BITS_SIZE table built with BUTTON_PIN_BIT_SLOT()
+  button_state_cb_t on_state;     // publishes the pin_bits state, needs pin_bits
+  void *on_state_arg;
+} button_group_config_t;
+
+#define BUTTON_GROUP_CONFIG_DEFAULT() {                    \
+    .pin_select = 0,                                       \
+    .pull_mode = GPIO_FLOATING,                            \
+    .inverted = false,                                     \
+    .isr_debounce = CONFIG_ESP32_BUTTON_ISR_DEBOUNCE,      \
+    .scan_period_ms = CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS,  \
+    .queue_size = CONFIG_ESP32_BUTTON_QUEUE_SIZE,          \
+    .gestures = 0,                                         \
+    .overflow = BUTTON_OVERFLOW_DROP_OLDEST,               \
+    .notify_bits = BUTTON_NOTIFY_BIT,                      \
+    .use_queue = false,                                    \
+    .pin_bits = NULL,                                      \
+    .on_state = NULL,                                      \
+    .on_state_arg = NULL,                                  \
+}
+
+button_group_handle_t button_group_create(const button_group_config_t *config);
+QueueHandle_t button_group_get_queue(button_group_handle_t group);
+bool button_group_receive(button_group_handle_t group, button_event_t *event, TickType_t ticks_to_wait);
+void button_group_get_stats(button_group_handle_t group, button_group_stats_t *stats);
+void button_group_scan(button_group_handle_t group);
+esp_err_t button_group_delete(button_group_handle_t group);
+
 QueueHandle_t button_init(unsigned long long pin_select);
 QueueHandle_t pulled_button_init(unsigned long long pin_select, gpio_pull_mode_t pull_mode);
 
@@ -6,135 +6,777 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#include "soc/gpio_reg.h"
 
 #include "button.h"
 
 #define TAG "BUTTON"
 
+// number of slots in each group's timing wheel, in group ticks
+#define WHEEL_SLOTS (32)
+
+typedef struct button_group button_group_t;
+typedef struct wheel_entry wheel_entry_t;
+
+/**
+ * @brief A deadline on a group's timing wheel.
+ *
+ * Entries are linked into the slot their deadline falls in, so arming,
+ * cancelling and firing are all O(1) and nothing is checked per pin per scan.
+ */
+struct wheel_entry {
+  wheel_entry_t *next;
+  wheel_entry_t **pprev;  // NULL while not armed
+  uint32_t expires;       // absolute group tick
+  void (*fire)(button_group_t *group, wheel_entry_t *entry);
+  void *arg;
+};
+
+/**
+ * @brief One slot of a group's event ring.
+ *
+ * seq holds the ring index + 1 of the event in the slot, and is zeroed while
+ * the producer rewrites it, so the consumer can tell a torn read from a good
+ * one without taking a lock.
+ */
+typedef struct {
+  volatile uint32_t seq;
+  button_event_t event;
+} ring_slot_t;
+
 typedef struct {
   uint8_t pin;
   bool inverted;
-  uint16_t history;
-  uint32_t down_time;
-  uint32_t next_long_time;
+  bool level;                // last settled level, used in ISR mode
+  volatile int64_t edge_us;  // time of the edge that opened the debounce window, ISR mode
+  esp_timer_handle_t settle; // debounce window timer, used in ISR mode
+  button_group_t *group;
+  // gesture state
+  wheel_entry_t hold;        // long press, then auto-repeat
+  bool repeating;            // long press already reported
+  bool clicked;              // released recently, last_up is valid
+  bool doubled;              // current press was reported as a double-click
+  uint32_t last_up;          // group tick of the last release
 } debounce_t;
 
-int pin_count = -1;
-debounce_t *debounce;
-QueueHandle_t queue;
+struct button_group {
+  button_group_config_t config;
+  int pin_count;
+  debounce_t *debounce;
+  QueueHandle_t queue;  // use_queue groups only
+  // single-producer / single-consumer event ring
+  ring_slot_t *ring;
+  uint32_t ring_mask;            // ring size - 1, the size is a power of two
+  volatile uint32_t head;        // written by the producer only
+  volatile uint32_t tail;        // written by the consumer only
+  TaskHandle_t volatile consumer;
+  // BUTTON_OVERFLOW_COALESCE: newest pressed mask and its sample time, guarded by a seqlock
+  volatile uint32_t snapshot_seq;    // odd while being written
+  volatile uint32_t snapshot_taken;  // last snapshot_seq the consumer delivered
+  unsigned long long snapshot;
+  int64_t snapshot_us;
+  // delivery statistics
+  volatile uint32_t dropped;     // producer side: queue overflows
+  volatile uint32_t overrun;     // consumer side: ring slots overwritten unread
+  volatile uint32_t coalesced;
+  volatile uint32_t high_water;
+  uint32_t period;     // scan period, in shared scanner ticks
+  uint32_t countdown;  // scanner ticks left until the next scan
+  button_group_t *next;
+  int64_t stamp;       // time_us given to the events being generated right now
+  uint32_t bits;       // pin_bits state, built up edge by edge
+  uint32_t published;  // last bits handed to on_state
+  // polled mode: a 2-bit vertical counter per pin, one bit plane per word
+  uint64_t state;      // debounced level of every pin in the group
+  uint64_t cnt0;       // low bit of each pin's counter
+  uint64_t cnt1;       // high bit of each pin's counter
+  uint64_t invert;     // pins that read low while pressed
+  // gesture engine
+  uint64_t pressed;    // pins currently reported as DOWN
+  int8_t index[SOC_GPIO_PIN_COUNT];  // pin -> debounce slot
+  wheel_entry_t *wheel[WHEEL_SLOTS];
+  uint32_t now;        // current group tick
+  uint32_t armed;      // entries on the wheel
+  uint32_t tick_ms;    // length of one group tick
+  esp_timer_handle_t wheel_timer;  // ticks the wheel of an ISR group while armed
+  volatile bool deleting;          // set by button_group_delete, the ISR group's callbacks back off
+  wheel_entry_t chord;
+  uint64_t chord_mask; // pins pressed since the chord window opened
+};
 
-static void update_button(debounce_t *d) {
-  d->history = (d->history << 1) | gpio_get_level(d->pin);
+// pins owned by some group, so two groups can never fight over one pin
+static unsigned long long claimed_pins = 0;
+
+// groups sampled by the shared scanner task, guarded by groups_lock
+static button_group_t *scanned_groups = NULL;
+static SemaphoreHandle_t groups_lock = NULL;
+static TaskHandle_t scanner_task = NULL;
+
+/* ----------------------------- EVENT DELIVERY ----------------------------- */
+
+static void note_depth(button_group_t *group, uint32_t depth) {
+  if (depth > group->high_water) group->high_water = depth;
 }
 
-#define MASK 0b1111000000111111
-static bool button_rose(debounce_t *d) {
-  if ((d->history & MASK) == 0b0000000000111111) {
-    d->history = 0xffff;
-    return 1;
-  }
-  return 0;
+/**
+ * @brief Folds an event into the pressed-state snapshot instead of queueing it.
+ *
+ * Once coalescing starts the producer keeps at it until the consumer has
+ * picked up the snapshot, so nothing newer can overtake it in the ring.
+ */
+static void snapshot_write(button_group_t *group) {
+  uint32_t seq = group->snapshot_seq;
+  __atomic_store_n(&group->snapshot_seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  group->snapshot = group->pressed;
+  group->snapshot_us = group->stamp;
+  __atomic_store_n(&group->snapshot_seq, seq + 2, __ATOMIC_RELEASE);
+  group->coalesced++;
 }
-static bool button_fell(debounce_t *d) {
-  if ((d->history & MASK) == 0b1111000000000000) {
-    d->history = 0x0000;
-    return 1;
+
+static void ring_push(button_group_t *group, const button_event_t *event) {
+  uint32_t size = group->ring_mask + 1;
+  uint32_t head = group->head;
+  uint32_t depth = head - __atomic_load_n(&group->tail, __ATOMIC_ACQUIRE);
+  if (group->config.overflow == BUTTON_OVERFLOW_COALESCE) {
+    bool coalescing = group->snapshot_seq != __atomic_load_n(&group->snapshot_taken, __ATOMIC_ACQUIRE);
+    if (coalescing || depth >= size) {
+      snapshot_write(group);
+      return;
+    }
   }
-  return 0;
-}
-static bool button_down(debounce_t *d) {
-  if (d->inverted) return button_fell(d);
-  return button_rose(d);
+
+  // BUTTON_OVERFLOW_DROP_OLDEST simply laps the consumer; it notices and skips ahead
+  ring_slot_t *slot = &group->ring[head & group->ring_mask];
+  __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  slot->event = *event;
+  __atomic_store_n(&slot->seq, head + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&group->head, head + 1, __ATOMIC_RELEASE);
+  note_depth(group, depth < size ? depth + 1 : size);
 }
-static bool button_up(debounce_t *d) {
-  if (d->inverted) return button_rose(d);
-  return button_fell(d);
+
+static bool ring_pop(button_group_t *group, button_event_t *event) {
+  uint32_t size = group->ring_mask + 1;
+  for (;;) {
+    uint32_t head = __atomic_load_n(&group->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = group->tail;
+    if (head == tail) break;
+    if (head - tail > size) {
+      // lapped by the producer, the oldest events are gone
+      group->overrun += head - size - tail;
+      tail = head - size;
+      __atomic_store_n(&group->tail, tail, __ATOMIC_RELEASE);
+    }
+    ring_slot_t *slot = &group->ring[tail & group->ring_mask];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    // being written right now. never wait for it here: the producer may be
+    // preempted mid-write by this very task. it notifies once it is done
+    if (seq != tail + 1) return false;
+    *event = slot->event;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) continue;  // lapped while copying
+    __atomic_store_n(&group->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // ring drained, deliver the coalesced snapshot if there is a new one. one
+  // being written is left for the producer's next notification, as above
+  uint32_t seq = __atomic_load_n(&group->snapshot_seq, __ATOMIC_ACQUIRE);
+  if (seq == group->snapshot_taken || (seq & 1)) return false;
+  unsigned long long snapshot = group->snapshot;
+  int64_t snapshot_us = group->snapshot_us;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (seq != __atomic_load_n(&group->snapshot_seq, __ATOMIC_RELAXED)) return false;
+  *event = (button_event_t){
+      .pin = snapshot ? __builtin_ctzll(snapshot) : 0,
+      .event = BUTTON_STATE,
+      .mask = snapshot,
+      .time_us = snapshot_us,
+  };
+  __atomic_store_n(&group->snapshot_taken, seq, __ATOMIC_RELEASE);
+  return true;
 }
 
-static uint32_t millis() {
-  return esp_timer_get_time() / 1000;
+/**
+ * @brief Delivery for button_init groups, kept on a FreeRTOS queue.
+ *
+ * Never blocks: a full queue loses its oldest event instead.
+ */
+static void queue_push(button_group_t *group, const button_event_t *event) {
+  if (xQueueSend(group->queue, event, 0) != pdTRUE) {
+    button_event_t stale;
+    xQueueReceive(group->queue, &stale, 0);
+    group->dropped++;
+    xQueueSend(group->queue, event, 0);
+  }
+  note_depth(group, uxQueueMessagesWaiting(group->queue));
 }
 
-static void send_event(debounce_t db, int ev) {
+/**
+ * @brief Hands an event to the group's consumer. Never blocks the producer.
+ */
+static void send_event(button_group_t *group, uint8_t pin, int ev, uint64_t mask) {
   button_event_t event = {
-      .pin = db.pin,
+      .pin = pin,
       .event = ev,
+      .mask = mask,
+      .time_us = group->stamp,
   };
-  xQueueSend(queue, &event, portMAX_DELAY);
+  if (group->queue) {
+    queue_push(group, &event);
+    return;
+  }
+  if (group->ring == NULL) return;  // on_state only
+  ring_push(group, &event);
+  TaskHandle_t consumer = group->consumer;
+  if (consumer) xTaskNotify(consumer, group->config.notify_bits, eSetBits);
+}
+
+/**
+ * @brief Hands the pin_bits state to on_state if any edge since the last call changed it.
+ */
+static void publish_state(button_group_t *group) {
+  if (group->bits == group->published) return;
+  group->published = group->bits;
+  group->config.on_state(group->bits, group->stamp, group->config.on_state_arg);
+}
+
+/* ----------------------------- GESTURE ENGINE ----------------------------- */
+
+static uint32_t ms_to_ticks(button_group_t *group, uint32_t ms) {
+  uint32_t ticks = (ms + group->tick_ms - 1) / group->tick_ms;
+  return ticks ? ticks : 1;
+}
+
+static void wheel_cancel(button_group_t *group, wheel_entry_t *entry) {
+  if (entry->pprev == NULL) return;
+  *entry->pprev = entry->next;
+  if (entry->next) entry->next->pprev = entry->pprev;
+  entry->pprev = NULL;
+  group->armed--;
+}
+
+static void wheel_arm(button_group_t *group, wheel_entry_t *entry, uint32_t ticks) {
+  wheel_cancel(group, entry);
+  entry->expires = group->now + ticks;
+  wheel_entry_t **slot = &group->wheel[entry->expires % WHEEL_SLOTS];
+  entry->next = *slot;
+  if (*slot) (*slot)->pprev = &entry->next;
+  entry->pprev = slot;
+  *slot = entry;
+  group->armed++;
+}
+
+/**
+ * @brief Moves the wheel forward to the given tick, firing whatever expires.
+ *
+ * Slots are only walked while something is armed; an idle wheel just jumps.
+ */
+static void wheel_advance(button_group_t *group, uint32_t target) {
+  while (group->now != target) {
+    if (group->armed == 0) {
+      group->now = target;
+      break;
+    }
+    group->now++;
+    wheel_entry_t *entry = group->wheel[group->now % WHEEL_SLOTS];
+    while (entry) {
+      wheel_entry_t *next = entry->next;
+      if (entry->expires == group->now) {
+        wheel_cancel(group, entry);
+        entry->fire(group, entry);
+      }
+      entry = next;
+    }
+  }
+}
+
+static void hold_fire(button_group_t *group, wheel_entry_t *entry) {
+  debounce_t *d = (debounce_t *)entry->arg;
+  if (!d->repeating) {
+    d->repeating = true;
+    send_event(group, d->pin, BUTTON_LONG_PRESS, 0);
+  } else {
+    send_event(group, d->pin, BUTTON_HELD, 0);
+  }
+  wheel_arm(group, entry, ms_to_ticks(group, CONFIG_ESP32_BUTTON_LONG_PRESS_REPEAT_MS));
+}
+
+static void chord_fire(button_group_t *group, wheel_entry_t *entry) {
+  uint64_t chord = group->chord_mask & group->pressed;
+  group->chord_mask = 0;
+  if (chord & (chord - 1)) {  // at least two buttons still down
+    send_event(group, __builtin_ctzll(chord), BUTTON_CHORD, chord);
+  }
 }
 
+/**
+ * @brief Reports a debounced edge and feeds it to the gesture engine.
+ */
+static void handle_edge(button_group_t *group, uint8_t pin, bool pressed) {
+  debounce_t *d = &group->debounce[group->index[pin]];
+  uint32_t gestures = group->config.gestures;
+  uint8_t slot = group->config.pin_bits ? group->config.pin_bits[pin] : 0;
+  if (slot) {
+    if (pressed) {
+      group->bits |= (1UL << (slot - 1));
+    } else {
+      group->bits &= ~(1UL << (slot - 1));
+    }
+  }
+  if (pressed) {
+    ESP_LOGI(TAG, "%d DOWN", pin);
+    group->pressed |= (1ULL << pin);
+    send_event(group, pin, BUTTON_DOWN, 0);
+    if (gestures & BUTTON_GESTURE_LONG_PRESS) {
+      d->repeating = false;
+      wheel_arm(group, &d->hold, ms_to_ticks(group, CONFIG_ESP32_BUTTON_LONG_PRESS_DURATION_MS));
+    }
+    if (gestures & BUTTON_GESTURE_DOUBLE_CLICK) {
+      if (d->clicked && group->now - d->last_up <= ms_to_ticks(group, CONFIG_ESP32_BUTTON_DOUBLE_CLICK_MS)) {
+        d->doubled = true;
+        send_event(group, pin, BUTTON_DOUBLE_CLICK, 0);
+      }
+      d->clicked = false;
+    }
+    if (gestures & BUTTON_GESTURE_CHORD) {
+      if (group->chord.pprev == NULL) {
+        wheel_arm(group, &group->chord, ms_to_ticks(group, CONFIG_ESP32_BUTTON_CHORD_WINDOW_MS));
+      }
+      group->chord_mask |= (1ULL << pin);
+    }
+  } else {
+    ESP_LOGI(TAG, "%d UP", pin);
+    group->pressed &= ~(1ULL << pin);
+    send_event(group, pin, BUTTON_UP, 0);
+    wheel_cancel(group, &d->hold);
+    if (gestures & BUTTON_GESTURE_DOUBLE_CLICK) {
+      d->clicked = !d->doubled;
+      d->doubled = false;
+      d->last_up = group->now;
+    }
+  }
+}
+
+/* ------------------------------ POLLED MODE ------------------------------ */
+
+/**
+ * @brief Reads the level of every GPIO at once, straight from the input registers.
+ */
+static uint64_t read_levels(void) {
+  uint64_t levels = REG_READ(GPIO_IN_REG);
+#if SOC_GPIO_PIN_COUNT > 32
+  levels |= (uint64_t)(REG_READ(GPIO_IN1_REG) & 0xff) << 32;  // GPIO 32-39
+#endif
+  return levels;
+}
+
+/**
+ * @brief Debounces every pin of a group against one register snapshot.
+ *
+ * Each pin has a 2-bit counter, stored bit-sliced across cnt0 and cnt1, that
+ * counts consecutive samples disagreeing with its debounced state and resets
+ * on any sample that agrees. When a counter would roll over on the fourth
+ * such sample the pin's state toggles. All pins update together in a handful
+ * of bitwise ops, so the cost does not grow with the number of buttons.
+ * Everything the scan reports is stamped with sampled_us, the time the
+ * register snapshot was taken.
+ */
+static void scan_group(button_group_t *group, uint64_t levels, int64_t sampled_us) {
+  group->stamp = sampled_us;
+  wheel_advance(group, group->now + 1);
+
+  uint64_t delta = (levels ^ group->state) & group->config.pin_select;
+  uint64_t toggle = delta & group->cnt0 & group->cnt1;
+  group->cnt1 = (group->cnt1 ^ group->cnt0) & delta;
+  group->cnt0 = ~group->cnt0 & delta;
+  group->state ^= toggle;
+
+  // only walk the pins that actually changed
+  uint64_t pressed = group->state ^ group->invert;
+  while (toggle) {
+    uint8_t pin = __builtin_ctzll(toggle);
+    toggle &= toggle - 1;
+    handle_edge(group, pin, pressed & (1ULL << pin));
+  }
+  if (group->config.on_state) publish_state(group);
+}
+
+/**
+ * @brief The one task that samples every polled group.
+ *
+ * Ticks every CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS, reads the GPIO input
+ * registers once, and scans each group whose own scan period has come round.
+ * While no polled group exists it sleeps until one is registered.
+ */
 static void button_task(void *pvParameter) {
+  TickType_t period = pdMS_TO_TICKS(CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS);
+  if (period == 0) period = 1;
+  TickType_t last_wake = xTaskGetTickCount();
   for (;;) {
-    for (int idx = 0; idx < pin_count; idx++) {
-      update_button(&debounce[idx]);
-      if (button_up(&debounce[idx])) {
-        debounce[idx].down_time = 0;
-        ESP_LOGI(TAG, "%d UP", debounce[idx].pin);
-        send_event(debounce[idx], BUTTON_UP);
-        // } else if (debounce[idx].down_time && millis() >= debounce[idx].next_long_time) {
-        //     ESP_LOGI(TAG, "%d LONG", debounce[idx].pin);
-        //     debounce[idx].next_long_time = debounce[idx].next_long_time + CONFIG_ESP32_BUTTON_LONG_PRESS_REPEAT_MS;
-        //     send_event(debounce[idx], BUTTON_HELD);
-      } else if (button_down(&debounce[idx]) && debounce[idx].down_time == 0) {
-        debounce[idx].down_time = millis();
-        ESP_LOGI(TAG, "%d DOWN", debounce[idx].pin);
-        debounce[idx].next_long_time = debounce[idx].down_time + CONFIG_ESP32_BUTTON_LONG_PRESS_DURATION_MS;
-        send_event(debounce[idx], BUTTON_DOWN);
+    xSemaphoreTake(groups_lock, portMAX_DELAY);
+    bool idle = (scanned_groups == NULL);
+    uint64_t levels = read_levels();
+    int64_t sampled_us = esp_timer_get_time();
+    for (button_group_t *group = scanned_groups; group; group = group->next) {
+      if (--group->countdown == 0) {
+        group->countdown = group->period;
+        scan_group(group, levels, sampled_us);
       }
     }
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    xSemaphoreGive(groups_lock);
+    if (idle) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      last_wake = xTaskGetTickCount();
+    } else {
+      vTaskDelayUntil(&last_wake, period);
+    }
   }
 }
 
-QueueHandle_t button_init(unsigned long long pin_select) {
-  return pulled_button_init(pin_select, GPIO_FLOATING);
+/**
+ * @brief Adds a group to the shared scanner, starting the scanner if needed.
+ */
+static void scanner_add(button_group_t *group) {
+  group->period = group->config.scan_period_ms / CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS;
+  if (group->period == 0) group->period = 1;
+  group->countdown = group->period;
+
+  xSemaphoreTake(groups_lock, portMAX_DELAY);
+  group->next = scanned_groups;
+  scanned_groups = group;
+  xSemaphoreGive(groups_lock);
+
+  if (scanner_task == NULL) {
+    xTaskCreate(&button_task, "button_task", CONFIG_ESP32_BUTTON_TASK_STACK_SIZE, NULL, 10, &scanner_task);
+  } else {
+    xTaskNotifyGive(scanner_task);
+  }
 }
 
-QueueHandle_t pulled_button_init(unsigned long long pin_select, gpio_pull_mode_t pull_mode) {
-  if (pin_count != -1) {
-    ESP_LOGI(TAG, "Already initialized");
+/**
+ * @brief Takes a group off the shared scanner. Once this returns, the scanner
+ * is guaranteed not to be touching the group.
+ */
+static void scanner_remove(button_group_t *group) {
+  xSemaphoreTake(groups_lock, portMAX_DELAY);
+  for (button_group_t **link = &scanned_groups; *link; link = &(*link)->next) {
+    if (*link == group) {
+      *link = group->next;
+      break;
+    }
+  }
+  xSemaphoreGive(groups_lock);
+}
+
+/* -------------------------------- ISR MODE -------------------------------- */
+
+/**
+ * @brief GPIO edge interrupt for a single button.
+ *
+ * The first edge of a press or release masks further interrupts on the pin and
+ * opens the debounce window. Any bouncing inside the window is never seen.
+ * The edge is timestamped here, so the event it becomes carries the time of
+ * the real edge rather than the end of the debounce window.
+ */
+static void button_isr_handler(void *arg) {
+  debounce_t *d = (debounce_t *)arg;
+  if (__atomic_load_n(&d->group->deleting, __ATOMIC_ACQUIRE)) return;
+  d->edge_us = esp_timer_get_time();
+  gpio_intr_disable(d->pin);
+  esp_timer_start_once(d->settle, CONFIG_ESP32_BUTTON_DEBOUNCE_MS * 1000);
+}
+
+/**
+ * @brief Runs once the debounce window of a pin has closed.
+ *
+ * Interrupts are re-armed before sampling, so an edge that lands between the
+ * sample and the re-arm still opens a new window rather than being lost.
+ */
+static void button_settle_cb(void *arg) {
+  debounce_t *d = (debounce_t *)arg;
+  button_group_t *group = d->group;
+  if (__atomic_load_n(&group->deleting, __ATOMIC_ACQUIRE)) return;
+  gpio_intr_enable(d->pin);
+  bool level = gpio_get_level(d->pin);
+  if (level == d->level) return;
+  d->level = level;
+
+  // catch the wheel up to wall time, then let the edge arm new deadlines
+  group->stamp = esp_timer_get_time();
+  wheel_advance(group, group->stamp / (group->tick_ms * 1000));
+  group->stamp = d->edge_us;
+  handle_edge(group, d->pin, level != d->inverted);
+  if (group->config.on_state) publish_state(group);
+  if (group->armed && !esp_timer_is_active(group->wheel_timer)) {
+    esp_timer_start_periodic(group->wheel_timer, group->tick_ms * 1000);
+  }
+}
+
+/**
+ * @brief Ticks the wheel of an ISR group, only while it has deadlines armed.
+ */
+static void button_wheel_cb(void *arg) {
+  button_group_t *group = (button_group_t *)arg;
+  if (__atomic_load_n(&group->deleting, __ATOMIC_ACQUIRE)) return;
+  group->stamp = esp_timer_get_time();
+  wheel_advance(group, group->stamp / (group->tick_ms * 1000));
+  if (group->armed == 0) esp_timer_stop(group->wheel_timer);
+}
+
+/**
+ * @brief Hooks every pin of a group up to the GPIO ISR service.
+ */
+static esp_err_t isr_add(button_group_t *group) {
+  esp_err_t err = gpio_install_isr_service(0);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return err;  // already installed is fine
+  esp_timer_create_args_t wheel_args = {
+      .callback = button_wheel_cb,
+      .arg = group,
+      .name = "button_wheel",
+  };
+  if ((err = esp_timer_create(&wheel_args, &group->wheel_timer)) != ESP_OK) return err;
+  group->now = esp_timer_get_time() / (group->tick_ms * 1000);
+  for (int idx = 0; idx < group->pin_count; idx++) {
+    debounce_t *d = &group->debounce[idx];
+    esp_timer_create_args_t settle_args = {
+        .callback = button_settle_cb,
+        .arg = d,
+        .name = "button_settle",
+    };
+    if ((err = esp_timer_create(&settle_args, &d->settle)) != ESP_OK) return err;
+    d->level = gpio_get_level(d->pin);
+    gpio_isr_handler_add(d->pin, button_isr_handler, d);
+  }
+  return ESP_OK;
+}
+
+static void timer_barrier_cb(void *arg) {
+  xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+/**
+ * @brief Waits for whatever callback the esp_timer task is running to return.
+ *
+ * The task runs callbacks one at a time, so once a fresh one-shot timer has
+ * fired, every callback that started before it is done. Must not be called
+ * from an esp_timer callback, which would wait on itself.
+ */
+static void timer_barrier(void) {
+  SemaphoreHandle_t done = xSemaphoreCreateBinary();
+  esp_timer_handle_t barrier = NULL;
+  esp_timer_create_args_t barrier_args = {
+      .callback = timer_barrier_cb,
+      .arg = done,
+      .name = "button_barrier",
+  };
+  if (done && esp_timer_create(&barrier_args, &barrier) == ESP_OK && esp_timer_start_once(barrier, 0) == ESP_OK) {
+    xSemaphoreTake(done, portMAX_DELAY);
+  } else {
+    // no barrier to be had; the group's callbacks are a few microseconds long
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP32_BUTTON_DEBOUNCE_MS));
+  }
+  if (barrier) esp_timer_delete(barrier);
+  if (done) vSemaphoreDelete(done);
+}
+
+static void delete_timer(esp_timer_handle_t timer) {
+  if (timer == NULL) return;
+  esp_timer_stop(timer);
+  if (esp_timer_delete(timer) == ESP_ERR_INVALID_STATE) {
+    // still armed; stop it once more rather than leak it
+    esp_timer_stop(timer);
+    if (esp_timer_delete(timer) != ESP_OK) ESP_LOGE(TAG, "Could not delete a button timer");
+  }
+}
+
+/**
+ * @brief Unhooks a group's pins and tears down its timers. Once this returns,
+ * no interrupt or timer callback is touching the group.
+ *
+ * The interrupts come off first, so no new edge opens a debounce window; one
+ * already running on the other core is given a tick to finish. Callbacks
+ * that start from here on see `deleting` and leave the group alone, and the
+ * barrier waits out any that started before. Only then can nothing re-arm
+ * the timers, so they are stopped and deleted last.
+ */
+static void isr_remove(button_group_t *group) {
+  __atomic_store_n(&group->deleting, true, __ATOMIC_RELEASE);
+  for (int idx = 0; idx < group->pin_count; idx++) {
+    debounce_t *d = &group->debounce[idx];
+    gpio_intr_disable(d->pin);
+    gpio_isr_handler_remove(d->pin);
+  }
+  vTaskDelay(1);
+  timer_barrier();
+  delete_timer(group->wheel_timer);
+  for (int idx = 0; idx < group->pin_count; idx++) {
+    delete_timer(group->debounce[idx].settle);
+  }
+}
+
+/* ---------------------------- PUBLIC INTERFACE ---------------------------- */
+
+button_group_handle_t button_group_create(const button_group_config_t *config) {
+  if (config == NULL || config->pin_select == 0) {
+    ESP_LOGE(TAG, "No pins selected");
     return NULL;
   }
+  if (config->pin_select & claimed_pins) {
+    ESP_LOGE(TAG, "Pins already used by another group");
+    return NULL;
+  }
+  if (config->on_state && config->pin_bits == NULL) {
+    ESP_LOGE(TAG, "on_state needs a pin_bits table");
+    return NULL;
+  }
+  if (groups_lock == NULL) groups_lock = xSemaphoreCreateMutex();
+
+  button_group_t *group = calloc(1, sizeof(button_group_t));
+  if (group == NULL) return NULL;
+  group->config = *config;
 
   // Configure the pins
   gpio_config_t io_conf;
-  io_conf.intr_type = GPIO_INTR_POSEDGE;
+  io_conf.intr_type = config->isr_debounce ? GPIO_INTR_ANYEDGE : GPIO_INTR_DISABLE;
   io_conf.mode = GPIO_MODE_INPUT;
-  io_conf.pull_up_en = (pull_mode == GPIO_PULLUP_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN);
-  io_conf.pull_down_en = (pull_mode == GPIO_PULLDOWN_ONLY || pull_mode == GPIO_PULLUP_PULLDOWN);
-  ;
-  io_conf.pin_bit_mask = pin_select;
+  io_conf.pull_up_en = (config->pull_mode == GPIO_PULLUP_ONLY || config->pull_mode == GPIO_PULLUP_PULLDOWN);
+  io_conf.pull_down_en = (config->pull_mode == GPIO_PULLDOWN_ONLY || config->pull_mode == GPIO_PULLUP_PULLDOWN);
+  io_conf.pin_bit_mask = config->pin_select;
   gpio_config(&io_conf);
 
   // Scan the pin map to determine number of pins
-  pin_count = 0;
   for (int pin = 0; pin <= 39; pin++) {
-    if ((1ULL << pin) & pin_select) {
-      pin_count++;
+    if ((1ULL << pin) & config->pin_select) {
+      group->pin_count++;
     }
   }
 
-  // Initialize global state and queue
-  debounce = calloc(pin_count, sizeof(debounce_t));
-  queue = xQueueCreate(CONFIG_ESP32_BUTTON_QUEUE_SIZE, sizeof(button_event_t));
+  // Initialize group state and event delivery
+  uint32_t ring_size = 1;
+  while (ring_size < config->queue_size) ring_size <<= 1;
+  group->ring_mask = ring_size - 1;
+  group->debounce = calloc(group->pin_count, sizeof(debounce_t));
+  if (config->use_queue) {
+    group->queue = xQueueCreate(config->queue_size, sizeof(button_event_t));
+  } else if (config->queue_size > 0) {
+    group->ring = calloc(ring_size, sizeof(ring_slot_t));
+  }
+  if (group->debounce == NULL || (config->queue_size > 0 && group->queue == NULL && group->ring == NULL)) {
+    ESP_LOGE(TAG, "Out of memory creating group");
+    goto fail;
+  }
 
   // Scan the pin map to determine each pin number, populate the state
   uint32_t idx = 0;
   for (int pin = 0; pin <= 39; pin++) {
-    if ((1ULL << pin) & pin_select) {
+    if ((1ULL << pin) & config->pin_select) {
       ESP_LOGI(TAG, "Registering button input: %d", pin);
-      debounce[idx].pin = pin;
-      debounce[idx].down_time = 0;
-      debounce[idx].inverted = false;
-      if (debounce[idx].inverted) debounce[idx].history = 0xffff;
+      group->debounce[idx].pin = pin;
+      group->debounce[idx].inverted = config->inverted;
+      group->debounce[idx].group = group;
+      group->debounce[idx].hold.fire = hold_fire;
+      group->debounce[idx].hold.arg = &group->debounce[idx];
+      group->index[pin] = idx;
       idx++;
     }
   }
 
-  // Spawn a task to monitor the pins
-  xTaskCreate(&button_task, "button_task", CONFIG_ESP32_BUTTON_TASK_STACK_SIZE, NULL, 10, NULL);
+  // every pin starts out released, so a button held at boot still reports DOWN
+  group->invert = config->inverted ? config->pin_select : 0;
+  group->state = group->invert;
+
+  // gesture deadlines are counted in group ticks: one scan, or one scanner tick
+  // for groups that are not scanned in the background
+  group->tick_ms = CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS;
+  if (!config->isr_debounce && config->scan_period_ms > CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS) {
+    group->tick_ms = (config->scan_period_ms / CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS) * CONFIG_ESP32_BUTTON_SCAN_PERIOD_MS;
+  }
+  group->chord.fire = chord_fire;
+
+  if (config->isr_debounce) {
+    // Let edge interrupts drive the debouncer, nothing runs while idle
+    if (isr_add(group) != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to attach edge interrupts");
+      isr_remove(group);
+      goto fail;
+    }
+  } else if (config->scan_period_ms > 0) {
+    // Hand the group to the shared scanner task
+    scanner_add(group);
+  }
+
+  claimed_pins |= config->pin_select;
+  return group;
+
+fail:
+  if (group->queue) vQueueDelete(group->queue);
+  free(group->ring);
+  free(group->debounce);
+  free(group);
+  return NULL;
+}
+
+QueueHandle_t button_group_get_queue(button_group_handle_t group) {
+  return group->queue;
+}
+
+bool button_group_receive(button_group_handle_t group, button_event_t *event, TickType_t ticks_to_wait) {
+  // the first receive makes the calling task the group's one consumer
+  if (group->consumer == NULL) group->consumer = xTaskGetCurrentTaskHandle();
+  TickType_t start = xTaskGetTickCount();
+  while (!ring_pop(group, event)) {
+    TickType_t waited = xTaskGetTickCount() - start;
+    if (ticks_to_wait != portMAX_DELAY && waited >= ticks_to_wait) return false;
+    xTaskNotifyWait(0, group->config.notify_bits, NULL,
+                    ticks_to_wait == portMAX_DELAY ? portMAX_DELAY : ticks_to_wait - waited);
+  }
+  return true;
+}
+
+void button_group_get_stats(button_group_handle_t group, button_group_stats_t *stats) {
+  uint32_t pending = group->queue ? uxQueueMessagesWaiting(group->queue) : group->head - group->tail;
+  stats->dropped = group->dropped + group->overrun;
+  stats->coalesced = group->coalesced;
+  stats->high_water = group->high_water;
+  stats->pending = pending > group->ring_mask + 1 ? group->ring_mask + 1 : pending;
+}
+
+void button_group_scan(button_group_handle_t group) {
+  scan_group(group, read_levels(), esp_timer_get_time());
+}
+
+esp_err_t button_group_delete(button_group_handle_t group) {
+  if (group == NULL) return ESP_ERR_INVALID_ARG;
+  if (group->config.isr_debounce) {
+    isr_remove(group);
+  } else if (group->config.scan_period_ms > 0) {
+    scanner_remove(group);
+  }
+  claimed_pins &= ~group->config.pin_select;
+  if (group->queue) vQueueDelete(group->queue);
+  free(group->ring);
+  free(group->debounce);
+  free(group);
+  return ESP_OK;
+}
+
+QueueHandle_t button_init(unsigned long long pin_select) {
+  return pulled_button_init(pin_select, GPIO_FLOATING);
+}
 
-  return queue;
+QueueHandle_t pulled_button_init(unsigned long long pin_select, gpio_pull_mode_t pull_mode) {
+  button_group_config_t config = BUTTON_GROUP_CONFIG_DEFAULT();
+  config.pin_select = pin_select;
+  config.pull_mode = pull_mode;
+  config.use_queue = true;
+  button_group_handle_t group = button_group_create(&config);
+  return group ? button_group_get_queue(group) : NULL;
 }
@@ -13,14 +13,10 @@
 /*                                    TYPES                                   */
 /* -------------------------------------------------------------------------- */
 
-// type representing a single button
-typedef struct {
-  uint8_t pin;
-} button_t;
-
 // our button event state
 typedef struct {
   uint16_t state;
+  int64_t time_us;  // when the button change was sampled, from esp_timer_get_time()
 } my_buttons_event_t;
 
 /* -------------------------------------------------------------------------- */
@@ -28,7 +24,8 @@ typedef struct {
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Returns the queue in which button events will be emitted
+ * @brief Returns the queue in which the latest button state is kept. It holds
+ * one state at most, a newer one replacing it if it was not read in time.
  * 
  * @return QueueHandle_t 
  */
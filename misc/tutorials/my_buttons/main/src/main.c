@@ -4,6 +4,7 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_spi_flash.h"
+#include "esp_timer.h"
 
 #include "my_buttons.h"
 
@@ -28,7 +29,8 @@ static void read_buttons_task(void *pvParameter) {
     // wait up to 30ms for any button events in the queue
     if (xQueueReceive(my_buttons_queue, &ev_buttons, 30 / portTICK_PERIOD_MS)) {
       // if we got a button event, log it!
-      ESP_LOGI(TAG, "BUTTON STATE: %d %d", !!(ev_buttons.state & 0b10), !!(ev_buttons.state & 0b01));
+      ESP_LOGI(TAG, "BUTTON STATE: %d %d (%lld us after the change)", !!(ev_buttons.state & 0b10), !!(ev_buttons.state & 0b01),
+               esp_timer_get_time() - ev_buttons.time_us);
     }
   }
 }